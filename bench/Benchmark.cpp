@@ -0,0 +1,393 @@
+#include"../include/System.hpp"
+#include"../include/MemoryManager.hpp"
+#include"../include/OffscreenTarget.hpp"
+#include"../include/ResourceSet.hpp"
+#include"../include/LayoutCache.hpp"
+#include"../include/ShaderSet.hpp"
+#include"../include/VertexBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/MeshOptimizer.hpp"
+#include<algorithm>
+#include<random>
+#include<numeric>
+#include<chrono>
+#include<fstream>
+#include<iostream>
+#include<sstream>
+#include<memory>
+#include<vector>
+#include<string>
+
+// Headless benchmarks of the Spark hot paths. Runs on any Vulkan driver, including CPU ones such as lavapipe:
+//     make bench && VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./bench/spark-bench --output results.json
+// Results are printed as JSON: one entry per measurement with its parameters, value and unit.
+
+namespace
+{
+    struct Result
+    {
+        std::string name;
+        std::string parameters;                                                         // JSON object
+        double value;
+        std::string unit;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(const Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void waitIdle()
+    {
+        spk::system::System::getInstance()->getLogicalDevice().waitIdle();
+    }
+
+    std::string getDeviceName()
+    {
+        vk::PhysicalDeviceProperties properties;
+        spk::system::System::getInstance()->getPhysicalDevice().getProperties(&properties);
+        return properties.deviceName;
+    }
+
+    void benchmarkAllocation(std::vector<Result>& results)
+    {
+        const uint32_t allocationCount = 1000;
+        spk::system::MemoryManager* manager = spk::system::MemoryManager::getInstance();
+        spk::system::MemoryAllocationInfo info;
+        info.size = 64 * 1024;
+        info.flags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        info.memoryTypeBits = ~0U;
+        info.alignment = 256;
+
+        std::vector<spk::system::AllocatedMemoryData> allocations(allocationCount);
+        Clock::time_point start = Clock::now();
+        for(auto& allocation : allocations)
+        {
+            allocation = manager->allocateMemory(info);
+        }
+        for(const auto& allocation : allocations)
+        {
+            manager->freeMemory(allocation.index);
+        }
+        results.push_back({"memory.allocate_free", "{\"mode\":\"instant\",\"size\":65536}", allocationCount / secondsSince(start), "ops/s"});
+
+        start = Clock::now();
+        for(auto& allocation : allocations)
+        {
+            allocation = manager->allocateMemoryLazy(info);
+        }
+        manager->flushLazyAllocations();
+        for(const auto& allocation : allocations)
+        {
+            manager->freeMemory(allocation.index);
+        }
+        results.push_back({"memory.allocate_free", "{\"mode\":\"lazy\",\"size\":65536}", allocationCount / secondsSince(start), "ops/s"});
+    }
+
+    void benchmarkVertexUpload(std::vector<Result>& results)
+    {
+        const uint32_t sizes[] = {4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+        const uint32_t repetitions = 20;
+        for(const uint32_t size : sizes)
+        {
+            std::vector<char> data(size, 1);
+            spk::VertexBuffer buffer({0}, {size});
+            buffer.updateVertexBuffer(data.data(), 0);                                  // first update binds the memory
+            const Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < repetitions; ++i)
+            {
+                buffer.updateVertexBuffer(data.data(), 0);
+            }
+            const double seconds = secondsSince(start);
+            const std::string parameters = "{\"size\":" + std::to_string(size) + "}";
+            results.push_back({"upload.vertex_buffer.latency", parameters, seconds / repetitions * 1000.0, "ms"});
+            results.push_back({"upload.vertex_buffer.bandwidth", parameters, double(size) * repetitions / seconds / (1024.0 * 1024.0), "MiB/s"});
+        }
+    }
+
+    void benchmarkTextureUpload(std::vector<Result>& results)
+    {
+        const uint32_t extents[] = {64, 256, 1024};
+        const uint32_t repetitions = 10;
+        for(const uint32_t extent : extents)
+        {
+            const uint32_t size = extent * extent * 4;
+            std::vector<char> data(size, 1);
+            std::vector<spk::Texture> textures(1, spk::Texture(extent, extent, spk::ImageFormat::RGBA8, 0, 0));
+            std::vector<spk::UniformBuffer> uniformBuffers;
+            spk::ResourceSet resources(textures, uniformBuffers);
+            const Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < repetitions; ++i)
+            {
+                resources.update(0, 0, data.data());
+            }
+            const double seconds = secondsSince(start);
+            const std::string parameters = "{\"extent\":" + std::to_string(extent) + ",\"format\":\"RGBA8\"}";
+            results.push_back({"upload.texture.latency", parameters, seconds / repetitions * 1000.0, "ms"});
+            results.push_back({"upload.texture.bandwidth", parameters, double(size) * repetitions / seconds / (1024.0 * 1024.0), "MiB/s"});
+        }
+    }
+
+    void benchmarkResourceSetCreation(std::vector<Result>& results)
+    {
+        const uint32_t repetitions = 100;
+        for(const bool mixed : {false, true})
+        {
+            std::vector<spk::Texture> textures(1, mixed ? spk::Texture(64, 64, spk::ImageFormat::RGBA8, 0, 1) : spk::Texture(64, 64, spk::ImageFormat::RGBA8, 1, 0));     // mixed: the texture shares the set of the buffer
+            std::vector<spk::UniformBuffer> uniformBuffers(1, spk::UniformBuffer(64, 0, 0));
+            const Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < repetitions; ++i)
+            {
+                spk::ResourceSet resources(textures, uniformBuffers);
+            }
+            const std::string parameters = std::string("{\"textures\":1,\"uniform_buffers\":1,\"sets\":") + (mixed ? "1" : "2") + "}";
+            results.push_back({"resource_set.create_destroy", parameters, repetitions / secondsSince(start), "ops/s"});
+        }
+    }
+
+    void benchmarkUniformUpdate(std::vector<Result>& results)
+    {
+        const uint32_t repetitions = 10000;
+        const float data[64] = {};
+        for(const bool dynamic : {false, true})
+        {
+            std::vector<spk::Texture> textures;
+            std::vector<spk::UniformBuffer> uniformBuffers(1, spk::UniformBuffer(sizeof(data), 0, 0, dynamic));
+            spk::ResourceSet resources(textures, uniformBuffers);
+            const Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < repetitions; ++i)
+            {
+                resources.update(0, 0, data);
+            }
+            const std::string parameters = std::string("{\"dynamic\":") + (dynamic ? "true" : "false") + ",\"size\":" + std::to_string(sizeof(data)) + "}";
+            results.push_back({"uniform.update", parameters, repetitions / secondsSince(start), "ops/s"});
+        }
+    }
+
+    void benchmarkMeshOptimization(std::vector<Result>& results)
+    {
+        const uint32_t gridSize = 256;                                                  // a grid of quads in random triangle order, without index buffer, as an exporter might write it
+        std::vector<uint32_t> triangles;
+        for(uint32_t y = 0; y < gridSize; ++y)
+        {
+            for(uint32_t x = 0; x < gridSize; ++x)
+            {
+                const uint32_t corner = y * (gridSize + 1) + x;
+                triangles.insert(triangles.end(), {corner, corner + 1, corner + gridSize + 1, corner + 1, corner + gridSize + 2, corner + gridSize + 1});
+            }
+        }
+        std::vector<uint32_t> order(triangles.size() / 3);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(1));
+        std::vector<float> soup;
+        for(const uint32_t triangle : order)
+        {
+            for(uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = triangles[3 * triangle + corner];
+                const float x = float(vertex % (gridSize + 1)), y = float(vertex / (gridSize + 1));
+                soup.insert(soup.end(), {x, y, 0.0f, x / gridSize, y / gridSize});
+            }
+        }
+
+        std::vector<char> vertices(reinterpret_cast<const char*>(soup.data()), reinterpret_cast<const char*>(soup.data() + soup.size()));
+        std::vector<uint32_t> indices;
+        const Clock::time_point start = Clock::now();
+        const spk::utils::MeshOptimizationReport report = spk::utils::optimizeMesh(vertices, 5 * sizeof(float), indices, 0);
+        const double seconds = secondsSince(start);
+        const std::string parameters = "{\"triangles\":" + std::to_string(order.size()) + ",\"cache_size\":16}";
+        results.push_back({"mesh_optimization.time", parameters, seconds * 1000.0, "ms"});
+        results.push_back({"mesh_optimization.acmr", "{\"stage\":\"before\"}", report.before.acmr, "vertices/triangle"});
+        results.push_back({"mesh_optimization.acmr", "{\"stage\":\"after\"}", report.after.acmr, "vertices/triangle"});
+        results.push_back({"mesh_optimization.atvr", "{\"stage\":\"before\"}", report.before.atvr, "transforms/vertex"});
+        results.push_back({"mesh_optimization.atvr", "{\"stage\":\"after\"}", report.after.atvr, "transforms/vertex"});
+
+        const Clock::time_point lodStart = Clock::now();
+        const std::vector<spk::utils::LevelOfDetail> levels = spk::utils::generateLevelsOfDetail(indices, vertices.data(), 5 * sizeof(float), report.vertexCountAfter, 4);
+        results.push_back({"lod_generation.time", "{\"triangles\":" + std::to_string(order.size()) + ",\"levels\":" + std::to_string(levels.size()) + "}", secondsSince(lodStart) * 1000.0, "ms"});
+        for(uint32_t level = 0; level < levels.size(); ++level)
+        {
+            results.push_back({"lod_generation.triangles", "{\"level\":" + std::to_string(level + 1) + "}", double(levels[level].indices.size() / 3), "triangles"});
+        }
+    }
+
+    double timeFirstDraw(spk::ResourceSet& resources, spk::VertexAlignmentInfo& alignment, std::vector<spk::VertexBuffer*>& meshes, spk::ShaderSet& shaders)
+    {
+        spk::DrawOptions options;
+        options.cullMode = spk::CullMode::None;
+        spk::OffscreenTarget target(256, 256, options);
+        const Clock::time_point start = Clock::now();
+        target.draw(&resources, &alignment, meshes, &shaders);                         // creates the pipeline
+        const double seconds = secondsSince(start);
+        waitIdle();
+        return seconds;
+    }
+
+    void benchmarkPipelineCreation(std::vector<Result>& results, spk::ResourceSet& resources, spk::VertexAlignmentInfo& alignment, std::vector<spk::VertexBuffer*>& meshes, spk::ShaderSet& shaders)
+    {
+        const uint32_t repetitions = 5;
+        double coldSeconds = 0, cachedSeconds = 0;
+        for(uint32_t i = 0; i < repetitions; ++i)
+        {
+            spk::system::loadPipelineCache("");                                         // empty cache
+            coldSeconds += timeFirstDraw(resources, alignment, meshes, shaders);
+            cachedSeconds += timeFirstDraw(resources, alignment, meshes, shaders);
+        }
+        results.push_back({"pipeline.first_draw", "{\"cache\":\"cold\"}", coldSeconds / repetitions * 1000.0, "ms"});
+        results.push_back({"pipeline.first_draw", "{\"cache\":\"warm\"}", cachedSeconds / repetitions * 1000.0, "ms"});
+    }
+
+    void benchmarkMaterials(std::vector<Result>& results, spk::VertexAlignmentInfo& alignment, std::vector<spk::VertexBuffer*>& meshes, spk::ShaderSet& shaders)
+    {
+        const uint32_t materialCount = 16;
+        const float offset[] = {0.0f, 0.0f};
+        std::vector<spk::Texture> textures;
+        std::vector<spk::UniformBuffer> uniformBuffers(1, spk::UniformBuffer(sizeof(offset), 0, 0));
+        std::vector<std::unique_ptr<spk::ResourceSet> > materials;
+        for(uint32_t i = 0; i < materialCount; ++i)
+        {
+            materials.emplace_back(new spk::ResourceSet(textures, uniformBuffers));
+            materials.back()->update(0, 0, offset);
+        }
+        spk::DrawOptions options;
+        options.cullMode = spk::CullMode::None;
+        spk::OffscreenTarget target(256, 256, options);
+        spk::system::loadPipelineCache("");
+        const Clock::time_point start = Clock::now();
+        for(auto& material : materials)
+        {
+            target.draw(material.get(), &alignment, meshes, &shaders);                 // structurally equal materials share one pipeline
+        }
+        const double seconds = secondsSince(start);
+        waitIdle();
+        const std::string parameters = "{\"materials\":" + std::to_string(materialCount) + "}";
+        results.push_back({"pipeline.equal_materials", parameters, seconds * 1000.0, "ms"});
+        results.push_back({"pipeline.layouts", parameters, double(spk::system::LayoutCache::getInstance()->getPipelineLayoutCount()), "layouts"});
+    }
+
+    void benchmarkDraw(std::vector<Result>& results, spk::ResourceSet& resources, spk::VertexAlignmentInfo& alignment, spk::ShaderSet& shaders)
+    {
+        const float triangle[] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.0f, 0.5f};
+        const uint32_t meshCounts[] = {1, 100, 1000};
+        const uint32_t frames = 300;
+        for(const uint32_t meshCount : meshCounts)
+        {
+            std::vector<std::unique_ptr<spk::VertexBuffer> > meshes;
+            std::vector<spk::VertexBuffer*> meshPointers;
+            for(uint32_t i = 0; i < meshCount; ++i)
+            {
+                meshes.emplace_back(new spk::VertexBuffer({0}, {sizeof(triangle)}));
+                meshes.back()->updateVertexBuffer(triangle, 0);
+                meshPointers.push_back(meshes.back().get());
+            }
+
+            spk::DrawOptions options;
+            options.cullMode = spk::CullMode::None;
+            options.maxFramesInFlight = 2;                                              // the resources are not updated while drawing
+            spk::OffscreenTarget target(256, 256, options);
+            for(uint32_t i = 0; i < 10; ++i)
+            {
+                target.draw(&resources, &alignment, meshPointers, &shaders);           // warm up: pipeline creation and command buffer recording
+            }
+            waitIdle();
+
+            const Clock::time_point start = Clock::now();
+            for(uint32_t i = 0; i < frames; ++i)
+            {
+                target.draw(&resources, &alignment, meshPointers, &shaders);
+            }
+            waitIdle();
+            const double seconds = secondsSince(start);
+            const spk::FrameStatistics average = spk::system::Statistics::getInstance()->getAverage();
+            const std::string parameters = "{\"meshes\":" + std::to_string(meshCount) + ",\"width\":256,\"height\":256}";
+            results.push_back({"draw.frames_per_second", parameters, frames / seconds, "frames/s"});
+            results.push_back({"draw.draws_per_second", parameters, double(frames) * meshCount / seconds, "draws/s"});
+            results.push_back({"draw.cpu_draw_time", parameters, average.cpuDrawMilliseconds, "ms"});
+            results.push_back({"draw.fence_wait_time", parameters, average.fenceWaitMilliseconds, "ms"});
+        }
+    }
+
+    std::string escapeJson(const std::string& text)
+    {
+        std::string escaped;
+        for(const char c : text)
+        {
+            if(c == '"' || c == '\\') escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    void writeResults(std::ostream& out, const std::vector<Result>& results)
+    {
+        out << "{\n  \"device\": \"" << escapeJson(getDeviceName()) << "\",\n  \"results\": [\n";
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            out << "    {\"name\": \"" << result.name << "\", \"parameters\": " << result.parameters
+                << ", \"value\": " << result.value << ", \"unit\": \"" << result.unit << "\"}" << (i + 1 == results.size() ? "\n" : ",\n");
+        }
+        out << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputFilename;
+    std::string shaderDirectory = "bench/shaders";
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if(argument == "--output" && i + 1 < argc) outputFilename = argv[++i];
+        else if(argument == "--shaders" && i + 1 < argc) shaderDirectory = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--output results.json] [--shaders directory]\n";
+            return 1;
+        }
+    }
+
+    spk::system::init(true);
+    std::vector<Result> results;
+    {
+        benchmarkAllocation(results);
+        benchmarkVertexUpload(results);
+        benchmarkTextureUpload(results);
+        benchmarkResourceSetCreation(results);
+        benchmarkUniformUpdate(results);
+        benchmarkMeshOptimization(results);
+
+        const float offset[] = {0.0f, 0.0f};
+        std::vector<spk::Texture> textures;
+        std::vector<spk::UniformBuffer> uniformBuffers(1, spk::UniformBuffer(sizeof(offset), 0, 0));
+        spk::ResourceSet resources(textures, uniformBuffers);
+        resources.update(0, 0, offset);
+        spk::VertexAlignmentInfo alignment({{0, sizeof(float) * 2, {{0, spk::FieldFormat::vec2f, 0}}}});
+        spk::ShaderSet shaders({{spk::ShaderType::Vertex, shaderDirectory + "/bench.vert.spv"}, {spk::ShaderType::Fragment, shaderDirectory + "/bench.frag.spv"}});
+        const float triangle[] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.0f, 0.5f};
+        spk::VertexBuffer mesh({0}, {sizeof(triangle)});
+        mesh.updateVertexBuffer(triangle, 0);
+        std::vector<spk::VertexBuffer*> meshes = {&mesh};
+
+        benchmarkPipelineCreation(results, resources, alignment, meshes, shaders);
+        benchmarkMaterials(results, alignment, meshes, shaders);
+        benchmarkDraw(results, resources, alignment, shaders);
+        waitIdle();
+    }
+
+    if(outputFilename.empty()) writeResults(std::cout, results);
+    else
+    {
+        std::ofstream file(outputFilename, std::ios::trunc);
+        if(!file.is_open())
+        {
+            std::cerr << "Failed to open " << outputFilename << '\n';
+            return 1;
+        }
+        writeResults(file, results);
+    }
+    spk::system::deinit();
+    return 0;
+}
\ No newline at end of file
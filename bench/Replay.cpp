@@ -0,0 +1,491 @@
+#include"../include/System.hpp"
+#include"../include/Capture.hpp"
+#include"../include/OffscreenTarget.hpp"
+#include"../include/ResourceSet.hpp"
+#include"../include/ShaderSet.hpp"
+#include"../include/VertexBuffer.hpp"
+#include<algorithm>
+#include<chrono>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<iostream>
+#include<memory>
+#include<map>
+#include<vector>
+#include<string>
+
+// Replays a capture recorded with spk::system::beginCapture headlessly and reports its timings, e.g.:
+//     make replay && ./bench/spark-replay frame.spkcap --repeat 5 --output replay.json
+// Every render target of the capture is replayed into an offscreen target of the same size.
+
+namespace
+{
+    struct Result
+    {
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double millisecondsBetween(const Clock::time_point start, const Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    struct ReplayTimings
+    {
+        std::vector<double> replayedFrames;                                             // milliseconds between consecutive draws
+        std::vector<double> capturedFrames;
+        uint32_t draws = 0;
+        double uploadMilliseconds = 0;                                                  // resource creation and updates
+        double totalMilliseconds = 0;
+    };
+
+    struct ReplayState
+    {
+        std::map<uint64_t, std::unique_ptr<spk::OffscreenTarget> > targets;
+        std::map<uint64_t, std::unique_ptr<spk::ResourceSet> > resourceSets;
+        std::map<uint64_t, spk::VertexAlignmentInfo> alignments;
+        std::map<uint64_t, std::unique_ptr<spk::ShaderSet> > shaderSets;
+        std::map<uint64_t, std::unique_ptr<spk::VertexBuffer> > vertexBuffers;
+        std::map<uint64_t, std::unique_ptr<spk::InstanceBuffer> > instanceBuffers;
+        std::map<uint64_t, uint32_t> instanceSizes;
+    };
+
+    template<typename T>
+    T& find(std::map<uint64_t, T>& objects, const uint64_t identifier)
+    {
+        auto found = objects.find(identifier);
+        if(found == objects.end()) throw std::runtime_error("Capture references an unknown object!\n");
+        return found->second;
+    }
+
+    void createTarget(spk::utils::CaptureReader& reader, ReplayState& state)
+    {
+        const uint64_t identifier = reader.readUInt();
+        const uint32_t width = reader.readUInt();
+        const uint32_t height = reader.readUInt();
+        spk::DrawOptions options;
+        options.cullMode = static_cast<spk::CullMode>(reader.readUInt());
+        options.presentMode = static_cast<spk::PresentMode>(reader.readUInt());
+        options.minImageCount = reader.readUInt();
+        options.maxFramesInFlight = reader.readUInt();
+        options.storeDepth = reader.readUInt() != 0;
+        options.gpuTimings = reader.readUInt() != 0;
+        state.targets[identifier].reset(new spk::OffscreenTarget(width, height, options));
+    }
+
+    void readTexture(spk::utils::CaptureReader& reader, spk::Texture& texture)
+    {
+        const uint32_t width = reader.readUInt();
+        const uint32_t height = reader.readUInt();
+        const spk::ImageFormat format = static_cast<spk::ImageFormat>(reader.readUInt());
+        const uint32_t set = reader.readUInt();
+        const uint32_t binding = reader.readUInt();
+        texture.create(width, height, format, set, binding);
+        spk::SamplerInfo sampler;
+        sampler.magFilter = static_cast<spk::Filter>(reader.readUInt());
+        sampler.minFilter = static_cast<spk::Filter>(reader.readUInt());
+        sampler.mipmapFilter = static_cast<spk::Filter>(reader.readUInt());
+        sampler.addressModeU = static_cast<spk::AddressMode>(reader.readUInt());
+        sampler.addressModeV = static_cast<spk::AddressMode>(reader.readUInt());
+        sampler.addressModeW = static_cast<spk::AddressMode>(reader.readUInt());
+        std::memcpy(&sampler.maxAnisotropy, reader.readBytes(sizeof(float)), sizeof(float));
+        std::memcpy(&sampler.minLod, reader.readBytes(sizeof(float)), sizeof(float));
+        std::memcpy(&sampler.maxLod, reader.readBytes(sizeof(float)), sizeof(float));
+        texture.setSamplerInfo(sampler);
+    }
+
+    void createResourceSet(spk::utils::CaptureReader& reader, ReplayState& state)
+    {
+        const uint64_t identifier = reader.readUInt();
+        std::vector<spk::Texture> textures(reader.readUInt());
+        for(auto& texture : textures)
+        {
+            readTexture(reader, texture);
+        }
+        std::vector<spk::UniformBuffer> uniformBuffers(reader.readUInt());
+        for(auto& uniformBuffer : uniformBuffers)
+        {
+            const size_t size = reader.readUInt();
+            const uint32_t set = reader.readUInt();
+            const uint32_t binding = reader.readUInt();
+            const bool dynamic = reader.readUInt() != 0;
+            uniformBuffer.create(size, set, binding, dynamic);
+        }
+        std::vector<spk::StorageBuffer> storageBuffers(reader.readUInt());
+        for(auto& storageBuffer : storageBuffers)
+        {
+            const size_t size = reader.readUInt();
+            const uint32_t set = reader.readUInt();
+            const uint32_t binding = reader.readUInt();
+            storageBuffer.create(size, set, binding);
+        }
+        const uint32_t bindlessSet = reader.readUInt();
+        const uint32_t bindlessCapacity = reader.readUInt();
+        spk::ResourceSet* resources = new spk::ResourceSet();
+        if(bindlessCapacity != 0) resources->setBindlessSet(bindlessSet, bindlessCapacity);
+        resources->create(textures, uniformBuffers, storageBuffers);
+        state.resourceSets[identifier].reset(resources);
+    }
+
+    void createVertexAlignment(spk::utils::CaptureReader& reader, ReplayState& state)
+    {
+        const uint64_t identifier = reader.readUInt();
+        std::vector<spk::BindingAlignmentInfo> bindings(reader.readUInt());
+        for(auto& binding : bindings)
+        {
+            binding.binding = reader.readUInt();
+            binding.structSize = reader.readUInt();
+            binding.inputRate = static_cast<spk::InputRate>(reader.readUInt());
+            binding.fields.resize(reader.readUInt());
+            for(auto& field : binding.fields)
+            {
+                field.location = reader.readUInt();
+                field.format = static_cast<spk::FieldFormat>(reader.readUInt());
+                field.offset = reader.readUInt();
+            }
+        }
+        state.alignments[identifier].create(bindings);
+    }
+
+    void createShaderSet(spk::utils::CaptureReader& reader, ReplayState& state)
+    {
+        const uint64_t identifier = reader.readUInt();
+        std::vector<spk::ShaderInfo> shaders(reader.readUInt());
+        for(uint32_t i = 0; i < shaders.size(); ++i)
+        {
+            shaders[i].type = static_cast<spk::ShaderType>(reader.readUInt());
+            const size_t size = reader.readUInt();
+            const char* code = reader.readBytes(size);
+            shaders[i].filename = (std::filesystem::temp_directory_path() / ("spark-replay-" + std::to_string(identifier) + "-" + std::to_string(i) + ".spv")).string();
+            std::ofstream file(shaders[i].filename, std::ios::binary | std::ios::trunc);
+            if(!file.is_open()) throw std::runtime_error("Failed to write shader code!\n");
+            file.write(code, size);
+        }
+        state.shaderSets[identifier].reset(new spk::ShaderSet(shaders));
+        for(const auto& shader : shaders)
+        {
+            std::filesystem::remove(shader.filename);
+        }
+    }
+
+    void createVertexBuffer(spk::utils::CaptureReader& reader, ReplayState& state)
+    {
+        const uint64_t identifier = reader.readUInt();
+        std::vector<uint32_t> bindings(reader.readUInt()), sizes(bindings.size());
+        for(uint32_t i = 0; i < bindings.size(); ++i)
+        {
+            bindings[i] = reader.readUInt();
+            sizes[i] = reader.readUInt();
+        }
+        const uint32_t indexSize = reader.readUInt();
+        const spk::IndexType indexType = static_cast<spk::IndexType>(reader.readUInt());
+        state.vertexBuffers[identifier].reset(new spk::VertexBuffer(bindings, sizes, indexSize, indexType));
+    }
+
+    void replay(spk::utils::CaptureReader& reader, ReplayTimings& timings)
+    {
+        ReplayState state;
+        std::vector<spk::VertexBuffer*> drawBuffers;
+        Clock::time_point lastDraw;
+        uint64_t lastCapturedDraw = 0;
+        bool drawn = false;
+        reader.rewind();
+        const Clock::time_point start = Clock::now();
+        for(spk::CaptureOp op = reader.readOp(); op != spk::CaptureOp::End; op = reader.readOp())
+        {
+            const Clock::time_point recordStart = Clock::now();
+            switch(op)
+            {
+                case spk::CaptureOp::CreateTarget:
+                    createTarget(reader, state);
+                    break;
+                case spk::CaptureOp::DestroyTarget:
+                    state.targets.erase(reader.readUInt());
+                    break;
+                case spk::CaptureOp::CreateResourceSet:
+                    createResourceSet(reader, state);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                case spk::CaptureOp::UpdateResourceSet:
+                {
+                    spk::ResourceSet& set = *find(state.resourceSets, reader.readUInt());
+                    const uint32_t descriptorSet = reader.readUInt();
+                    const uint32_t binding = reader.readUInt();
+                    const size_t size = reader.readUInt();
+                    const char* data = reader.readBytes(size);
+                    set.update(descriptorSet, binding, size == 0 ? nullptr : data);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::DestroyResourceSet:
+                    state.resourceSets.erase(reader.readUInt());
+                    break;
+                case spk::CaptureOp::CreateVertexAlignment:
+                    createVertexAlignment(reader, state);
+                    break;
+                case spk::CaptureOp::CreateShaderSet:
+                    createShaderSet(reader, state);
+                    break;
+                case spk::CaptureOp::DestroyShaderSet:
+                    state.shaderSets.erase(reader.readUInt());
+                    break;
+                case spk::CaptureOp::CreateVertexBuffer:
+                    createVertexBuffer(reader, state);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                case spk::CaptureOp::UpdateVertexBuffer:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const uint32_t binding = reader.readUInt();
+                    const size_t size = reader.readUInt();
+                    buffer.updateVertexBuffer(reader.readBytes(size), binding);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::UpdateIndexBuffer:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const size_t size = reader.readUInt();
+                    buffer.updateIndexBuffer(reader.readBytes(size));
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::UpdateBufferRange:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const bool vertex = reader.readUInt() != 0;
+                    const uint32_t binding = reader.readUInt();
+                    const uint32_t offset = reader.readUInt();
+                    const uint32_t size = reader.readUInt();
+                    if(vertex) buffer.updateVertexBuffer(reader.readBytes(size), binding, offset, size);
+                    else buffer.updateIndexBuffer(reader.readBytes(size), offset, size);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::SetInstancing:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const uint32_t count = reader.readUInt();
+                    const uint32_t first = reader.readUInt();
+                    buffer.setInstancingOptions(count, first);
+                    break;
+                }
+                case spk::CaptureOp::DestroyVertexBuffer:
+                    state.vertexBuffers.erase(reader.readUInt());
+                    break;
+                case spk::CaptureOp::CreateInstanceBuffer:
+                {
+                    const uint64_t identifier = reader.readUInt();
+                    const uint32_t instanceSize = reader.readUInt();
+                    const uint32_t capacity = reader.readUInt();
+                    const uint32_t copies = reader.readUInt();
+                    state.instanceBuffers[identifier].reset(new spk::InstanceBuffer(instanceSize, capacity, copies));
+                    state.instanceSizes[identifier] = instanceSize;
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::UpdateInstances:
+                {
+                    const uint64_t identifier = reader.readUInt();
+                    spk::InstanceBuffer& instances = *find(state.instanceBuffers, identifier);
+                    const uint32_t first = reader.readUInt();
+                    const uint32_t count = reader.readUInt();
+                    instances.setInstances(first, count, reader.readBytes(size_t(count) * state.instanceSizes[identifier]));
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::SetInstanceCount:
+                {
+                    spk::InstanceBuffer& instances = *find(state.instanceBuffers, reader.readUInt());
+                    instances.setInstanceCount(reader.readUInt());
+                    break;
+                }
+                case spk::CaptureOp::DestroyInstanceBuffer:
+                    state.instanceBuffers.erase(reader.readUInt());
+                    break;
+                case spk::CaptureOp::SetInstanceBuffer:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const uint32_t binding = reader.readUInt();
+                    const uint64_t instances = reader.readUInt();
+                    buffer.setInstanceBuffer(binding, (instances == 0) ? nullptr : find(state.instanceBuffers, instances - 1).get());
+                    break;
+                }
+                case spk::CaptureOp::SetLevelsOfDetail:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    std::vector<spk::utils::LevelOfDetail> levels(reader.readUInt());
+                    for(auto& level : levels)
+                    {
+                        std::memcpy(&level.error, reader.readBytes(sizeof(float)), sizeof(float));
+                        level.indices.resize(reader.readUInt());
+                        std::memcpy(level.indices.data(), reader.readBytes(level.indices.size() * sizeof(uint32_t)), level.indices.size() * sizeof(uint32_t));
+                    }
+                    if(buffer.getIndexType() != spk::IndexType::automatic) buffer.setLevelsOfDetail(levels);      // the indices that resolve the type predate the capture
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::SetBounds:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    spk::BoundingSphere bounds;
+                    std::memcpy(&bounds, reader.readBytes(sizeof(bounds)), sizeof(bounds));
+                    buffer.setBounds(bounds);
+                    break;
+                }
+                case spk::CaptureOp::SetLevelOfDetailView:
+                {
+                    spk::OffscreenTarget& target = *find(state.targets, reader.readUInt());
+                    if(reader.readUInt() == 0)
+                    {
+                        target.setLevelOfDetailView(nullptr);
+                        break;
+                    }
+                    float view[17];
+                    std::memcpy(view, reader.readBytes(sizeof(view)), sizeof(view));
+                    target.setLevelOfDetailView(view + 1, view[0]);
+                    break;
+                }
+                case spk::CaptureOp::SetPushConstantSize:
+                {
+                    spk::ResourceSet& set = *find(state.resourceSets, reader.readUInt());
+                    set.setPushConstantSize(reader.readUInt());
+                    break;
+                }
+                case spk::CaptureOp::AddTexture:
+                {
+                    spk::ResourceSet& set = *find(state.resourceSets, reader.readUInt());
+                    spk::Texture texture;
+                    readTexture(reader, texture);
+                    set.addTexture(texture);
+                    timings.uploadMilliseconds += millisecondsBetween(recordStart, Clock::now());
+                    break;
+                }
+                case spk::CaptureOp::SetPushConstants:
+                {
+                    spk::VertexBuffer& buffer = *find(state.vertexBuffers, reader.readUInt());
+                    const uint32_t size = reader.readUInt();
+                    buffer.setPushConstants(reader.readBytes(size), size);
+                    break;
+                }
+                case spk::CaptureOp::Draw:
+                {
+                    spk::OffscreenTarget& target = *find(state.targets, reader.readUInt());
+                    const uint64_t capturedTime = reader.readUInt();
+                    const spk::ResourceSet* resources = find(state.resourceSets, reader.readUInt()).get();
+                    const spk::VertexAlignmentInfo* alignment = &find(state.alignments, reader.readUInt());
+                    const spk::ShaderSet* shaders = find(state.shaderSets, reader.readUInt()).get();
+                    drawBuffers.resize(reader.readUInt());
+                    for(auto& buffer : drawBuffers)
+                    {
+                        buffer = find(state.vertexBuffers, reader.readUInt()).get();
+                    }
+                    target.draw(resources, alignment, drawBuffers, shaders);
+                    ++timings.draws;
+                    if(drawn)
+                    {
+                        timings.replayedFrames.push_back(millisecondsBetween(lastDraw, recordStart));
+                        timings.capturedFrames.push_back((capturedTime - lastCapturedDraw) / 1000000.0);
+                    }
+                    lastDraw = recordStart;
+                    lastCapturedDraw = capturedTime;
+                    drawn = true;
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Unknown capture record!\n");
+            }
+        }
+        spk::system::System::getInstance()->getLogicalDevice().waitIdle();
+        timings.totalMilliseconds += millisecondsBetween(start, Clock::now());
+    }
+
+    double percentile(std::vector<double> values, const double fraction)
+    {
+        if(values.size() == 0) return 0;
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, size_t(fraction * values.size()))];
+    }
+
+    double average(const std::vector<double>& values)
+    {
+        if(values.size() == 0) return 0;
+        double sum = 0;
+        for(const double value : values) sum += value;
+        return sum / values.size();
+    }
+
+    void writeResults(std::ostream& out, const std::string& capture, const uint32_t repeat, const std::vector<Result>& results)
+    {
+        out << "{\n  \"capture\": \"" << capture << "\",\n  \"repeat\": " << repeat << ",\n  \"results\": [\n";
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            out << "    {\"name\": \"" << result.name << "\", \"value\": " << result.value << ", \"unit\": \"" << result.unit << "\"}" << (i + 1 == results.size() ? "\n" : ",\n");
+        }
+        out << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string captureFilename, outputFilename;
+    uint32_t repeat = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if(argument == "--output" && i + 1 < argc) outputFilename = argv[++i];
+        else if(argument == "--repeat" && i + 1 < argc) repeat = std::max(1, std::stoi(argv[++i]));
+        else if(captureFilename.empty() && argument[0] != '-') captureFilename = argument;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " capture [--repeat count] [--output results.json]\n";
+            return 1;
+        }
+    }
+    if(captureFilename.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " capture [--repeat count] [--output results.json]\n";
+        return 1;
+    }
+
+    spk::system::init(true);
+    ReplayTimings timings;
+    {
+        spk::utils::CaptureReader reader(captureFilename);
+        for(uint32_t i = 0; i < repeat; ++i)
+        {
+            replay(reader, timings);
+        }
+    }
+
+    std::vector<Result> results;
+    results.push_back({"replay.frames", double(timings.draws) / repeat, "frames"});
+    results.push_back({"replay.total_time", timings.totalMilliseconds / repeat, "ms"});
+    results.push_back({"replay.upload_time", timings.uploadMilliseconds / repeat, "ms"});
+    results.push_back({"replay.frame_time.average", average(timings.replayedFrames), "ms"});
+    results.push_back({"replay.frame_time.p50", percentile(timings.replayedFrames, 0.5), "ms"});
+    results.push_back({"replay.frame_time.p95", percentile(timings.replayedFrames, 0.95), "ms"});
+    results.push_back({"replay.frame_time.max", percentile(timings.replayedFrames, 1.0), "ms"});
+    results.push_back({"capture.frame_time.average", average(timings.capturedFrames), "ms"});
+    results.push_back({"capture.frame_time.p95", percentile(timings.capturedFrames, 0.95), "ms"});
+
+    if(outputFilename.empty()) writeResults(std::cout, captureFilename, repeat, results);
+    else
+    {
+        std::ofstream file(outputFilename, std::ios::trunc);
+        if(!file.is_open())
+        {
+            std::cerr << "Failed to open " << outputFilename << '\n';
+            return 1;
+        }
+        writeResults(file, captureFilename, repeat, results);
+    }
+    spk::system::deinit();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec2 position;
+
+layout(set = 0, binding = 0) uniform Transform
+{
+    vec2 offset;
+} transform;
+
+void main()
+{
+    gl_Position = vec4(position + transform.offset, 0.0, 1.0);
+}
\ No newline at end of file
@@ -13,10 +13,10 @@ namespace spk
         {
         public:
             Buffer();
-            Buffer(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation);
+            Buffer(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation, const bool cShared = false);
             Buffer(const Buffer& buf);
             Buffer& operator=(const Buffer& buf);
-            void create(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation);
+            void create(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation, const bool cShared = false);     // shared buffers are used concurrently by the graphics and the async compute queue
             void bindMemory();
             void updateDeviceLocal(vk::CommandBuffer& updateBuffer,
                 const vk::Buffer& copyBuffer,
@@ -26,8 +26,12 @@ namespace spk
                 const vk::Fence& waitFence,
                 const vk::Fence& signalFence,
                 const vk::PipelineStageFlags dstStageFlags,
-                bool oneTimeSubmit = false);                                          // the buffer data must be tightly packed inside the buffer; offset must be 0
+                bool oneTimeSubmit = false,
+                const vk::DeviceSize dstOffset = 0,
+                const vk::DeviceSize copySize = 0);                                   // the buffer data must be tightly packed inside the buffer; copySize 0 copies the whole buffer
             void updateCPUAccessible(const void* data);
+            void* map();                                                                // maps the whole buffer persistently; CPU-accessible, instantly allocated buffers only
+            void unmap();
             void destroy();
             const vk::Buffer& getBuffer() const;
             ~Buffer();
@@ -38,6 +42,8 @@ namespace spk
             vk::Buffer buffer;
             bool instantAlloc;
             bool deviceLocal;
+            bool shared = false;
+            void* mappedMemory = nullptr;
         };
     }
 }
@@ -0,0 +1,137 @@
+#ifndef SPARK_CAPTURE_HPP
+#define SPARK_CAPTURE_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"MeshOptimizer.hpp"
+#include<memory>
+#include<vector>
+#include<string>
+#include<fstream>
+#include<map>
+#include<set>
+#include<chrono>
+
+namespace spk
+{
+    class ResourceSet;
+    class Texture;
+    class VertexAlignmentInfo;
+    class VertexBuffer;
+    class InstanceBuffer;
+    class ShaderSet;
+    class RenderTarget;
+
+    enum class CaptureOp : uint8_t                                                      // every integer field is an unsigned LEB128 varint, payloads follow their size
+    {
+        End = 0,
+        CreateTarget = 1,                                                               // target, width, height, cullMode, presentMode, minImageCount, maxFramesInFlight, storeDepth, gpuTimings
+        DestroyTarget = 2,                                                              // target
+        CreateResourceSet = 3,                                                          // set, textureCount, {texture}, bufferCount, {size, set, binding, dynamic}, storageCount, {size, set, binding}, bindlessSet, bindlessCapacity
+        UpdateResourceSet = 4,                                                          // set, descriptor set, binding, size, payload
+        DestroyResourceSet = 5,                                                         // set
+        CreateVertexAlignment = 6,                                                      // alignment, bindingCount, {binding, structSize, inputRate, fieldCount, {location, format, offset}}
+        CreateShaderSet = 7,                                                            // shaders, count, {type, size, SPIR-V}
+        DestroyShaderSet = 8,                                                           // shaders
+        CreateVertexBuffer = 9,                                                         // buffer, bindingCount, {binding, size}, indexSize, indexType
+        UpdateVertexBuffer = 10,                                                        // buffer, binding, size, payload
+        UpdateIndexBuffer = 11,                                                         // buffer, size, payload
+        SetInstancing = 12,                                                             // buffer, instanceCount, firstInstance
+        DestroyVertexBuffer = 13,                                                       // buffer
+        Draw = 14,                                                                      // target, nanoseconds since the capture start, set, alignment, shaders, bufferCount, {buffer}
+        UpdateBufferRange = 15,                                                         // buffer, vertex (1) or index (0), binding, offset, size, payload
+        CreateInstanceBuffer = 16,                                                      // instances, instanceSize, capacity, copies
+        UpdateInstances = 17,                                                           // instances, first, count, payload
+        SetInstanceCount = 18,                                                          // instances, count
+        DestroyInstanceBuffer = 19,                                                     // instances
+        SetInstanceBuffer = 20,                                                         // buffer, binding, instances (0 detaches)
+        SetLevelsOfDetail = 21,                                                         // buffer, levelCount, {error as a raw float, indexCount, indices as raw uint32s}
+        SetBounds = 22,                                                                 // buffer, center and radius as 4 raw floats
+        SetLevelOfDetailView = 23,                                                      // target, set, then if set pixelError and the view-projection matrix as 17 raw floats
+        SetPushConstantSize = 24,                                                       // set, size
+        SetPushConstants = 25,                                                          // buffer, size, payload
+        AddTexture = 26                                                                 // set, texture; a texture is width, height, format, set, binding, magFilter, minFilter, mipmapFilter, 3 address modes, then maxAnisotropy, minLod and maxLod as raw floats
+    };
+
+    namespace system
+    {
+        void beginCapture(const std::string& filename);                                 // records every following Spark call into the file
+        void endCapture();
+
+        class Capture
+        {
+        public:
+            static Capture* getInstance();
+            static bool isActive();
+            void recordTarget(const RenderTarget* target);
+            void recordTargetDestroy(const RenderTarget* target);
+            void recordResourceSet(const ResourceSet& set);
+            void recordResourceSetUpdate(const ResourceSet& set, const uint32_t descriptorSet, const uint32_t binding, const void* data);
+            void recordResourceSetDestroy(const ResourceSet& set);
+            void recordPushConstantSize(const ResourceSet& set);
+            void recordTextureAdd(const ResourceSet& set, const Texture& texture);
+            void recordVertexAlignment(const VertexAlignmentInfo& alignment);
+            void recordShaderSet(const ShaderSet& shaders);
+            void recordShaderSetDestroy(const ShaderSet& shaders);
+            void recordVertexBuffer(const VertexBuffer* buffer);
+            void recordVertexBufferUpdate(const VertexBuffer* buffer, const void* data, const bool vertex, const uint32_t binding, const uint32_t offset, const uint32_t size);
+            void recordInstancing(const VertexBuffer* buffer);
+            void recordVertexBufferDestroy(const VertexBuffer* buffer);
+            void recordInstanceBuffer(const InstanceBuffer* instances);
+            void recordInstances(const InstanceBuffer* instances, const uint32_t first, const uint32_t count, const void* data);
+            void recordInstanceCount(const InstanceBuffer* instances);
+            void recordInstanceBufferDestroy(const InstanceBuffer* instances);
+            void recordInstanceBinding(const VertexBuffer* buffer, const uint32_t binding, const InstanceBuffer* instances);
+            void recordLevelsOfDetail(const VertexBuffer* buffer, const std::vector<utils::LevelOfDetail>& levels);
+            void recordBounds(const VertexBuffer* buffer);
+            void recordPushConstants(const VertexBuffer* buffer);
+            void recordLevelOfDetailView(const RenderTarget* target);
+            void recordDraw(const RenderTarget* target, const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, const ShaderSet* shaders);
+            void destroy();
+        private:
+            friend void beginCapture(const std::string& filename);
+            friend void endCapture();
+            Capture();
+            void begin(const std::string& filename);
+            void end();
+            void writeOp(const CaptureOp op);
+            void writeUInt(uint64_t value);
+            void writeBytes(const void* data, const size_t size);
+            void writeTexture(const Texture& texture);
+            void flush();
+            const uint32_t assignIdentifier(std::map<const void*, uint32_t>& identifiers, const void* object);
+
+            static std::unique_ptr<Capture> instance;
+            static bool active;
+            std::ofstream file;
+            std::vector<char> buffer;                                                   // flushed to the file once it grows past a megabyte
+            std::chrono::steady_clock::time_point startTime;
+            std::map<const void*, uint32_t> targetIdentifiers;                          // objects without an identifier of their own are keyed by address
+            std::map<const void*, uint32_t> vertexBufferIdentifiers;
+            std::map<const void*, uint32_t> instanceBufferIdentifiers;
+            std::set<uint32_t> recordedResourceSets;
+            std::set<uint32_t> recordedAlignments;
+            std::set<uint32_t> recordedShaderSets;
+            uint32_t nextIdentifier;
+        };
+    }
+
+    namespace utils
+    {
+        class CaptureReader                                                             // sequential decoder of capture files
+        {
+        public:
+            CaptureReader();
+            CaptureReader(const std::string& filename);
+            void open(const std::string& filename);
+            CaptureOp readOp();                                                         // CaptureOp::End at the end of the file
+            uint64_t readUInt();
+            const char* readBytes(const size_t size);                                   // valid until the reader is destroyed
+            void rewind();
+        private:
+            std::vector<char> data;
+            size_t position;
+        };
+    }
+}
+
+#endif
\ No newline at end of file
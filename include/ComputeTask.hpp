@@ -0,0 +1,41 @@
+#ifndef SPARK_COMPUTE_TASK_HPP
+#define SPARK_COMPUTE_TASK_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"System.hpp"
+#include"Executives.hpp"
+#include"ResourceSet.hpp"
+#include"ShaderSet.hpp"
+
+namespace spk
+{
+    class RenderTarget;
+
+    class ComputeTask                                                                   // compute pipeline of one shader set, dispatched over the storage buffers of a resource set
+    {
+    public:
+        ComputeTask();
+        ComputeTask(const ResourceSet* cResources, const ShaderSet* cShaders, const bool cAsync = false);
+        void create(const ResourceSet* cResources, const ShaderSet* cShaders, const bool cAsync = false);
+        void dispatch(const uint32_t groupCountX, const uint32_t groupCountY = 1, const uint32_t groupCountZ = 1, const RenderTarget* cConsumer = nullptr);     // async results are visible to the next frame of cConsumer only
+        void wait();                                                                    // blocks until the last dispatch finishes
+        const bool isAsync() const;                                                     // true only if the device has a separate compute queue family
+        ~ComputeTask();
+    private:
+        void createPipeline();
+        void record(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ);
+        void destroy();
+
+        const ResourceSet* resources;
+        const ShaderSet* shaders;
+        bool async;
+        vk::Pipeline pipeline;
+        vk::CommandBuffer commandBuffer;
+        vk::Fence finishedFence;
+        vk::Semaphore finishedSemaphore;                                                // handed to the next frame submission of the consumer when async
+        bool submitted;
+        uint32_t recordedGroups[3];                                                     // the command buffer is re-recorded only when the group counts change
+    };
+}
+
+#endif
\ No newline at end of file
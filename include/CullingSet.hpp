@@ -0,0 +1,80 @@
+#ifndef SPARK_CULLING_SET_HPP
+#define SPARK_CULLING_SET_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"Buffer.hpp"
+#include"DrawCommandBuffer.hpp"
+#include<vector>
+
+namespace spk
+{
+    struct BoundingSphere
+    {
+        float center[3];                                                                // in the space the view-projection matrix transforms from
+        float radius;
+    };
+
+    class CullingSet                                                                    // objects culled on the GPU against the view frustum and the previous frame's depth
+    {
+    public:
+        CullingSet();
+        CullingSet(const uint32_t cCapacity, const uint32_t cCopies = 3);
+        void create(const uint32_t cCapacity, const uint32_t cCopies = 3);
+        void setObject(const uint32_t index, const BoundingSphere& bounds, const DrawCommand& command);
+        void setObjectCount(const uint32_t count);
+        void setViewProjection(const float* matrix);                                    // 16 floats, column-major, Vulkan clip space (depth from 0 to 1)
+        const uint32_t getObjectCount() const;
+        const uint32_t getCapacity() const;
+        ~CullingSet();
+    private:
+        struct Parameters                                                               // std430 layout of the cull shader input header
+        {
+            float viewProjection[16];
+            float previousViewProjection[16];                                           // the one the depth pyramid was built with
+            float planes[6][4];
+            uint32_t objectCount;
+            uint32_t compact;                                                           // 1 = visible draws are appended, 0 = culled draws keep their slot with no instances
+            uint32_t padding[2];
+        };
+
+        struct Object
+        {
+            BoundingSphere bounds;
+            DrawCommand command;
+            uint32_t padding[3];
+        };
+        static_assert(sizeof(Parameters) % 16 == 0 && sizeof(Object) == 48, "Culling data must match the std430 layout of the cull shader!");
+
+        friend class RenderTarget;
+        static const std::vector<vk::DescriptorSetLayoutBinding> getSetBindings();
+        static vk::DescriptorSetLayout createSetLayout();                               // one cached layout for every set, so cull pipelines work with any of them
+        const vk::DescriptorSet& getDescriptorSet() const;
+        const vk::Buffer& getOutputBuffer() const;
+        const uint32_t getCopyCount() const;
+        const bool isCompact() const;
+        const uint32_t getInputOffset(const uint32_t copy) const;
+        const uint32_t getOutputOffset(const uint32_t copy) const;                      // the draw count, followed by the draw commands
+        const vk::DeviceSize getCommandOffset(const uint32_t copy) const;
+        void flush(const uint32_t copy);
+        void createDescriptorSet();
+
+        utils::Buffer input;                                                            // host-visible, [copy] {parameters, objects}
+        utils::Buffer output;                                                           // device-local, [copy] {draw count, draw commands}
+        char* mappedInput;
+        Parameters parameters;
+        float lastViewProjection[16];
+        std::vector<Object> objects;
+        std::vector<uint64_t> copyVersions;
+        uint64_t version;
+        uint32_t capacity;
+        uint32_t copies;
+        vk::DeviceSize inputStride;
+        vk::DeviceSize outputStride;
+        vk::DescriptorSetLayout setLayout;
+        vk::DescriptorSet descriptorSet;
+
+        void destroy();
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef SPARK_DESCRIPTOR_ALLOCATOR_HPP
+#define SPARK_DESCRIPTOR_ALLOCATOR_HPP
+
+#include"SparkIncludeBase.hpp"
+#include<memory>
+#include<vector>
+#include<string>
+#include<map>
+#include<unordered_map>
+
+namespace spk
+{
+    namespace system
+    {
+        class DescriptorAllocator                                                       // descriptor sets of every Spark object, sub-allocated from shared pools
+        {
+        public:
+            static DescriptorAllocator* getInstance();
+            vk::DescriptorSet allocate(const vk::DescriptorSetLayout& layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind = false);   // bindings and flag the layout was created from
+            void free(const vk::DescriptorSet& set);                                    // the set is handed out again to a layout created from the same bindings once the frames submitted so far finish
+            const uint32_t getPoolCount() const;
+            void destroy();
+        private:
+            struct PoolChain                                                            // the last pool is allocated from, the next one is twice as large
+            {
+                std::vector<vk::DescriptorPool> pools;
+                uint32_t nextPoolSets;
+            };
+
+            struct RetiredSet
+            {
+                vk::DescriptorSet set;
+                std::string key;
+                uint64_t frameSubmission;                                               // frame submissions up to the free; any of them may still bind the set
+            };
+
+            DescriptorAllocator();
+            void recycleRetired();
+            vk::DescriptorPool createPool(const uint32_t maxSets, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind);    // large enough for at least one set of bindings
+            vk::DescriptorSet allocateFrom(PoolChain& chain, const vk::DescriptorSetLayout& layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind = false);
+            const std::string getLayoutKey(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind) const;
+
+            static std::unique_ptr<DescriptorAllocator> instance;
+            PoolChain persistentPools;
+            PoolChain updateAfterBindPools;                                             // sets of update after bind layouts need pools created for them
+            std::vector<RetiredSet> retiredSets;                                        // freed, in free order
+            std::unordered_map<std::string, std::vector<vk::DescriptorSet> > freeSets;  // [layout key]
+            std::map<vk::DescriptorSet, std::string> setKeys;                           // layout keys of the sets handed out by allocate
+        };
+    }
+}
+
+#endif
\ No newline at end of file
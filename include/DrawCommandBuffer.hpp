@@ -0,0 +1,51 @@
+#ifndef SPARK_DRAW_COMMAND_BUFFER_HPP
+#define SPARK_DRAW_COMMAND_BUFFER_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"Buffer.hpp"
+#include<vector>
+
+namespace spk
+{
+    struct DrawCommand                                                                  // same layout as VkDrawIndexedIndirectCommand
+    {
+        uint32_t indexCount;
+        uint32_t instanceCount = 1;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        uint32_t firstInstance = 0;                                                     // must be 0 if the device lacks drawIndirectFirstInstance
+    };
+
+    class DrawCommandBuffer                                                             // per-object draw parameters of one indirect batch
+    {
+    public:
+        DrawCommandBuffer();
+        DrawCommandBuffer(const uint32_t cCapacity, const uint32_t cCopies = 3);
+        void create(const uint32_t cCapacity, const uint32_t cCopies = 3);
+        void setDrawCommand(const uint32_t index, const DrawCommand& command);
+        void setDrawCount(const uint32_t count);
+        const uint32_t getDrawCount() const;
+        const uint32_t getCapacity() const;
+        ~DrawCommandBuffer();
+    private:
+        friend class RenderTarget;
+        const vk::Buffer& getBuffer() const;
+        const uint32_t getCopyCount() const;
+        const vk::DeviceSize getCommandOffset(const uint32_t copy) const;
+        const vk::DeviceSize getCountOffset(const uint32_t copy) const;
+        void flush(const uint32_t copy);                                                // copies the commands into the copy read by a frame that is no longer in flight
+
+        utils::Buffer buffer;                                                           // [copy][capacity] commands followed by [copy] draw counts
+        char* mappedData;
+        std::vector<DrawCommand> commands;
+        std::vector<uint64_t> copyVersions;
+        uint64_t version;
+        uint32_t capacity;
+        uint32_t copies;
+        uint32_t drawCount;
+
+        void destroy();
+    };
+}
+
+#endif
\ No newline at end of file
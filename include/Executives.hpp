@@ -5,9 +5,12 @@
 #include<memory>
 #include<vector>
 #include<map>
+#include<string>
 
 namespace spk
 {
+    class RenderTarget;
+
     namespace system
     {
         class Executives
@@ -17,6 +20,22 @@ namespace spk
             const uint32_t getGraphicsQueueFamilyIndex() const;
             const vk::Queue& getGraphicsQueue() const;
             const vk::CommandPool& getPool() const;
+            const uint32_t getComputeQueueFamilyIndex() const;
+            const vk::Queue& getComputeQueue() const;                                   // dedicated compute queue if the device has one, otherwise the graphics queue
+            const vk::CommandPool& getComputePool() const;
+            const bool hasAsyncCompute() const;
+            void addGraphicsWait(const vk::Semaphore& semaphore, const vk::PipelineStageFlags stages, const RenderTarget* consumer);     // the next frame submission of the consumer waits on the semaphore
+            const bool removeGraphicsWait(const vk::Semaphore& semaphore);              // false if a frame submission already waited on it
+            void takeGraphicsWaits(const RenderTarget* consumer, std::vector<vk::Semaphore>& semaphores, std::vector<vk::PipelineStageFlags>& stages, const vk::Fence& fence);   // the fence is signalled by the submission that waits
+            void addFrameSubmission(const vk::Fence& fence);                            // called after every frame submission of a render target
+            void completeFrameSubmission(const vk::Fence& fence);                       // called once the fence has been waited on, before it is reset
+            void waitForFrameSubmissions();                                             // blocks until every frame submitted so far finishes
+            const uint64_t getFrameSubmissionCount() const;
+            const uint64_t getCompletedFrameSubmissions() const;                        // the graphics queue finishes submissions in order, so every earlier one is done too
+            void claimFrameCopies(const void* object, const RenderTarget* target, const std::string& name);     // throws if another render target already indexes the per-frame copies of the object
+            void releaseFrameCopies(const void* object);                                // called when the object is destroyed
+            void releaseFrameCopyOwner(const RenderTarget* target);                     // called when the target is destroyed
+            void waitForGraphicsConsumer(const vk::Semaphore& semaphore);               // blocks until the submission that waited on the semaphore finishes, so it may be signalled again
             std::pair<uint32_t, const vk::Queue*> getPresentQueue(const vk::SurfaceKHR& surface);
             void destroy();
         private:
@@ -26,9 +45,22 @@ namespace spk
             std::vector<vk::QueueFamilyProperties> queueFamilyProperties;
             static std::unique_ptr<Executives> executivesInstance;
             uint32_t graphicsQueueFamilyIndex;
+            uint32_t computeQueueFamilyIndex;
             std::map<uint32_t, vk::Queue> presentQueues;        // key = family index, value = present queue
             vk::Queue graphicsQueue;
             vk::CommandPool pool;
+            vk::Queue computeQueue;
+            vk::CommandPool computePool;
+            std::vector<vk::Semaphore> graphicsWaitSemaphores;
+            std::vector<vk::PipelineStageFlags> graphicsWaitStages;
+            std::vector<const RenderTarget*> graphicsWaitConsumers;
+            std::vector<vk::Semaphore> consumedWaitSemaphores;
+            std::vector<vk::Fence> consumedWaitFences;                                  // fence of the submission that waited on consumedWaitSemaphores[i]
+            std::vector<vk::Fence> pendingFrameFences;
+            std::vector<uint64_t> pendingFrameSerials;                                  // count of frame submissions up to pendingFrameFences[i]
+            uint64_t frameSubmissionCount;
+            uint64_t completedFrameSubmissions;
+            std::map<const void*, const RenderTarget*> frameCopyOwners;                 // [object]: the only target whose frame slots pick its copies
         };
     }
 }
@@ -0,0 +1,56 @@
+#ifndef SPARK_GPU_PROFILER_HPP
+#define SPARK_GPU_PROFILER_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"TimestampQueries.hpp"
+#include<memory>
+#include<vector>
+#include<string>
+
+namespace spk
+{
+    namespace system
+    {
+        class GPUProfiler
+        {
+        public:
+            static GPUProfiler* getInstance();
+            const bool isSupported() const;                                                             // false if the graphics queue can't write timestamps
+            const double toMilliseconds(const uint64_t begin, const uint64_t end) const;
+            void setUploadTimingsEnabled(const bool enabled);
+            const uint32_t beginUpload(vk::CommandBuffer& commandBuffer, const std::string& name);      // returns invalidUpload if upload timings are disabled or every slot is busy
+            void endUpload(vk::CommandBuffer& commandBuffer, const uint32_t upload);                    // the command buffer must be submitted to the graphics queue right after recording
+            const uint64_t markSubmit();                                                                // called on every frame submission; returns its serial
+            void collectUploads(const uint64_t completedSerial, std::vector<GPUTimingRegion>& uploads); // never blocks; completedSerial = serial of a finished frame submission
+            void destroy();
+
+            static constexpr uint32_t invalidUpload = ~0U;
+        private:
+            enum class UploadState
+            {
+                Free,
+                Recording,
+                Submitted
+            };
+
+            struct UploadSlot
+            {
+                std::string name;
+                UploadState state;
+                uint64_t serial;                                                                        // count of frame submissions before the upload
+            };
+
+            GPUProfiler();
+
+            static std::unique_ptr<GPUProfiler> instance;
+            double timestampPeriod;                                                                     // nanoseconds per tick
+            uint64_t timestampMask;
+            bool uploadTimingsEnabled;
+            vk::QueryPool uploadPool;
+            std::vector<UploadSlot> uploadSlots;
+            uint64_t submitCount;
+        };
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef SPARK_GEOMETRY_ARENA_HPP
+#define SPARK_GEOMETRY_ARENA_HPP
+
+#include"VertexBuffer.hpp"
+#include"DrawCommandBuffer.hpp"
+#include<vector>
+#include<map>
+#include<memory>
+
+namespace spk
+{
+    struct MeshRange
+    {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    class GeometryArena                                                                 // many meshes sub-allocated in one vertex buffer per binding and one index buffer
+    {
+    public:
+        GeometryArena();
+        GeometryArena(const std::vector<uint32_t>& cBindings, const std::vector<uint32_t>& cVertexSizes, const uint32_t cVertexCapacity, const uint32_t cIndexCapacity, const IndexType cIndexType = IndexType::uint32);  // sizes of one vertex per binding, in bytes
+        void create(const std::vector<uint32_t>& cBindings, const std::vector<uint32_t>& cVertexSizes, const uint32_t cVertexCapacity, const uint32_t cIndexCapacity, const IndexType cIndexType = IndexType::uint32);      // uint16 limits every mesh to 65536 vertices
+        MeshRange allocate(const uint32_t vertexCount, const uint32_t indexCount);     // throws if no free range is large enough
+        void free(const MeshRange& range);
+        void updateVertices(const MeshRange& range, const uint32_t binding, const void* data);      // vertexCount vertices of the binding
+        void updateIndices(const MeshRange& range, const uint32_t* data);               // indexCount indices, relative to the first vertex of the range; narrowed by uint16 arenas
+        DrawCommand getDrawCommand(const MeshRange& range, const uint32_t instanceCount = 1, const uint32_t firstInstance = 0) const;
+        VertexBuffer* getGeometry();                                                    // for drawIndirect and drawCulled
+        const uint32_t getFreeVertexCount() const;
+        const uint32_t getFreeIndexCount() const;
+    private:
+        class RangeAllocator                                                            // first fit over a sorted free list, neighbours merged on free
+        {
+        public:
+            void reset(const uint32_t capacity);
+            const uint32_t allocate(const uint32_t count);                             // ~0 if nothing fits
+            void free(const uint32_t first, const uint32_t count);
+            const uint32_t getFreeCount() const;
+        private:
+            std::map<uint32_t, uint32_t> freeRanges;                                    // [first]: count
+            uint32_t freeCount;
+        };
+
+        std::unique_ptr<VertexBuffer> geometry;
+        std::map<uint32_t, uint32_t> vertexSizes;                                       // [binding]: size of one vertex
+        IndexType indexType;
+        RangeAllocator vertices;
+        RangeAllocator indices;
+    };
+}
+
+#endif
\ No newline at end of file
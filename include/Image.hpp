@@ -16,10 +16,10 @@ namespace spk
         {
         public:
             Image();
-            Image(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags);
+            Image(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags, const uint32_t cMipLevels = 1);
             Image(const Image& img);
             Image& operator=(const Image& img);
-            void create(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags);
+            void create(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags, const uint32_t cMipLevels = 1);
             static const std::optional<vk::Format> getSupportedFormat(const std::vector<vk::Format>& formats, const vk::ImageTiling tiling, const vk::FormatFeatureFlags flags);
             void changeLayout(vk::CommandBuffer& layoutChangeBuffer, 
                 const vk::ImageLayout newLayout,
@@ -0,0 +1,44 @@
+#ifndef SPARK_INSTANCE_BUFFER_HPP
+#define SPARK_INSTANCE_BUFFER_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"Buffer.hpp"
+#include"Capture.hpp"
+#include<vector>
+
+namespace spk
+{
+    class InstanceBuffer                                                                // per-instance vertex data rewritten by the CPU every frame, e.g. transforms
+    {
+    public:
+        InstanceBuffer();
+        InstanceBuffer(const uint32_t cInstanceSize, const uint32_t cCapacity, const uint32_t cCopies = 3);     // instance size in bytes
+        void create(const uint32_t cInstanceSize, const uint32_t cCapacity, const uint32_t cCopies = 3);
+        void setInstances(const uint32_t first, const uint32_t count, const void* data);
+        void setInstanceCount(const uint32_t count);
+        const uint32_t getInstanceCount() const;
+        const uint32_t getCapacity() const;
+        ~InstanceBuffer();
+    private:
+        friend class RenderTarget;
+        friend class system::Capture;
+        const vk::Buffer& getBuffer() const;
+        const uint32_t getCopyCount() const;
+        const vk::DeviceSize getOffset(const uint32_t copy) const;
+        void flush(const uint32_t copy);                                                // copies the instances into the copy read by a frame that is no longer in flight
+
+        utils::Buffer buffer;                                                           // [copy][capacity] instances, persistently mapped
+        char* mappedData;
+        std::vector<char> instances;
+        std::vector<uint64_t> copyVersions;
+        uint64_t version;
+        uint32_t instanceSize;
+        uint32_t capacity;
+        uint32_t copies;
+        uint32_t instanceCount;
+
+        void destroy();
+    };
+}
+
+#endif
\ No newline at end of file
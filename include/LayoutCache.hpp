@@ -0,0 +1,44 @@
+#ifndef SPARK_LAYOUT_CACHE_HPP
+#define SPARK_LAYOUT_CACHE_HPP
+
+#include"SparkIncludeBase.hpp"
+#include<memory>
+#include<vector>
+#include<map>
+#include<unordered_map>
+
+namespace spk
+{
+    namespace system
+    {
+        class LayoutCache                                                               // structurally equal layouts share one handle, kept until deinit
+        {
+        public:
+            static LayoutCache* getInstance();
+            vk::DescriptorSetLayout getSetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind = false);     // update after bind makes every binding partially bound as well
+            vk::PipelineLayout getPipelineLayout(const std::vector<vk::DescriptorSetLayout>& cSetLayouts, const std::vector<vk::PushConstantRange>& pushConstantRanges = {});
+            const uint32_t getIdentifier(const vk::PipelineLayout& layout) const;       // dense, stable for the lifetime of the cache
+            const uint32_t getSetLayoutCount() const;
+            const uint32_t getPipelineLayoutCount() const;
+            void destroy();
+        private:
+            struct KeyHash
+            {
+                size_t operator()(const std::vector<uint64_t>& key) const;
+            };
+
+            LayoutCache();
+            const uint32_t getSetLayoutIdentifier(const vk::DescriptorSetLayout& layout) const;
+
+            static std::unique_ptr<LayoutCache> instance;
+            std::unordered_map<std::vector<uint64_t>, uint32_t, KeyHash> setLayoutIdentifiers;          // [packed bindings]: index into setLayouts
+            std::unordered_map<std::vector<uint64_t>, uint32_t, KeyHash> pipelineLayoutIdentifiers;     // [set layout identifiers and packed push constant ranges]: index into pipelineLayouts
+            std::vector<vk::DescriptorSetLayout> setLayouts;
+            std::vector<vk::PipelineLayout> pipelineLayouts;
+            std::map<vk::DescriptorSetLayout, uint32_t> setLayoutHandles;
+            std::map<vk::PipelineLayout, uint32_t> pipelineLayoutHandles;
+        };
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef SPARK_MESH_OPTIMIZER_HPP
+#define SPARK_MESH_OPTIMIZER_HPP
+
+#include<cstdint>
+#include<vector>
+
+namespace spk
+{
+    namespace utils                                                                     // load-time processing of indexed triangle lists, before they are uploaded to a VertexBuffer
+    {
+        struct VertexCacheStatistics
+        {
+            float acmr;                                                                 // transformed vertices per triangle; 3 without reuse, about 0.5 at best
+            float atvr;                                                                 // transformed vertices per referenced vertex; 1 at best
+        };
+
+        struct MeshOptimizationOptions
+        {
+            bool deduplicate = true;
+            bool optimizeVertexCache = true;
+            bool optimizeOverdraw = true;                                               // needs the vertex cache pass
+            bool optimizeVertexFetch = true;
+            uint32_t cacheSize = 16;
+            float overdrawThreshold = 1.05f;                                            // how much the ACMR may grow to allow a better triangle order
+        };
+
+        struct MeshOptimizationReport
+        {
+            VertexCacheStatistics before;
+            VertexCacheStatistics after;
+            uint32_t vertexCountBefore;
+            uint32_t vertexCountAfter;
+        };
+
+        struct LevelOfDetail
+        {
+            std::vector<uint32_t> indices;                                              // a coarser triangle list over the same vertices
+            float error;                                                                // how far the surface may have moved from the original, in position units
+        };
+
+        VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize = 16);   // simulates a FIFO post-transform cache
+        uint32_t deduplicateVertices(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices);                        // empty indices are generated; returns the new vertex count
+        std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize = 16);      // Tipsify; returns the first triangle of every cluster
+        void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const char* positions, const uint32_t stride, const uint32_t vertexCount, const float threshold = 1.05f, const uint32_t cacheSize = 16);     // positions are 3 floats every stride bytes
+        uint32_t optimizeVertexFetch(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices);                        // vertices in order of first use, unused ones dropped; returns the new vertex count
+        MeshOptimizationReport optimizeMesh(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices, const uint32_t positionOffset, const MeshOptimizationOptions& options = MeshOptimizationOptions());     // one interleaved binding
+        LevelOfDetail simplifyMesh(const std::vector<uint32_t>& indices, const char* positions, const uint32_t stride, const uint32_t vertexCount, const uint32_t targetIndexCount);      // quadric edge collapse onto existing vertices; border and seam vertices stay in place
+        std::vector<LevelOfDetail> generateLevelsOfDetail(const std::vector<uint32_t>& indices, const char* positions, const uint32_t stride, const uint32_t vertexCount, const uint32_t maxLevelCount = 4, const float reduction = 0.5f, const uint32_t cacheSize = 16);   // each level keeps about reduction of the triangles of the previous one, vertex cache optimized; stops early once simplification stalls
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef SPARK_MODEL_HPP
+#define SPARK_MODEL_HPP
+
+#include"VertexBuffer.hpp"
+#include"MeshOptimizer.hpp"
+#include<memory>
+#include<vector>
+#include<string>
+
+namespace spk
+{
+    struct ModelVertex                                                                  // binding 0: position at location 0, normal at 1, texture coordinates at 2
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    struct ModelMaterial                                                                // texture files, empty if the material has none; textures embedded in the model are named "*index"
+    {
+        std::string diffuseTexture;
+        std::string normalTexture;
+    };
+
+    struct ModelImportOptions
+    {
+        bool optimize = true;                                                           // runs optimizeMesh before the cache is written
+        uint32_t levelsOfDetail = 3;                                                    // coarser levels generated per mesh, at most
+        bool flipUVs = false;
+        bool useCache = true;
+    };
+
+    class Model                                                                         // meshes imported with assimp, cached in a flat binary file that later loads are memory-mapped from
+    {
+    public:
+        Model();
+        Model(const std::string& filename, const ModelImportOptions& options = ModelImportOptions());
+        void load(const std::string& filename, const ModelImportOptions& options = ModelImportOptions());     // the cache is filename + ".spkmodel", rebuilt when the model file changes
+        const uint32_t getMeshCount() const;
+        VertexBuffer* getVertexBuffer(const uint32_t mesh);
+        const uint32_t getMaterialIndex(const uint32_t mesh) const;
+        const std::vector<ModelMaterial>& getMaterials() const;
+        const VertexAlignmentInfo& getAlignmentInfo() const;
+        const bool isLoadedFromCache() const;
+        const std::vector<utils::MeshOptimizationReport>& getOptimizationReports() const;      // per mesh, empty if loaded from the cache or not optimized
+    private:
+        struct ImportedMesh
+        {
+            std::vector<char> vertices;
+            std::vector<uint32_t> indices;
+            std::vector<utils::LevelOfDetail> levels;
+            BoundingSphere bounds;
+            uint32_t materialIndex;
+        };
+
+        bool loadCache(const std::string& cacheFilename, const std::string& filename, const ModelImportOptions& options);
+        void import(const std::string& filename, const ModelImportOptions& options, std::vector<ImportedMesh>& meshes);
+        void writeCache(const std::string& cacheFilename, const std::string& filename, const ModelImportOptions& options, const std::vector<ImportedMesh>& meshes) const;
+        void addMesh(const void* vertices, const uint32_t vertexCount, const uint32_t* indices, const uint32_t indexCount, const uint32_t materialIndex, const BoundingSphere& bounds, const std::vector<utils::LevelOfDetail>& levels);
+
+        std::vector<std::unique_ptr<VertexBuffer> > vertexBuffers;
+        std::vector<uint32_t> materialIndices;
+        std::vector<ModelMaterial> materials;
+        std::vector<utils::MeshOptimizationReport> optimizationReports;
+        VertexAlignmentInfo alignmentInfo;
+        bool loadedFromCache;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef SPARK_OFFSCREEN_TARGET_HPP
+#define SPARK_OFFSCREEN_TARGET_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"RenderTarget.hpp"
+#include"Image.hpp"
+#include"ImageView.hpp"
+
+namespace spk
+{
+    class OffscreenTarget : public RenderTarget                                        // renders into a ring of images without GLFW, a surface or a swapchain
+    {
+    public:
+        OffscreenTarget();
+        OffscreenTarget(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions);
+        void create(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions);
+        void destroy();
+        const uint32_t getImageCount() const;
+        ~OffscreenTarget();
+    private:
+        std::vector<utils::Image> colorImages;
+        std::vector<utils::ImageView> colorImageViews;
+        vk::Format colorImageFormat;
+        uint32_t nextImage;
+
+        void createColorImages(const uint32_t count);
+        vk::Semaphore acquireImage(const uint32_t frame, uint32_t& imageIndex) override;
+        vk::Semaphore getRenderFinishedSemaphore(const uint32_t frame) const override;
+        void present(const uint32_t frame, const uint32_t imageIndex) override;
+        const vk::Image& getColorImage(const uint32_t imageIndex) const override;
+    };
+}
+
+#endif
\ No newline at end of file
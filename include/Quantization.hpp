@@ -0,0 +1,21 @@
+#ifndef SPARK_QUANTIZATION_HPP
+#define SPARK_QUANTIZATION_HPP
+
+#include<cstdint>
+#include<cstddef>
+
+namespace spk
+{
+    namespace utils                                                                     // CPU-side conversions for the packed FieldFormats; SSE2 when available, scalar otherwise
+    {
+        void quantizeHalf(const float* src, uint16_t* dst, const size_t count);         // IEEE half, rounded to nearest even
+        void quantizeSnorm16(const float* src, int16_t* dst, const size_t count);       // values are clamped to [-1, 1]
+        void quantizeUnorm16(const float* src, uint16_t* dst, const size_t count);      // values are clamped to [0, 1]
+        void quantizeSnorm8(const float* src, int8_t* dst, const size_t count);
+        void quantizeUnorm8(const float* src, uint8_t* dst, const size_t count);
+        void packSnorm1010102(const float* src, uint32_t* dst, const size_t count);     // count xyzw vectors, for vec4snorm1010102 fields
+        void packOctahedral(const float* normals, int16_t* dst, const size_t count);    // count unit xyz normals to count snorm16 pairs, for vec2snorm16 fields
+    }
+}
+
+#endif
\ No newline at end of file
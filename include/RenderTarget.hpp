@@ -0,0 +1,229 @@
+#ifndef SPARK_RENDER_TARGET_HPP
+#define SPARK_RENDER_TARGET_HPP
+
+#include"SparkIncludeBase.hpp"
+#include<memory>
+#include<string>
+#include<map>
+#include<tuple>
+#include<algorithm>
+#include<functional>
+#include"ResourceSet.hpp"
+#include"VertexBuffer.hpp"
+#include"ShaderSet.hpp"
+#include"Image.hpp"
+#include"ImageView.hpp"
+#include"Buffer.hpp"
+#include"TimestampQueries.hpp"
+#include"DrawCommandBuffer.hpp"
+#include"CullingSet.hpp"
+#include"Capture.hpp"
+
+namespace spk
+{
+    enum class CullMode
+    {
+        Clockwise,
+        CounterClockwise,
+        None
+    };
+
+    enum class PresentMode
+    {
+        Fifo,
+        FifoRelaxed,
+        Mailbox,
+        Immediate,
+        Uncapped
+    };
+
+    struct DrawOptions
+    {
+        CullMode cullMode;
+        PresentMode presentMode = PresentMode::Fifo;
+        uint32_t minImageCount = 0;                                                     // 0 = one image more than the surface minimum (3 images for offscreen targets)
+        uint32_t maxFramesInFlight = 1;                                                 // above 1 frames overlap: static uniform buffers must then not be updated between draws
+        bool storeDepth = false;                                                        // keeps the depth attachment after the render pass (needed for depth readback)
+        bool gpuTimings = false;                                                        // records GPU timestamps around the render pass, draw groups and uploads
+        bool occlusionCulling = false;                                                  // builds a depth pyramid after frames with culled draws; otherwise drawCulled tests the frustum only
+        std::string shaderDirectory = "shaders/";                                       // where drawCulled loads cull.comp.spv and hiz.comp.spv from
+    };
+
+    enum class ReadbackAttachment
+    {
+        Color,
+        Depth
+    };
+
+    typedef uint64_t ReadbackHandle;
+    const ReadbackHandle invalidReadback = 0;
+    typedef std::function<void(const void* data, const size_t size)> ReadbackCallback;
+
+    class RenderTarget                                                                  // common drawing machinery of Window and OffscreenTarget
+    {
+    public:
+        void draw(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, const ShaderSet* shaders);
+        void drawIndirect(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, VertexBuffer* geometry, DrawCommandBuffer* drawCommands, const ShaderSet* shaders);  // the whole batch in one indirect draw over the shared, indexed geometry
+        void drawCulled(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, VertexBuffer* geometry, CullingSet* objects, const ShaderSet* shaders);              // like drawIndirect, drawing only the objects that pass the GPU cull
+        void setLevelOfDetailView(const float* viewProjection, const float pixelError = 1.0f);     // draw picks the level of detail of every vertex buffer as seen through viewProjection; nullptr draws level 0
+        const uint32_t getWidth() const;
+        const uint32_t getHeight() const;
+        ReadbackHandle requestReadback(const ReadbackAttachment attachment, const ReadbackCallback callback = nullptr);  // copies the attachment at the end of the next drawn frame; returns invalidReadback if every staging buffer is busy
+        const bool isReadbackReady(const ReadbackHandle handle);                                                         // never blocks
+        const void* getReadbackData(const ReadbackHandle handle) const;                                                  // valid until releaseReadback
+        const size_t getReadbackSize(const ReadbackHandle handle) const;
+        void releaseReadback(const ReadbackHandle handle);                                                               // readbacks with a callback are released after the callback returns
+        void setTimingRegion(const std::string& name, const uint32_t firstDraw, const uint32_t drawCount);              // times the given range of vertex buffers as one region
+        void clearTimingRegions();
+        const GPUFrameTimings& getGPUTimings() const;                                                                    // latest timings read back; lag behind by framesInFlight frames
+        virtual ~RenderTarget();
+    protected:
+        friend class system::Capture;
+        RenderTarget();
+        void init(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions);
+        void createTarget(const vk::Format cColorFormat, const vk::ImageLayout cColorFinalLayout, const std::vector<vk::ImageView>& cColorViews, const uint32_t depthMapCount);
+        void destroyTarget();
+        virtual vk::Semaphore acquireImage(const uint32_t frame, uint32_t& imageIndex) = 0;     // returns the semaphore the render submission waits on, if any
+        virtual vk::Semaphore getRenderFinishedSemaphore(const uint32_t frame) const = 0;      // semaphore signaled by the render submission, if any
+        virtual void present(const uint32_t frame, const uint32_t imageIndex) = 0;
+        virtual const vk::Image& getColorImage(const uint32_t imageIndex) const = 0;
+
+        uint32_t width;
+        uint32_t height;
+        DrawOptions options;
+        uint32_t framesInFlight;
+        uint32_t imageCount;
+        bool colorReadable;                                                             // false if the color images can't be used as transfer source
+    private:
+        struct DrawComponents
+        {
+            vk::Pipeline pipeline;
+            const VertexAlignmentInfo* alignmentInfo;
+            const ShaderSet* shaders;
+        };
+
+        enum class ReadbackState
+        {
+            Free,
+            Requested,
+            Pending,
+            Ready
+        };
+
+        struct TimingRegion
+        {
+            std::string name;
+            uint32_t firstDraw;
+            uint32_t drawCount;
+        };
+
+        struct RecordedCommands                                                         // what one recording of a frame command buffer issues, counted on every submit
+        {
+            uint32_t draws = 0;                                                         // an indirect command counts once, however many draws the GPU runs
+            uint32_t pipelineBinds = 0;
+            uint32_t descriptorBinds = 0;
+            uint32_t vertexBufferBinds = 0;
+            uint32_t indexBufferBinds = 0;
+        };
+
+        struct ReadbackSlot
+        {
+            utils::Buffer buffer;
+            const void* data;
+            vk::CommandBuffer commandBuffer;
+            vk::Fence fence;
+            ReadbackHandle handle;
+            ReadbackAttachment attachment;
+            ReadbackCallback callback;
+            ReadbackState state;
+            size_t size;
+        };
+
+        std::vector<utils::Image> depthMaps;                                            // one shared map for windows, one per image for offscreen targets
+        std::vector<utils::ImageView> depthMapViews;
+        vk::Format depthMapFormat;
+        vk::Format colorFormat;
+        vk::ImageLayout colorFinalLayout;
+        vk::RenderPass renderPass;
+        std::vector<vk::Framebuffer> framebuffers;
+        std::vector<vk::CommandBuffer> frameCommandBuffers;                             // [frame * imageCount + image]
+        std::vector<uint32_t> frameCommandBufferVersions;
+        std::vector<RecordedCommands> frameCommandCounts;                               // [frame * imageCount + image]
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, DrawComponents> drawComponents; // [layout identifier, alignment info identifier, shader set identifier]
+        std::tuple<uint32_t, uint32_t, uint32_t> currentPipeline;
+        uint32_t currentResources;                                                      // identifier of the resource set bound by the command buffers
+        std::vector<VertexBuffer*> currentVertexBuffers;
+        const DrawCommandBuffer* currentDrawCommands;
+        const CullingSet* currentCulling;
+        uint32_t currentDrawCount;                                                      // recorded into the command buffers unless the draw count is read from the GPU
+        std::vector<uint64_t> currentInstancing;                                        // instance counts, first instances and instance buffers of the vertex buffers
+        std::vector<uint64_t> currentLevelsOfDetail;                                    // selected level and level version of the vertex buffers
+        std::vector<uint64_t> currentPushConstants;                                     // push constant versions of the vertex buffers
+        float levelOfDetailView[16];
+        float levelOfDetailPixelError;
+        bool levelOfDetailViewSet;
+        bool drawIndirectCount;                                                         // VK_KHR_draw_indirect_count and multiDrawIndirect are available
+        uint32_t contentVersion;
+        std::vector<vk::Fence> frameFences;                                             // per frame in flight
+        std::vector<vk::Fence> imageFences;                                             // fence of the frame that last rendered to the image
+        uint32_t currentFrame;
+        bool frameWaited;
+        std::vector<ReadbackSlot> readbackSlots;                                        // staging ring, created on the first request
+        ReadbackHandle readbackCount;
+        std::vector<utils::TimestampQueries> frameTimestamps;                           // per command buffer, empty if GPU timings are disabled
+        std::vector<uint32_t> frameSubmittedCommandBuffers;                             // per frame in flight
+        std::vector<uint64_t> frameSubmitSerials;                                       // per frame in flight, 0 = nothing to collect
+        std::vector<uint64_t> frameDrawNumbers;                                         // per frame in flight
+        std::vector<uint64_t> frameSubmitTimes;                                         // per frame in flight, tracer time base; anchors GPU spans on the trace timeline
+        std::vector<TimingRegion> timingRegions;
+        uint64_t drawNumber;
+        GPUFrameTimings gpuTimings;
+        std::unique_ptr<ShaderSet> cullShaders;                                         // culling objects are created by the first drawCulled
+        std::unique_ptr<ShaderSet> pyramidShaders;
+        vk::DescriptorSetLayout cullingSetLayout;
+        vk::DescriptorSetLayout pyramidSampleLayout;
+        vk::DescriptorSetLayout pyramidBuildLayout;
+        vk::PipelineLayout cullPipelineLayout;
+        vk::PipelineLayout pyramidPipelineLayout;
+        vk::Pipeline cullPipeline;
+        vk::Pipeline pyramidPipeline;
+        utils::Image depthPyramid;                                                      // max depth per texel, level 0 matches the depth maps; 1x1 without occlusion culling
+        std::vector<utils::ImageView> depthPyramidViews;                                // all levels, then one view per level
+        vk::Sampler pyramidSampler;                                                     // owned by the sampler cache
+        vk::DescriptorPool cullingDescriptorPool;
+        vk::DescriptorSet pyramidSampleSet;
+        std::vector<vk::DescriptorSet> pyramidBuildSets;                                // level 0 from each depth map, then every other level from the previous one
+        uint32_t pyramidLevels;
+
+        void createSyncObjects();
+        void createDepthMaps(const uint32_t count);
+        void createRenderPass();
+        void createFramebuffers(const std::vector<vk::ImageView>& colorViews);
+        std::pair<vk::VertexInputBindingDescription, std::vector<vk::VertexInputAttributeDescription> > createPipelineVertexInputStateBase(const BindingAlignmentInfo& vertexAlignmentInfo);
+        void createPipeline(vk::Pipeline& pipeline, const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos, const std::vector<BindingAlignmentInfo>& vertexAlignmentInfos, const vk::PipelineLayout& layout);
+        void createCommandBuffers();
+        void drawFrame(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, DrawCommandBuffer* drawCommands, CullingSet* culling, const ShaderSet* shaders);
+        void initCommandBuffer(vk::CommandBuffer& commandBuffer, const uint32_t frame, const uint32_t imageIndex, DrawComponents& drawComponents, const ResourceSet* resources, const std::vector<VertexBuffer*>& vertexBuffers, const DrawCommandBuffer* drawCommands, const CullingSet* culling, utils::TimestampQueries* timestamps, RecordedCommands& counts);
+        void pushDrawConstants(vk::CommandBuffer& commandBuffer, const ResourceSet* resources, const VertexBuffer* vertexBuffer);
+        void bindVertexBuffers(vk::CommandBuffer& commandBuffer, const VertexBuffer* vertexBuffer, const std::vector<BindingAlignmentInfo>& alignmentInfos, const uint32_t frame, RecordedCommands& counts);
+        void recordIndirectDraws(vk::CommandBuffer& commandBuffer, const uint32_t frame, const VertexBuffer* geometry, const std::vector<BindingAlignmentInfo>& alignmentInfos, const vk::Buffer& commands, const vk::DeviceSize commandOffset, const vk::DeviceSize countOffset, const uint32_t maxDrawCount, RecordedCommands& counts);
+        void createCulling();
+        void createDepthPyramid();
+        void recordCulling(vk::CommandBuffer& commandBuffer, const uint32_t frame, const CullingSet* culling, RecordedCommands& counts);
+        void recordDepthPyramid(vk::CommandBuffer& commandBuffer, const uint32_t imageIndex, RecordedCommands& counts);
+        void destroyCulling();
+        void waitForFrame();
+        void createReadbackSlots();                                                     // sized for the attachments this target can read back
+        const size_t getTexelSize(const vk::Format format) const;                       // 0 if the format can't be read back
+        ReadbackSlot* findReadbackSlot(const ReadbackHandle handle);
+        const ReadbackSlot* findReadbackSlot(const ReadbackHandle handle) const;
+        void pollReadbacks();
+        void recordReadback(ReadbackSlot& slot, const uint32_t imageIndex);
+        void destroyReadbackSlots();
+        void createTimestampQueries();
+        void collectTimings();
+    };
+
+}
+
+#endif
\ No newline at end of file
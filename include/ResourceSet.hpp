@@ -3,6 +3,10 @@
 
 #include"Texture.hpp"
 #include"UniformBuffer.hpp"
+#include"StorageBuffer.hpp"
+#include"Capture.hpp"
+#include"DescriptorAllocator.hpp"
+#include"LayoutCache.hpp"
 #include<map>
 #include"SparkIncludeBase.hpp"
 
@@ -14,40 +18,69 @@ namespace spk
     public:
         ResourceSet();
         ResourceSet(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers);
+        ResourceSet(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers, std::vector<StorageBuffer>& cStorageBuffers);
         ResourceSet(const ResourceSet& set);
         ResourceSet& operator=(const ResourceSet& set);
         void create(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers);
+        void create(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers, std::vector<StorageBuffer>& cStorageBuffers);
         void update(const uint32_t set, const uint32_t binding, const void* data);
+        void setPushConstantSize(const uint32_t size);                                  // bytes of per-draw data at offset 0, visible to every stage; 0 removes the range
+        const uint32_t getPushConstantSize() const;
+        void setBindlessSet(const uint32_t set, const uint32_t capacity);               // before create: textures of the set become elements of one array, indexed by their binding
+        void addTexture(const Texture& texture);                                        // into the bindless set, also while command buffers using it are in flight
         ~ResourceSet();
     private:
+        enum class ResourceType
+        {
+            Texture,
+            UniformBuffer,
+            DynamicUniformBuffer,
+            StorageBuffer
+        };
+
         struct ResourceSetContainmentInfo
         {
-            std::map<uint32_t, std::pair<uint32_t, bool> > bindings; // [binding]: {resourceVectorIndex, texture or buffer (t or f)}
+            std::map<uint32_t, std::pair<uint32_t, ResourceType> > bindings; // [binding]: {resourceVectorIndex, type of the resource vector}
         };
 
-        friend class Window;
+        friend class RenderTarget;
+        friend class ComputeTask;
+        friend class system::Capture;
         const vk::PipelineLayout& getPipelineLayout() const;
         const std::vector<vk::DescriptorSet>& getDescriptorSets() const;
         const uint32_t getIdentifier() const;
+        const uint32_t getLayoutIdentifier() const;                                     // equal for sets with structurally equal layouts
+        const bool isBindless(const uint32_t set) const;
+        const vk::ShaderStageFlags getPushConstantStages() const;
+        const std::vector<vk::PushConstantRange> getPushConstantRanges() const;
+        const uint32_t getCopyCount() const;                                            // of the dynamic uniform buffers, ~0 if there are none
+        const std::vector<uint32_t> getDynamicOffsets(const uint32_t copy) const;      // in set and binding order, as bindDescriptorSets expects them
+        void flush(const uint32_t copy) const;
 
         std::vector<Texture> textures;
         std::vector<UniformBuffer> uniformBuffers;
-        vk::DescriptorPool descriptorPool;
-        vk::Sampler uniqueSampler;
+        std::vector<StorageBuffer> storageBuffers;
         std::map<uint32_t, ResourceSetContainmentInfo> setContainmentData; // [setIndex]: {bindings}
         std::vector<vk::DescriptorSet> descriptorSets;
         std::vector<vk::DescriptorSetLayout> descriptorLayouts;
+        std::vector<std::vector<vk::DescriptorSetLayoutBinding> > layoutBindings;       // [setIndex], kept for the descriptor allocator
         vk::PipelineLayout pipelineLayout;
         static uint32_t count;
         uint32_t identifier;
+        uint32_t layoutIdentifier;
+        uint32_t pushConstantSize;
+        uint32_t bindlessSet;
+        uint32_t bindlessCapacity;                                                      // 0 if there is no bindless set
 
         void init();
+        void addBinding(const uint32_t set, const uint32_t binding, const uint32_t index, const ResourceType type);
+        const vk::DescriptorType getDescriptorType(const ResourceType type) const;
         void bindTextureMemory();
         void bindBufferMemory();
-        void createDescriptorPool();
         void createDescriptorLayouts();
         void allocateDescriptorSets();
         void writeDescriptorData();
+        const vk::DescriptorImageInfo getImageInfo(const uint32_t index) const;
         void destroy();
     };
 
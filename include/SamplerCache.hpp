@@ -0,0 +1,58 @@
+#ifndef SPARK_SAMPLER_CACHE_HPP
+#define SPARK_SAMPLER_CACHE_HPP
+
+#include"SparkIncludeBase.hpp"
+#include<memory>
+#include<vector>
+#include<map>
+
+namespace spk
+{
+    enum class Filter
+    {
+        Nearest,
+        Linear
+    };
+
+    enum class AddressMode
+    {
+        Repeat,
+        MirroredRepeat,
+        ClampToEdge,
+        ClampToBorder                                                                   // transparent black border
+    };
+
+    struct SamplerInfo
+    {
+        Filter magFilter = Filter::Linear;
+        Filter minFilter = Filter::Nearest;
+        Filter mipmapFilter = Filter::Nearest;                                          // between mip levels
+        AddressMode addressModeU = AddressMode::Repeat;
+        AddressMode addressModeV = AddressMode::Repeat;
+        AddressMode addressModeW = AddressMode::Repeat;
+        float maxAnisotropy = 1.0f;                                                     // 1 turns anisotropic filtering off, larger values are clamped to the device limit
+        float minLod = 0.0f;
+        float maxLod = 1.0f;
+    };
+
+    namespace system
+    {
+        class SamplerCache                                                              // samplers of every Spark object, shared by equal descriptions and kept until deinit
+        {
+        public:
+            static SamplerCache* getInstance();
+            vk::Sampler getSampler(const SamplerInfo& info);
+            const uint32_t getSamplerCount() const;
+            void destroy();
+        private:
+            SamplerCache();
+
+            static std::unique_ptr<SamplerCache> instance;
+            std::map<std::vector<uint32_t>, vk::Sampler> samplers;                      // [packed description, anisotropy already clamped]
+            float maxAnisotropy;                                                        // 1 if samplerAnisotropy is not enabled
+            uint32_t maxSamplers;                                                       // maxSamplerAllocationCount
+        };
+    }
+}
+
+#endif
\ No newline at end of file
@@ -6,13 +6,15 @@
 #include<string>
 #include<fstream>
 #include"System.hpp"
+#include"Capture.hpp"
 
 namespace spk
 {
     enum class ShaderType
     {
         Vertex, 
-        Fragment
+        Fragment,
+        Compute
     };
 
     struct ShaderInfo
@@ -31,7 +33,9 @@ namespace spk
         ShaderSet& operator=(const ShaderSet& set);
         ~ShaderSet();
     private:
-        friend class Window;
+        friend class RenderTarget;
+        friend class system::Capture;
+        friend class ComputeTask;
         const std::vector<vk::PipelineShaderStageCreateInfo>& getShaderStages() const;
         const uint32_t getIdentifier() const;
         void destroy();
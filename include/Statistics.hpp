@@ -0,0 +1,61 @@
+#ifndef SPARK_STATISTICS_HPP
+#define SPARK_STATISTICS_HPP
+
+#include"SparkIncludeBase.hpp"
+#include<memory>
+#include<vector>
+#include<chrono>
+
+namespace spk
+{
+    struct FrameStatistics
+    {
+        double cpuFrameMilliseconds = 0;                                                // time between the starts of two consecutive draw calls
+        double cpuDrawMilliseconds = 0;                                                 // time spent inside draw
+        uint32_t queueSubmits = 0;
+        uint32_t commandBufferRecords = 0;
+        uint32_t drawCalls = 0;
+        uint32_t pipelineBinds = 0;
+        uint32_t descriptorBinds = 0;
+        uint32_t vertexBufferBinds = 0;
+        uint32_t indexBufferBinds = 0;
+        uint64_t bytesUploaded = 0;                                                     // bytes written by the CPU into GPU-visible memory
+        uint32_t fenceWaits = 0;
+        double fenceWaitMilliseconds = 0;                                               // time the CPU was blocked on fences
+        uint32_t allocations = 0;                                                       // device memory allocations
+        uint64_t bytesAllocated = 0;
+    };
+
+    namespace system
+    {
+        class Statistics                                                                // counts work between two consecutive draw calls of any render target
+        {
+        public:
+            static Statistics* getInstance();
+            void countSubmit();
+            void countCommandBufferRecord();
+            void countCommands(const uint32_t draws, const uint32_t pipelineBinds, const uint32_t descriptorBinds, const uint32_t vertexBufferBinds, const uint32_t indexBufferBinds);
+            void countUpload(const vk::DeviceSize bytes);
+            void countAllocation(const vk::DeviceSize bytes);
+            void countDrawTime(const std::chrono::steady_clock::duration time);
+            vk::Result waitForFences(const uint32_t fenceCount, const vk::Fence* fences, const uint64_t timeout);   // vk::Device::waitForFences that counts the wait and the blocked time
+            void endFrame();                                                            // called at the start of every draw call
+            const FrameStatistics& getLastFrame() const;
+            FrameStatistics getAverage() const;                                         // over the last completed frames, up to the averaging window
+            void setAverageWindow(const uint32_t frames);                               // 60 frames by default
+        private:
+            Statistics();
+
+            static std::unique_ptr<Statistics> instance;
+            FrameStatistics current;
+            FrameStatistics lastFrame;
+            std::vector<FrameStatistics> history;                                       // ring of completed frames
+            uint32_t historyNext;
+            uint32_t historyCount;
+            std::chrono::steady_clock::time_point frameStart;
+            bool frameStarted;
+        };
+    }
+}
+
+#endif
\ No newline at end of file
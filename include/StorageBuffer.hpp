@@ -0,0 +1,46 @@
+#ifndef SPARK_STORAGE_BUFFER_HPP
+#define SPARK_STORAGE_BUFFER_HPP
+
+#include"MemoryManager.hpp"
+#include"System.hpp"
+#include"Executives.hpp"
+#include"Buffer.hpp"
+#include"Capture.hpp"
+
+namespace spk
+{
+
+    class StorageBuffer                                                                 // device-local buffer that shaders (compute ones first of all) read and write
+    {
+    public:
+        StorageBuffer();
+        StorageBuffer(const StorageBuffer& sb);
+        StorageBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding);
+        void create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding);
+        StorageBuffer& operator=(const StorageBuffer& rBuffer);
+        void resetSetIndex(const uint32_t newIndex);
+        void resetBinding(const uint32_t newBinding);
+        ~StorageBuffer();
+    private:
+        friend class ResourceSet;
+        friend class system::Capture;
+        void bindMemory();
+        void update(const void* data);                                                  // uploads through a staging buffer and waits for the copy
+        const vk::Buffer& getBuffer() const;
+        const vk::DeviceSize getSize() const;
+        const uint32_t getSet() const;
+        const uint32_t getBinding() const;
+
+        utils::Buffer buffer;
+        size_t size;
+        uint32_t setIndex;
+        uint32_t binding;
+        vk::CommandBuffer updateCommandBuffer;
+        vk::Fence updatedFence;
+
+        void destroy();
+    };
+
+}
+
+#endif
\ No newline at end of file
@@ -17,8 +17,10 @@ namespace spk
         const bool enableValidation = false;
         #endif
 
-        void init();
+        void init(const bool headless = false);                                         // headless mode runs without GLFW, surfaces and VK_KHR_swapchain
         void deinit();
+        void loadPipelineCache(const std::string& filename);                            // replaces the pipeline cache with the file contents; starts empty if the file can't be read
+        void savePipelineCache(const std::string& filename);
 
         class System
         {
@@ -30,8 +32,17 @@ namespace spk
             const vk::Instance& getvkInstance() const;
             const vk::Device& getLogicalDevice() const;
             const vk::PhysicalDevice& getPhysicalDevice() const;
+            const vk::PipelineCache& getPipelineCache() const;
+            const vk::DispatchLoaderDynamic& getLoader() const;
+            const vk::PhysicalDeviceFeatures& getEnabledFeatures() const;
+            const bool isExtensionEnabled(const std::string& name) const;              // device extensions, including the optional ones found on the device
+            const uint32_t getMaxBindlessTextures() const;                              // size limit of a bindless texture array, 0 without descriptor indexing
+            const bool isHeadless() const;
             void destroy();
         private:
+            friend void init(const bool headless);
+            friend void loadPipelineCache(const std::string& filename);
+            friend void savePipelineCache(const std::string& filename);
             System();
             std::vector<const char*> getInstanceExtensions() const;
             std::vector<const char*> getDeviceExtensions() const;
@@ -39,14 +50,21 @@ namespace spk
             void createInstance();
             void createPhysicalDevice();
             void createLogicalDevice();
+            void createPipelineCache(const std::vector<char>& initialData);
             static VKAPI_ATTR VkBool32 VKAPI_CALL callback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData);
 
             static std::unique_ptr<System> systemInstance;
+            static bool headlessMode;
             vk::Instance instance;
             vk::PhysicalDevice physicalDevice;
             vk::Device logicalDevice;
             vk::DispatchLoaderDynamic loader;
             vk::DebugUtilsMessengerEXT debugMessenger;
+            vk::PipelineCache pipelineCache;
+            vk::PhysicalDeviceFeatures enabledFeatures;
+            std::vector<std::string> enabledExtensions;
+            bool properties2;                                                           // VK_KHR_get_physical_device_properties2 is enabled on the instance
+            uint32_t maxBindlessTextures;
         };
 
         void yeet(const std::string error);
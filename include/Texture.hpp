@@ -7,6 +7,8 @@
 #include"Image.hpp"
 #include"ImageView.hpp"
 #include"Buffer.hpp"
+#include"Capture.hpp"
+#include"SamplerCache.hpp"
 
 namespace spk
 {
@@ -28,6 +30,8 @@ namespace spk
         Texture& operator=(Texture& rTexture);
         void resetSetIndex(const uint32_t newIndex);
         void resetBinding(const uint32_t newBinding);
+        void setSamplerInfo(const SamplerInfo& info);                                   // before the texture is placed into a resource set
+        const SamplerInfo& getSamplerInfo() const;
         ~Texture();
     private:
     
@@ -52,6 +56,7 @@ namespace spk
         };
 
         friend class ResourceSet;
+        friend class system::Capture;
         const vk::ImageView& getImageView() const;
         const vk::ImageLayout getLayout() const;
         void bindMemory();
@@ -61,6 +66,7 @@ namespace spk
 
         ImageInfo imageInfo;
         ImageFormat imageFormat;
+        SamplerInfo samplerInfo;
         utils::Image image;
         utils::ImageView imageView;
 
@@ -0,0 +1,50 @@
+#ifndef SPARK_TIMESTAMP_QUERIES_HPP
+#define SPARK_TIMESTAMP_QUERIES_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"System.hpp"
+#include<vector>
+#include<string>
+
+namespace spk
+{
+    struct GPUTimingRegion
+    {
+        std::string name;
+        double milliseconds;
+        double startMilliseconds;                                                       // relative to the start of the frame; 0 for uploads
+    };
+
+    struct GPUFrameTimings
+    {
+        uint64_t frame = 0;                                                             // number of the draw call (starting from 1) the timings belong to; 0 = no timings yet
+        double milliseconds = 0;                                                        // whole frame command buffer
+        std::vector<GPUTimingRegion> regions;                                           // render pass, draw groups and user-defined regions
+        std::vector<GPUTimingRegion> uploads;                                           // uploads completed since the previous timings
+    };
+
+    namespace utils
+    {
+        class TimestampQueries                                                          // begin/end timestamp pairs recorded into one command buffer
+        {
+        public:
+            static constexpr uint32_t invalidRegion = ~0U;
+
+            TimestampQueries();
+            TimestampQueries(const uint32_t cRegionCapacity);
+            void create(const uint32_t cRegionCapacity);
+            void reset(vk::CommandBuffer& commandBuffer);                               // must be recorded outside of render pass, before the first region
+            const uint32_t begin(vk::CommandBuffer& commandBuffer, const std::string& name);   // returns invalidRegion if the capacity is exhausted
+            void end(vk::CommandBuffer& commandBuffer, const uint32_t region);
+            const bool collect(std::vector<GPUTimingRegion>& regions) const;            // never blocks; false if the command buffer hasn't finished yet
+            void destroy();
+            ~TimestampQueries();
+        private:
+            vk::QueryPool pool;
+            uint32_t regionCapacity;
+            std::vector<std::string> names;
+        };
+    }
+}
+
+#endif
\ No newline at end of file
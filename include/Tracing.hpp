@@ -0,0 +1,86 @@
+#ifndef SPARK_TRACING_HPP
+#define SPARK_TRACING_HPP
+
+#ifdef SPARK_TRACING                                                                    // compile with -DSPARK_TRACING to enable; otherwise the macros expand to nothing
+
+#include<memory>
+#include<vector>
+#include<string>
+#include<atomic>
+#include<mutex>
+#include<cstdint>
+
+namespace spk
+{
+    namespace system
+    {
+        class Tracer
+        {
+        public:
+            static Tracer* getInstance();
+            static uint64_t now();                                                      // nanoseconds since the tracer creation
+            void recordSpan(const char* name, const uint64_t begin, const uint64_t end);                   // CPU span of the calling thread; name must outlive the tracer (string literal)
+            void recordGPUSpan(const std::string& name, const uint64_t begin, const uint64_t end);         // span on the GPU track, in the CPU time base
+            void writeChromeTrace(const std::string& filename) const;                   // Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev)
+            void writePerfetto(const std::string& filename) const;                      // Perfetto protobuf trace
+            void clear();                                                               // must not run concurrently with recording threads
+        private:
+            struct Span
+            {
+                const char* name;
+                uint64_t begin;
+                uint64_t end;
+            };
+
+            struct ThreadBuffer                                                         // written only by its own thread
+            {
+                static const uint32_t capacity = 1 << 16;
+                std::unique_ptr<Span[]> spans;
+                std::atomic<uint32_t> count;
+                uint32_t threadIndex;
+            };
+
+            struct GPUSpan
+            {
+                std::string name;
+                uint64_t begin;
+                uint64_t end;
+            };
+
+            Tracer();
+            ThreadBuffer* getThreadBuffer();
+
+            static std::unique_ptr<Tracer> instance;
+            uint64_t startTime;
+            mutable std::mutex registryMutex;                                           // taken once per thread and per GPU frame, never per CPU span
+            std::vector<std::unique_ptr<ThreadBuffer> > threadBuffers;
+            std::vector<GPUSpan> gpuSpans;
+        };
+
+        class TraceScope
+        {
+        public:
+            TraceScope(const char* cName);
+            ~TraceScope();
+        private:
+            const char* name;
+            uint64_t begin;
+        };
+    }
+}
+
+#define SPARK_TRACE_CONCAT_IMPL(a, b) a##b
+#define SPARK_TRACE_CONCAT(a, b) SPARK_TRACE_CONCAT_IMPL(a, b)
+#define SPARK_TRACE_SCOPE(name) spk::system::TraceScope SPARK_TRACE_CONCAT(sparkTraceScope, __LINE__)(name)
+#define SPARK_TRACE_GPU_SPAN(name, begin, end) spk::system::Tracer::getInstance()->recordGPUSpan(name, begin, end)
+#define SPARK_TRACE_NOW() spk::system::Tracer::now()
+
+#else
+
+#define SPARK_TRACE_SCOPE(name)
+#define SPARK_TRACE_GPU_SPAN(name, begin, end)
+#define SPARK_TRACE_NOW() uint64_t(0)
+
+#endif
+
+#endif
\ No newline at end of file
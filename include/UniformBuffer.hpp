@@ -5,6 +5,9 @@
 #include"System.hpp"
 #include"Executives.hpp"
 #include"Buffer.hpp"
+#include"Capture.hpp"
+#include"UniformRing.hpp"
+#include<vector>
 
 namespace spk
 {
@@ -14,18 +17,24 @@ namespace spk
     public:
         UniformBuffer();
         UniformBuffer(const UniformBuffer& ub);
-        UniformBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding);
-        void create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding);
+        UniformBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding, const bool cDynamic = false);     // dynamic buffers live in the uniform ring, one copy per frame
+        void create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding, const bool cDynamic = false);
+        const bool isDynamic() const;
         UniformBuffer& operator=(const UniformBuffer& rBuffer);
         void resetSetIndex(const uint32_t newIndex);
         void resetBinding(const uint32_t newBinding);
        ~UniformBuffer();
     private:
         friend class ResourceSet;
+        friend class system::Capture;
         void bindMemory();
-        void update(const void* data);
+        void update(const void* cData);
         const vk::Buffer& getBuffer() const;
+        const vk::DeviceSize getOffset() const;                                         // of the descriptor range
         const vk::DeviceSize getSize() const;
+        const uint32_t getCopyCount() const;
+        const uint32_t getDynamicOffset(const uint32_t copy) const;
+        void flush(const uint32_t copy) const;                                          // copies the data into the copy read by a frame that is no longer in flight
         const uint32_t getSet() const;
         const uint32_t getBinding() const;
 
@@ -36,6 +45,11 @@ namespace spk
         uint32_t setIndex;
         uint32_t binding;
         bool transferred = false;
+        bool dynamic = false;
+        vk::DeviceSize ringOffset;                                                      // of the slice in every segment of the uniform ring
+        std::vector<char> data;                                                         // latest update of a dynamic buffer
+        mutable std::vector<uint64_t> copyVersions;
+        uint64_t version;
 
         void destroy();
     };
@@ -0,0 +1,43 @@
+#ifndef SPARK_UNIFORM_RING_HPP
+#define SPARK_UNIFORM_RING_HPP
+
+#include"SparkIncludeBase.hpp"
+#include"Buffer.hpp"
+#include<memory>
+#include<map>
+
+namespace spk
+{
+    namespace system
+    {
+        class UniformRing                                                               // backs the dynamic uniform buffers: one persistently mapped segment per frame copy
+        {
+        public:
+            static UniformRing* getInstance();
+            void setCapacity(const vk::DeviceSize cSegmentSize, const uint32_t cSegmentCount = 3);  // only while no dynamic uniform buffer exists
+            const vk::DeviceSize allocate(const vk::DeviceSize size);                   // offset of a slice owned in every segment
+            void free(const vk::DeviceSize offset, const vk::DeviceSize size);
+            const vk::Buffer& getBuffer() const;
+            char* getSegment(const uint32_t segment) const;
+            const uint32_t getSegmentOffset(const uint32_t segment) const;             // dynamic offset of the segment
+            const uint32_t getSegmentCount() const;
+            const vk::DeviceSize getSegmentSize() const;
+            const vk::DeviceSize getUsedSize() const;                                   // per segment
+            void destroy();
+        private:
+            UniformRing();
+            void create();
+
+            static std::unique_ptr<UniformRing> instance;
+            utils::Buffer buffer;                                                       // [segment][segmentSize]
+            char* mappedData;
+            vk::DeviceSize segmentSize;
+            uint32_t segmentCount;
+            vk::DeviceSize alignment;                                                   // minUniformBufferOffsetAlignment
+            vk::DeviceSize usedSize;
+            std::map<vk::DeviceSize, vk::DeviceSize> freeRanges;                        // [offset]: size, coalesced
+        };
+    }
+}
+
+#endif
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include"MemoryManager.hpp"
 #include"Executives.hpp"
 #include"Buffer.hpp"
+#include"Capture.hpp"
+#include"InstanceBuffer.hpp"
+#include"CullingSet.hpp"
+#include"MeshOptimizer.hpp"
 #include<vector>
 
 namespace spk
@@ -30,7 +34,18 @@ namespace spk
         vec4i,
         vec4u,
         vec4f,
-        vec4d
+        vec4d,
+
+        vec2half,                                                                       // packed and normalized formats, see Quantization.hpp for the CPU-side conversion
+        vec4half,
+        vec2snorm16,
+        vec4snorm16,
+        vec2unorm16,
+        vec4unorm16,
+        vec4snorm8,
+        vec4unorm8,
+        vec4snorm1010102,                                                               // A2B10G10R10, one 32-bit word
+        vec4unorm1010102
     };
 
     struct StructFieldInfo
@@ -40,11 +55,18 @@ namespace spk
         uint32_t offset;
     };
 
+    enum class InputRate
+    {
+        vertex,
+        instance
+    };
+
     struct BindingAlignmentInfo
     {
         uint32_t binding;
         uint32_t structSize;
         std::vector<StructFieldInfo> fields;
+        InputRate inputRate = InputRate::vertex;                                        // per-instance bindings advance once per instance
     };
 
     class VertexAlignmentInfo
@@ -55,7 +77,8 @@ namespace spk
         void create(const std::vector<BindingAlignmentInfo>& cBindingAlignmentInfos);
         VertexAlignmentInfo& operator=(const VertexAlignmentInfo& rInfo);
     private:
-        friend class Window;
+        friend class RenderTarget;
+        friend class system::Capture;
         const std::vector<BindingAlignmentInfo>& getAlignmentInfos() const;
         const uint32_t getIdentifier() const;
         static uint32_t count;
@@ -64,30 +87,53 @@ namespace spk
         std::vector<BindingAlignmentInfo> bindingAlignmentInfos;
     };
 
+    enum class IndexType
+    {
+        uint16,
+        uint32,
+        automatic                                                                       // uint32_t data, stored as uint16_t if every index of the first whole update fits
+    };
+
     class VertexBuffer
     {
     public:
         VertexBuffer();
         VertexBuffer(const VertexBuffer& vb);
-        VertexBuffer(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize = 0);
-        void create(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize = 0);
+        VertexBuffer(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize = 0, const IndexType cIndexType = IndexType::uint32);     // index buffer size in bytes of the data passed to updates
+        void create(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize = 0, const IndexType cIndexType = IndexType::uint32);
         void setInstancingOptions(const uint32_t count, const uint32_t first);
+        void setInstanceBuffer(const uint32_t binding, InstanceBuffer* instances);     // streams the binding from instances, whose count replaces the instancing count; nullptr detaches
         void updateVertexBuffer(const void * data, const uint32_t binding);           // TODO: make a staging transmission buffer a class field, make command buffer not one-time-submit buffer
         void updateIndexBuffer(const void * data);            // TODO: make a staging transmission buffer a class field, make command buffer not one-time-submit buffer
+        void updateVertexBuffer(const void * data, const uint32_t binding, const uint32_t offset, const uint32_t size);     // offset and size in bytes
+        void updateIndexBuffer(const void * data, const uint32_t offset, const uint32_t size);
+        const IndexType getIndexType() const;                                          // uint16 or uint32 once the type of an automatic buffer is resolved
+        void setLevelsOfDetail(const std::vector<utils::LevelOfDetail>& levels);       // coarser index lists of the same vertices, from the finest; empty removes them
+        void setBounds(const BoundingSphere& cBounds);                                 // in the space the view-projection matrix of the level selection transforms from
+        const uint32_t getLevelOfDetailCount() const;                                  // the index buffer itself is level 0
+        const uint32_t selectLevelOfDetail(const float* viewProjection, const float viewportHeight, const float pixelError = 1.0f) const;     // the coarsest level whose error projects to at most pixelError pixels
+        void setPushConstants(const void* data, const uint32_t size);                  // per-draw data for the push constant range of the resource set; size 0 removes it
         VertexBuffer& operator=(const VertexBuffer& rBuffer);
         ~VertexBuffer();
     private:
-        friend class Window;
+        friend class RenderTarget;
+        friend class system::Capture;
         const vk::Buffer& getVertexBuffer(const uint32_t binding) const;
-        const vk::Buffer& getIndexBuffer() const;
+        const vk::Buffer& getIndexBuffer(const uint32_t level = 0) const;
+        const vk::DeviceSize getIndexOffset(const uint32_t level) const;
         const uint32_t getVertexBufferSize(const uint32_t binding) const;
-        const uint32_t getIndexBufferSize() const;
+        const uint32_t getIndexCount(const uint32_t level = 0) const;                  // 0 until the index buffer of an automatic buffer is created
+        const vk::IndexType getVulkanIndexType() const;
         const vk::Fence* getIndexBufferFence() const;
         const vk::Fence* getVertexBufferFence(const uint32_t binding) const;
+        const uint64_t getLevelOfDetailVersion() const;                                // changes whenever the levels are replaced
+        const std::vector<char>& getPushConstants() const;
+        const uint64_t getPushConstantVersion() const;
         const vk::Semaphore* getIndexBufferSemaphore() const;
         const vk::Semaphore* getVertexBufferSemaphore(const uint32_t binding) const;
         const uint32_t getInstanceCount() const;
         const uint32_t getFirstInstance() const;
+        InstanceBuffer* getInstanceBuffer(const uint32_t binding) const;
 
         struct VertexBufferInfo
         {
@@ -111,11 +157,21 @@ namespace spk
             utils::Buffer buffer;
         };
 
+        struct LevelOfDetailRange
+        {
+            vk::DeviceSize offset;                                                      // in levelOfDetailBuffer
+            uint32_t indexCount;
+            float error;
+        };
+
         void bindMemory();
         //std::vector<VertexAlignmentInfo> alignmentInfos;
         std::vector<uint32_t> vertexBufferBindings;
         std::vector<uint32_t> vertexBufferSizes;
         uint32_t indexBufferSize;
+        IndexType indexType;
+        IndexType storedIndexType;
+        uint32_t indexCount;
         system::AllocatedMemoryData indexMemoryData;
         std::map<uint32_t, VertexBufferInfo> vertexBuffers;
 //        vk::Buffer indexBuffer;
@@ -125,10 +181,20 @@ namespace spk
         vk::CommandBuffer indexUpdateCommandBuffer;
         uint32_t instanceCount;
         uint32_t firstInstance;
+        std::map<uint32_t, InstanceBuffer*> instanceBuffers;
+        std::vector<LevelOfDetailRange> levelsOfDetail;                                 // levels 1 and up
+        utils::Buffer levelOfDetailBuffer;                                              // device-local, every level in the stored index type
+        BoundingSphere bounds;
+        uint64_t levelOfDetailVersion;
+        std::vector<char> pushConstants;
+        uint64_t pushConstantVersion;
         bool transferred = false;
+        bool memoryBound = false;
 
         void init();
-        void update(const void * data, bool vertex, const uint32_t binding = 0);            // TODO: make a staging transmission buffer a class field, make command buffer not one-time-submit buffer
+        void createIndexBuffer(const IndexType type);
+        void updateNarrowedIndices(const void * data, const uint32_t offset, const uint32_t size);
+        void update(const void * data, bool vertex, const uint32_t binding, const uint32_t offset, const uint32_t size);      // TODO: make a staging transmission buffer a class field, make command buffer not one-time-submit buffer
         void destroy();
     };
 
@@ -4,78 +4,39 @@
 #include"SparkIncludeBase.hpp"
 #include<memory>
 #include<string>
-#include<map>
-#include<tuple>
-#include"ResourceSet.hpp"
-#include"VertexBuffer.hpp"
-#include"ShaderSet.hpp"
+#include"RenderTarget.hpp"
 
 namespace spk
 {
-    enum class CullMode
-    {
-        Clockwise,
-        CounterClockwise,
-        None
-    };
-
-    struct DrawOptions
-    {
-        CullMode cullMode;
-    };
-
-    class Window
+    class Window : public RenderTarget
     {
     public:
         Window();
         void create(const uint32_t cWidth, const uint32_t cHeight, const std::string cTitle, const DrawOptions cOptions);
         Window(const uint32_t cWidth, const uint32_t cHeight, const std::string cTitle, const DrawOptions cOptions);
         void destroy();
-        void draw(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, const ShaderSet* shaders);
         ~Window();
         GLFWwindow* getGLFWWindow();
     private:
-        struct DrawComponents
-        {
-            vk::Pipeline pipeline;
-            const ResourceSet* resources;
-            const VertexAlignmentInfo* alignmentInfo;
-            const ShaderSet* shaders;
-        };
         GLFWwindow* window;
         vk::SurfaceKHR surface;
+        vk::PresentModeKHR presentMode;
         std::pair<uint32_t, const vk::Queue*> presentQueue;
         vk::SwapchainKHR swapchain;
         std::vector<vk::Image> swapchainImages;
         std::vector<vk::ImageView> swapchainImageViews;
-        utils::Image depthMap;
-        utils::ImageView depthMapView;
-        vk::Format depthMapFormat;
-        vk::RenderPass renderPass;
         vk::SurfaceFormatKHR surfaceFormat;
-        std::vector<vk::Framebuffer> framebuffers;
-        std::vector<vk::CommandBuffer> frameCommandBuffers;
-        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, DrawComponents> drawComponents;
-        std::vector<vk::CommandBuffer> presentCommandBuffers;
-        std::tuple<uint32_t, uint32_t, uint32_t> currentPipeline;
-        vk::Fence safeToRenderFence;
-        vk::Fence safeToPresentFence;
-        vk::Semaphore depthMapAvailableSemaphore;
-        vk::Semaphore safeToRenderSemaphore;
-        vk::Semaphore safeToPresentSemaphore;
-
-        uint32_t width;
-        uint32_t height;
-        DrawOptions options;
+        std::vector<vk::Semaphore> imageAvailableSemaphores;                            // per frame in flight
+        std::vector<vk::Semaphore> renderFinishedSemaphores;
 
+        vk::PresentModeKHR pickPresentMode() const;
+        uint32_t pickImageCount(const vk::SurfaceCapabilitiesKHR& capabilities) const;
         void createSwapchain();
-        void createDepthMap();
-        void createRenderPass();
-        void createFramebuffers();
-        std::pair<vk::VertexInputBindingDescription, std::vector<vk::VertexInputAttributeDescription> > createPipelineVertexInputStateBase(const BindingAlignmentInfo& vertexAlignmentInfo);
-        void createPipeline(vk::Pipeline& pipeline, const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos, const std::vector<BindingAlignmentInfo>& vertexAlignmentInfos, const vk::PipelineLayout& layout);
-        void createCommandBuffers();
-        void initCommandBuffers(DrawComponents& drawComponents, const std::vector<VertexBuffer*>& vertexBuffers);
+        void createSemaphores();
+        vk::Semaphore acquireImage(const uint32_t frame, uint32_t& imageIndex) override;
+        vk::Semaphore getRenderFinishedSemaphore(const uint32_t frame) const override;
+        void present(const uint32_t frame, const uint32_t imageIndex) override;
+        const vk::Image& getColorImage(const uint32_t imageIndex) const override;
     };
 
 }
@@ -1,4 +1,7 @@
 #include"../include/Buffer.hpp"
+#include"../include/GPUProfiler.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
 
 namespace spk
 {
@@ -10,11 +13,11 @@ namespace spk
             memoryData.offset = ~0;
         }
 
-        Buffer::Buffer(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation)
+        Buffer::Buffer(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation, const bool cShared)
         {
             memoryData.index = ~0;
             memoryData.offset = ~0;
-            create(cSize, cUsage, cDeviceLocal, cInstantAllocation);
+            create(cSize, cUsage, cDeviceLocal, cInstantAllocation, cShared);
         }
 
         Buffer::Buffer(const Buffer& buf)
@@ -22,7 +25,7 @@ namespace spk
             destroy();
             if(buf.buffer)
             {
-                create(buf.size, buf.usage, buf.deviceLocal, buf.instantAlloc);
+                create(buf.size, buf.usage, buf.deviceLocal, buf.instantAlloc, buf.shared);
             }
         }
 
@@ -31,27 +34,36 @@ namespace spk
             destroy();
             if(buf.buffer)
             {
-                create(buf.size, buf.usage, buf.deviceLocal, buf.instantAlloc);
+                create(buf.size, buf.usage, buf.deviceLocal, buf.instantAlloc, buf.shared);
             }
             return *this;
         }
 
-        void Buffer::create(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation)
+        void Buffer::create(const vk::DeviceSize cSize, const vk::BufferUsageFlags cUsage, const bool cDeviceLocal, const bool cInstantAllocation, const bool cShared)
         {
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             size = cSize;
             usage = cUsage;
             deviceLocal = cDeviceLocal;
             instantAlloc = cInstantAllocation;
+            shared = cShared;
 
-            const auto graphicsFamIndex = system::Executives::getInstance()->getGraphicsQueueFamilyIndex();
+            const uint32_t familyIndices[] = {system::Executives::getInstance()->getGraphicsQueueFamilyIndex(), system::Executives::getInstance()->getComputeQueueFamilyIndex()};
 
             vk::BufferCreateInfo info;
             info.setSize(size);
             info.setUsage(usage);
-            info.setSharingMode(vk::SharingMode::eExclusive);
-            info.setQueueFamilyIndexCount(1);
-            info.setPQueueFamilyIndices(&graphicsFamIndex);
+            if(shared && familyIndices[0] != familyIndices[1])
+            {
+                info.setSharingMode(vk::SharingMode::eConcurrent);                         // no ownership transfers between the graphics and the compute family
+                info.setQueueFamilyIndexCount(2);
+            }
+            else
+            {
+                info.setSharingMode(vk::SharingMode::eExclusive);
+                info.setQueueFamilyIndexCount(1);
+            }
+            info.setPQueueFamilyIndices(familyIndices);
 
             if(logicalDevice.createBuffer(&info, nullptr, &buffer) != vk::Result::eSuccess) throw std::runtime_error("Failed to create buffer!\n");
 
@@ -83,13 +95,43 @@ namespace spk
 
         void Buffer::updateCPUAccessible(const void* data)
         {
+            SPARK_TRACE_SCOPE("Buffer::updateCPUAccessible");
             if(deviceLocal) throw std::runtime_error("Trying to update device local buffer as CPU-accessible.\n");
+            if(mappedMemory != nullptr)
+            {
+                memcpy(mappedMemory, data, size);
+                system::Statistics::getInstance()->countUpload(size);
+                return;
+            }
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             const vk::DeviceMemory& memory = system::MemoryManager::getInstance()->getMemory(memoryData.index);
-            void* mappedMemory;
-            if(logicalDevice.mapMemory(memory, memoryData.offset, size, vk::MemoryMapFlags(), &mappedMemory) != vk::Result::eSuccess) throw std::runtime_error("Failed to map memory!\n");
-            memcpy(mappedMemory, data, size);
+            void* mappedData;
+            if(logicalDevice.mapMemory(memory, memoryData.offset, size, vk::MemoryMapFlags(), &mappedData) != vk::Result::eSuccess) throw std::runtime_error("Failed to map memory!\n");
+            memcpy(mappedData, data, size);
             logicalDevice.unmapMemory(memory);
+            system::Statistics::getInstance()->countUpload(size);
+        }
+
+        void* Buffer::map()
+        {
+            if(deviceLocal) throw std::runtime_error("Trying to map device local buffer.\n");
+            if(!instantAlloc) throw std::runtime_error("Trying to map lazily allocated buffer.\n");
+            if(mappedMemory != nullptr) return mappedMemory;
+            const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+            const vk::DeviceMemory& memory = system::MemoryManager::getInstance()->getMemory(memoryData.index);
+            if(logicalDevice.mapMemory(memory, memoryData.offset, size, vk::MemoryMapFlags(), &mappedMemory) != vk::Result::eSuccess) throw std::runtime_error("Failed to map memory!\n");
+            return mappedMemory;
+        }
+
+        void Buffer::unmap()
+        {
+            if(mappedMemory != nullptr)
+            {
+                const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+                const vk::DeviceMemory& memory = system::MemoryManager::getInstance()->getMemory(memoryData.index);
+                logicalDevice.unmapMemory(memory);
+                mappedMemory = nullptr;
+            }
         }
 
         void Buffer::updateDeviceLocal(vk::CommandBuffer& updateBuffer,
@@ -100,20 +142,24 @@ namespace spk
             const vk::Fence& waitFence,
             const vk::Fence& signalFence,
             const vk::PipelineStageFlags dstStageFlags,
-            bool oneTimeSubmit)
+            bool oneTimeSubmit,
+            const vk::DeviceSize dstOffset,
+            const vk::DeviceSize copySize)
         {
+            SPARK_TRACE_SCOPE("Buffer::updateDeviceLocal");
             if(!deviceLocal) throw std::runtime_error("Trying to update CPU-accessible buffer as device local.\n");
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             const vk::Queue& graphicsQueue = system::Executives::getInstance()->getGraphicsQueue();
 
             vk::BufferCopy copyInfo;
-            copyInfo.setDstOffset(0);
+            copyInfo.setDstOffset(dstOffset);
             copyInfo.setSrcOffset(srcOffset);
-            copyInfo.setSize(size);
+            copyInfo.setSize(copySize == 0 ? size : copySize);
+            if(dstOffset + copyInfo.size > size) throw std::runtime_error("Buffer update is out of range!\n");
 
             if(waitFence)
             {
-                if(logicalDevice.waitForFences(1, &waitFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fence!\n");
+                if(system::Statistics::getInstance()->waitForFences(1, &waitFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fence!\n");
                 if(logicalDevice.resetFences(1, &waitFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fence!\n");
             }
 
@@ -121,7 +167,9 @@ namespace spk
             if(oneTimeSubmit) beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
 
             if(updateBuffer.begin(&beginInfo) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+            const uint32_t upload = system::GPUProfiler::getInstance()->beginUpload(updateBuffer, "buffer upload");
             updateBuffer.copyBuffer(copyBuffer, buffer, 1, &copyInfo);
+            system::GPUProfiler::getInstance()->endUpload(updateBuffer, upload);
             updateBuffer.end();
 
             vk::SubmitInfo submit;
@@ -157,10 +205,12 @@ namespace spk
             {
                 if(graphicsQueue.submit(1, &submit, vk::Fence()) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
             }
+            system::Statistics::getInstance()->countSubmit();
         }
 
         void Buffer::destroy()
         {
+            unmap();
             if(buffer)
             {
                 const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
@@ -0,0 +1,527 @@
+#include"../include/Capture.hpp"
+#include"../include/RenderTarget.hpp"
+#include"../include/ResourceSet.hpp"
+#include"../include/ShaderSet.hpp"
+#include"../include/VertexBuffer.hpp"
+#include"../include/InstanceBuffer.hpp"
+#include<cstring>
+
+namespace spk
+{
+    namespace
+    {
+        const char captureMagic[] = {'S', 'P', 'K', 'C', 'A', 'P'};
+        const uint64_t captureVersion = 10;
+        const size_t captureFlushSize = 1 << 20;
+    }
+
+    namespace system
+    {
+        std::unique_ptr<Capture> Capture::instance = nullptr;
+        bool Capture::active = false;
+
+        void beginCapture(const std::string& filename)
+        {
+            Capture* capture = Capture::getInstance();
+            if(Capture::active) capture->end();
+            capture->begin(filename);
+        }
+
+        void endCapture()
+        {
+            if(Capture::active) Capture::getInstance()->end();
+        }
+
+        Capture::Capture()
+        {
+            nextIdentifier = 0;
+        }
+
+        Capture* Capture::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new Capture());
+            }
+            return instance.get();
+        }
+
+        bool Capture::isActive()
+        {
+            return active;
+        }
+
+        void Capture::begin(const std::string& filename)
+        {
+            file.open(filename, std::ios::binary | std::ios::trunc);
+            if(!file.is_open()) throw std::runtime_error("Failed to open capture file!\n");
+            buffer.clear();
+            buffer.reserve(captureFlushSize * 2);
+            writeBytes(captureMagic, sizeof(captureMagic));
+            writeUInt(captureVersion);
+            startTime = std::chrono::steady_clock::now();
+            nextIdentifier = 0;
+            active = true;
+        }
+
+        void Capture::end()
+        {
+            writeOp(CaptureOp::End);
+            flush();
+            file.close();
+            targetIdentifiers.clear();
+            vertexBufferIdentifiers.clear();
+            instanceBufferIdentifiers.clear();
+            recordedResourceSets.clear();
+            recordedAlignments.clear();
+            recordedShaderSets.clear();
+            active = false;
+        }
+
+        void Capture::writeOp(const CaptureOp op)
+        {
+            buffer.push_back(static_cast<char>(op));
+        }
+
+        void Capture::writeUInt(uint64_t value)
+        {
+            while(value >= 0x80)
+            {
+                buffer.push_back(char((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(char(value));
+        }
+
+        void Capture::writeBytes(const void* data, const size_t size)
+        {
+            const char* bytes = static_cast<const char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+            if(buffer.size() > captureFlushSize) flush();
+        }
+
+        void Capture::writeTexture(const Texture& texture)
+        {
+            writeUInt(texture.imageInfo.extent.width);
+            writeUInt(texture.imageInfo.extent.height);
+            writeUInt(static_cast<uint32_t>(texture.imageFormat));
+            writeUInt(texture.setIndex);
+            writeUInt(texture.binding);
+            const SamplerInfo& sampler = texture.samplerInfo;
+            writeUInt(static_cast<uint32_t>(sampler.magFilter));
+            writeUInt(static_cast<uint32_t>(sampler.minFilter));
+            writeUInt(static_cast<uint32_t>(sampler.mipmapFilter));
+            writeUInt(static_cast<uint32_t>(sampler.addressModeU));
+            writeUInt(static_cast<uint32_t>(sampler.addressModeV));
+            writeUInt(static_cast<uint32_t>(sampler.addressModeW));
+            writeBytes(&sampler.maxAnisotropy, sizeof(float));
+            writeBytes(&sampler.minLod, sizeof(float));
+            writeBytes(&sampler.maxLod, sizeof(float));
+        }
+
+        void Capture::flush()
+        {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+
+        const uint32_t Capture::assignIdentifier(std::map<const void*, uint32_t>& identifiers, const void* object)
+        {
+            identifiers[object] = nextIdentifier;
+            return nextIdentifier++;
+        }
+
+        void Capture::recordTarget(const RenderTarget* target)
+        {
+            writeOp(CaptureOp::CreateTarget);
+            writeUInt(assignIdentifier(targetIdentifiers, target));
+            writeUInt(target->width);
+            writeUInt(target->height);
+            writeUInt(static_cast<uint32_t>(target->options.cullMode));
+            writeUInt(static_cast<uint32_t>(target->options.presentMode));
+            writeUInt(target->options.minImageCount);
+            writeUInt(target->options.maxFramesInFlight);
+            writeUInt(target->options.storeDepth);
+            writeUInt(target->options.gpuTimings);
+        }
+
+        void Capture::recordTargetDestroy(const RenderTarget* target)
+        {
+            auto found = targetIdentifiers.find(target);
+            if(found == targetIdentifiers.end()) return;
+            writeOp(CaptureOp::DestroyTarget);
+            writeUInt(found->second);
+            targetIdentifiers.erase(found);
+        }
+
+        void Capture::recordResourceSet(const ResourceSet& set)
+        {
+            writeOp(CaptureOp::CreateResourceSet);
+            writeUInt(set.identifier);
+            writeUInt(set.textures.size());
+            for(const auto& texture : set.textures)
+            {
+                writeTexture(texture);
+            }
+            writeUInt(set.uniformBuffers.size());
+            for(const auto& uniformBuffer : set.uniformBuffers)
+            {
+                writeUInt(uniformBuffer.size);
+                writeUInt(uniformBuffer.setIndex);
+                writeUInt(uniformBuffer.binding);
+                writeUInt(uniformBuffer.dynamic);
+            }
+            writeUInt(set.storageBuffers.size());
+            for(const auto& storageBuffer : set.storageBuffers)
+            {
+                writeUInt(storageBuffer.size);
+                writeUInt(storageBuffer.setIndex);
+                writeUInt(storageBuffer.binding);
+            }
+            writeUInt(set.bindlessSet);
+            writeUInt(set.bindlessCapacity);
+            recordedResourceSets.insert(set.identifier);
+            if(set.pushConstantSize != 0) recordPushConstantSize(set);
+        }
+
+        void Capture::recordResourceSetUpdate(const ResourceSet& set, const uint32_t descriptorSet, const uint32_t binding, const void* data)
+        {
+            if(recordedResourceSets.count(set.identifier) == 0) recordResourceSet(set);
+            const std::pair<uint32_t, ResourceSet::ResourceType>& location = set.setContainmentData.at(descriptorSet).bindings.at(binding);
+            size_t size = 0;
+            if(location.second == ResourceSet::ResourceType::Texture)
+            {
+                const Texture& texture = set.textures[location.first];
+                size = texture.imageInfo.extent.width * texture.imageInfo.extent.height * texture.imageInfo.channelCount;
+            }
+            else if(data != nullptr) size = location.second == ResourceSet::ResourceType::StorageBuffer ? set.storageBuffers[location.first].size : set.uniformBuffers[location.first].size;
+            writeOp(CaptureOp::UpdateResourceSet);
+            writeUInt(set.identifier);
+            writeUInt(descriptorSet);
+            writeUInt(binding);
+            writeUInt(size);
+            writeBytes(data, size);
+        }
+
+        void Capture::recordResourceSetDestroy(const ResourceSet& set)
+        {
+            if(recordedResourceSets.erase(set.identifier) == 0) return;
+            writeOp(CaptureOp::DestroyResourceSet);
+            writeUInt(set.identifier);
+        }
+
+        void Capture::recordPushConstantSize(const ResourceSet& set)
+        {
+            if(recordedResourceSets.count(set.identifier) == 0)
+            {
+                recordResourceSet(set);                                                 // records the size as well
+                return;
+            }
+            writeOp(CaptureOp::SetPushConstantSize);
+            writeUInt(set.identifier);
+            writeUInt(set.pushConstantSize);
+        }
+
+        void Capture::recordTextureAdd(const ResourceSet& set, const Texture& texture)
+        {
+            if(recordedResourceSets.count(set.identifier) == 0)
+            {
+                recordResourceSet(set);                                                 // the texture is already among those of the set
+                return;
+            }
+            writeOp(CaptureOp::AddTexture);
+            writeUInt(set.identifier);
+            writeTexture(texture);
+        }
+
+        void Capture::recordVertexAlignment(const VertexAlignmentInfo& alignment)
+        {
+            writeOp(CaptureOp::CreateVertexAlignment);
+            writeUInt(alignment.identifier);
+            writeUInt(alignment.bindingAlignmentInfos.size());
+            for(const auto& binding : alignment.bindingAlignmentInfos)
+            {
+                writeUInt(binding.binding);
+                writeUInt(binding.structSize);
+                writeUInt(static_cast<uint32_t>(binding.inputRate));
+                writeUInt(binding.fields.size());
+                for(const auto& field : binding.fields)
+                {
+                    writeUInt(field.location);
+                    writeUInt(static_cast<uint32_t>(field.format));
+                    writeUInt(field.offset);
+                }
+            }
+            recordedAlignments.insert(alignment.identifier);
+        }
+
+        void Capture::recordShaderSet(const ShaderSet& shaders)
+        {
+            writeOp(CaptureOp::CreateShaderSet);
+            writeUInt(shaders.identifier);
+            writeUInt(shaders.infos.size());
+            for(const auto& info : shaders.infos)
+            {
+                std::vector<char> code = shaders.getCode(info.filename);                // the SPIR-V is embedded so that the capture replays without the original files
+                writeUInt(static_cast<uint32_t>(info.type));
+                writeUInt(code.size());
+                writeBytes(code.data(), code.size());
+            }
+            recordedShaderSets.insert(shaders.identifier);
+        }
+
+        void Capture::recordShaderSetDestroy(const ShaderSet& shaders)
+        {
+            if(recordedShaderSets.erase(shaders.identifier) == 0) return;
+            writeOp(CaptureOp::DestroyShaderSet);
+            writeUInt(shaders.identifier);
+        }
+
+        void Capture::recordVertexBuffer(const VertexBuffer* buffer)
+        {
+            writeOp(CaptureOp::CreateVertexBuffer);
+            writeUInt(assignIdentifier(vertexBufferIdentifiers, buffer));
+            writeUInt(buffer->vertexBufferBindings.size());
+            for(uint32_t i = 0; i < buffer->vertexBufferBindings.size(); ++i)
+            {
+                writeUInt(buffer->vertexBufferBindings[i]);
+                writeUInt(buffer->vertexBufferSizes[i]);
+            }
+            writeUInt(buffer->indexBufferSize);
+            writeUInt(static_cast<uint64_t>(buffer->indexType));
+        }
+
+        void Capture::recordVertexBufferUpdate(const VertexBuffer* buffer, const void* data, const bool vertex, const uint32_t binding, const uint32_t offset, const uint32_t size)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            if(offset != 0 || size != (vertex ? buffer->vertexBuffers.at(binding).size : buffer->indexBufferSize))
+            {
+                writeOp(CaptureOp::UpdateBufferRange);
+                writeUInt(vertexBufferIdentifiers[buffer]);
+                writeUInt(vertex);
+                writeUInt(binding);
+                writeUInt(offset);
+                writeUInt(size);
+                writeBytes(data, size);
+            }
+            else if(vertex)
+            {
+                const uint32_t size = buffer->vertexBuffers.at(binding).size;
+                writeOp(CaptureOp::UpdateVertexBuffer);
+                writeUInt(vertexBufferIdentifiers[buffer]);
+                writeUInt(binding);
+                writeUInt(size);
+                writeBytes(data, size);
+            }
+            else
+            {
+                writeOp(CaptureOp::UpdateIndexBuffer);
+                writeUInt(vertexBufferIdentifiers[buffer]);
+                writeUInt(buffer->indexBufferSize);
+                writeBytes(data, buffer->indexBufferSize);
+            }
+        }
+
+        void Capture::recordInstancing(const VertexBuffer* buffer)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            writeOp(CaptureOp::SetInstancing);
+            writeUInt(vertexBufferIdentifiers[buffer]);
+            writeUInt(buffer->instanceCount);
+            writeUInt(buffer->firstInstance);
+        }
+
+        void Capture::recordVertexBufferDestroy(const VertexBuffer* buffer)
+        {
+            auto found = vertexBufferIdentifiers.find(buffer);
+            if(found == vertexBufferIdentifiers.end()) return;
+            writeOp(CaptureOp::DestroyVertexBuffer);
+            writeUInt(found->second);
+            vertexBufferIdentifiers.erase(found);
+        }
+
+        void Capture::recordInstanceBuffer(const InstanceBuffer* instances)
+        {
+            writeOp(CaptureOp::CreateInstanceBuffer);
+            writeUInt(assignIdentifier(instanceBufferIdentifiers, instances));
+            writeUInt(instances->instanceSize);
+            writeUInt(instances->capacity);
+            writeUInt(instances->copies);
+        }
+
+        void Capture::recordInstances(const InstanceBuffer* instances, const uint32_t first, const uint32_t count, const void* data)
+        {
+            if(instanceBufferIdentifiers.count(instances) == 0) recordInstanceBuffer(instances);
+            writeOp(CaptureOp::UpdateInstances);
+            writeUInt(instanceBufferIdentifiers[instances]);
+            writeUInt(first);
+            writeUInt(count);
+            writeBytes(data, size_t(count) * instances->instanceSize);
+        }
+
+        void Capture::recordInstanceCount(const InstanceBuffer* instances)
+        {
+            if(instanceBufferIdentifiers.count(instances) == 0) recordInstanceBuffer(instances);
+            writeOp(CaptureOp::SetInstanceCount);
+            writeUInt(instanceBufferIdentifiers[instances]);
+            writeUInt(instances->instanceCount);
+        }
+
+        void Capture::recordInstanceBufferDestroy(const InstanceBuffer* instances)
+        {
+            auto found = instanceBufferIdentifiers.find(instances);
+            if(found == instanceBufferIdentifiers.end()) return;
+            writeOp(CaptureOp::DestroyInstanceBuffer);
+            writeUInt(found->second);
+            instanceBufferIdentifiers.erase(found);
+        }
+
+        void Capture::recordInstanceBinding(const VertexBuffer* buffer, const uint32_t binding, const InstanceBuffer* instances)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            if(instances != nullptr && instanceBufferIdentifiers.count(instances) == 0) recordInstanceBuffer(instances);
+            writeOp(CaptureOp::SetInstanceBuffer);
+            writeUInt(vertexBufferIdentifiers[buffer]);
+            writeUInt(binding);
+            writeUInt((instances == nullptr) ? 0 : instanceBufferIdentifiers[instances] + 1);        // identifiers start at 0
+        }
+
+        void Capture::recordLevelsOfDetail(const VertexBuffer* buffer, const std::vector<utils::LevelOfDetail>& levels)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            writeOp(CaptureOp::SetLevelsOfDetail);
+            writeUInt(vertexBufferIdentifiers[buffer]);
+            writeUInt(levels.size());
+            for(const auto& level : levels)
+            {
+                writeBytes(&level.error, sizeof(float));
+                writeUInt(level.indices.size());
+                writeBytes(level.indices.data(), level.indices.size() * sizeof(uint32_t));
+            }
+        }
+
+        void Capture::recordBounds(const VertexBuffer* buffer)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            writeOp(CaptureOp::SetBounds);
+            writeUInt(vertexBufferIdentifiers[buffer]);
+            writeBytes(buffer->bounds.center, 3 * sizeof(float));
+            writeBytes(&buffer->bounds.radius, sizeof(float));
+        }
+
+        void Capture::recordPushConstants(const VertexBuffer* buffer)
+        {
+            if(vertexBufferIdentifiers.count(buffer) == 0) recordVertexBuffer(buffer);
+            writeOp(CaptureOp::SetPushConstants);
+            writeUInt(vertexBufferIdentifiers[buffer]);
+            writeUInt(buffer->pushConstants.size());
+            writeBytes(buffer->pushConstants.data(), buffer->pushConstants.size());
+        }
+
+        void Capture::recordLevelOfDetailView(const RenderTarget* target)
+        {
+            if(targetIdentifiers.count(target) == 0) recordTarget(target);
+            writeOp(CaptureOp::SetLevelOfDetailView);
+            writeUInt(targetIdentifiers[target]);
+            writeUInt(target->levelOfDetailViewSet);
+            if(!target->levelOfDetailViewSet) return;
+            writeBytes(&target->levelOfDetailPixelError, sizeof(float));
+            writeBytes(target->levelOfDetailView, 16 * sizeof(float));
+        }
+
+        void Capture::recordDraw(const RenderTarget* target, const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, const ShaderSet* shaders)
+        {
+            // objects created before the capture started are recorded on first use, without their earlier contents
+            if(targetIdentifiers.count(target) == 0) recordTarget(target);
+            if(recordedResourceSets.count(resources->identifier) == 0) recordResourceSet(*resources);
+            if(recordedAlignments.count(alignmentInfo->identifier) == 0) recordVertexAlignment(*alignmentInfo);
+            if(recordedShaderSets.count(shaders->identifier) == 0) recordShaderSet(*shaders);
+            for(const auto buffer : vertexBuffers)
+            {
+                if(vertexBufferIdentifiers.count(buffer) == 0)
+                {
+                    recordVertexBuffer(buffer);
+                    if(buffer->instanceCount != 1 || buffer->firstInstance != 0) recordInstancing(buffer);
+                }
+            }
+
+            writeOp(CaptureOp::Draw);
+            writeUInt(targetIdentifiers[target]);
+            writeUInt(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+            writeUInt(resources->identifier);
+            writeUInt(alignmentInfo->identifier);
+            writeUInt(shaders->identifier);
+            writeUInt(vertexBuffers.size());
+            for(const auto buffer : vertexBuffers)
+            {
+                writeUInt(vertexBufferIdentifiers[buffer]);
+            }
+        }
+
+        void Capture::destroy()
+        {
+            if(active) end();
+        }
+    }
+
+    namespace utils
+    {
+        CaptureReader::CaptureReader()
+        {
+            position = 0;
+        }
+
+        CaptureReader::CaptureReader(const std::string& filename)
+        {
+            open(filename);
+        }
+
+        void CaptureReader::open(const std::string& filename)
+        {
+            std::ifstream file(filename, std::ios::ate | std::ios::binary);
+            if(!file.is_open()) throw std::runtime_error("Failed to open capture file!\n");
+            data.resize(file.tellg());
+            file.seekg(0);
+            file.read(data.data(), data.size());
+            rewind();
+        }
+
+        void CaptureReader::rewind()
+        {
+            position = 0;
+            if(data.size() < sizeof(captureMagic) || std::memcmp(data.data(), captureMagic, sizeof(captureMagic)) != 0) throw std::runtime_error("Not a Spark capture file!\n");
+            position = sizeof(captureMagic);
+            if(readUInt() != captureVersion) throw std::runtime_error("Unsupported capture version!\n");
+        }
+
+        CaptureOp CaptureReader::readOp()
+        {
+            if(position >= data.size()) return CaptureOp::End;                          // a capture that was never ended is replayed up to its last flush
+            return static_cast<CaptureOp>(data[position++]);
+        }
+
+        uint64_t CaptureReader::readUInt()
+        {
+            uint64_t value = 0;
+            uint32_t shift = 0;
+            while(true)
+            {
+                if(position >= data.size()) throw std::runtime_error("Truncated capture file!\n");
+                const uint8_t byte = static_cast<uint8_t>(data[position++]);
+                value |= uint64_t(byte & 0x7F) << shift;
+                if((byte & 0x80) == 0) return value;
+                shift += 7;
+            }
+        }
+
+        const char* CaptureReader::readBytes(const size_t size)
+        {
+            if(position + size > data.size()) throw std::runtime_error("Truncated capture file!\n");
+            const char* bytes = data.data() + position;
+            position += size;
+            return bytes;
+        }
+    }
+}
\ No newline at end of file
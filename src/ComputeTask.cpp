@@ -0,0 +1,184 @@
+#include"../include/ComputeTask.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
+
+namespace spk
+{
+    ComputeTask::ComputeTask(): resources(nullptr), shaders(nullptr), async(false), submitted(false), recordedGroups{0, 0, 0}{}
+
+    ComputeTask::ComputeTask(const ResourceSet* cResources, const ShaderSet* cShaders, const bool cAsync): resources(nullptr), shaders(nullptr), async(false), submitted(false), recordedGroups{0, 0, 0}
+    {
+        create(cResources, cShaders, cAsync);
+    }
+
+    void ComputeTask::create(const ResourceSet* cResources, const ShaderSet* cShaders, const bool cAsync)
+    {
+        destroy();
+        if(cResources->getCopyCount() != ~uint32_t(0)) throw std::runtime_error("Compute tasks don't support dynamic uniform buffers!\n");     // dispatches aren't tied to a frame copy
+        resources = cResources;
+        shaders = cShaders;
+        system::Executives* executives = system::Executives::getInstance();
+        async = cAsync && executives->hasAsyncCompute();
+        submitted = false;
+        recordedGroups[0] = recordedGroups[1] = recordedGroups[2] = 0;
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+
+        createPipeline();
+
+        vk::CommandBufferAllocateInfo commandInfo;
+        commandInfo.setCommandBufferCount(1);
+        commandInfo.setCommandPool(async ? executives->getComputePool() : executives->getPool());
+        commandInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        if(logicalDevice.allocateCommandBuffers(&commandInfo, &commandBuffer) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate command buffer!\n");
+
+        vk::FenceCreateInfo fenceInfo;
+        if(logicalDevice.createFence(&fenceInfo, nullptr, &finishedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
+        if(async)
+        {
+            vk::SemaphoreCreateInfo semaphoreInfo;
+            if(logicalDevice.createSemaphore(&semaphoreInfo, nullptr, &finishedSemaphore) != vk::Result::eSuccess) throw std::runtime_error("Failed to create semaphore!\n");
+        }
+    }
+
+    void ComputeTask::createPipeline()
+    {
+        const vk::PipelineShaderStageCreateInfo* computeStage = nullptr;
+        for(const auto& stage : shaders->getShaderStages())
+        {
+            if(stage.stage == vk::ShaderStageFlagBits::eCompute) computeStage = &stage;
+        }
+        if(computeStage == nullptr) throw std::runtime_error("Shader set has no compute shader!\n");
+
+        vk::ComputePipelineCreateInfo pipelineInfo;
+        pipelineInfo.setStage(*computeStage);
+        pipelineInfo.setLayout(resources->getPipelineLayout());
+        pipelineInfo.setBasePipelineHandle(vk::Pipeline());
+        pipelineInfo.setBasePipelineIndex(-1);
+
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        if(logicalDevice.createComputePipelines(system::System::getInstance()->getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != vk::Result::eSuccess) throw std::runtime_error("Failed to create compute pipeline!\n");
+    }
+
+    void ComputeTask::record(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ)
+    {
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.setFlags(vk::CommandBufferUsageFlags());
+        beginInfo.setPInheritanceInfo(nullptr);
+        if(commandBuffer.begin(&beginInfo) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+
+        const vk::PipelineStageFlags graphicsReadStages = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput 
+            | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+        if(!async)
+        {
+            commandBuffer.pipelineBarrier(graphicsReadStages, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 0, nullptr);     // earlier frames stop reading before the shader overwrites
+        }
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, resources->getPipelineLayout(), 0, resources->getDescriptorSets().size(), resources->getDescriptorSets().data(), 0, nullptr);
+        commandBuffer.dispatch(groupCountX, groupCountY, groupCountZ);
+
+        vk::MemoryBarrier barrier;
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        if(async)                                                                       // the semaphore makes the results visible to the graphics queue
+        {
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+        else
+        {
+            barrier.setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead 
+                | vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, graphicsReadStages | vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        if(commandBuffer.end() != vk::Result::eSuccess) throw std::runtime_error("Failed to record command buffer!\n");
+        recordedGroups[0] = groupCountX;
+        recordedGroups[1] = groupCountY;
+        recordedGroups[2] = groupCountZ;
+        system::Statistics::getInstance()->countCommandBufferRecord();
+    }
+
+    void ComputeTask::dispatch(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ, const RenderTarget* cConsumer)
+    {
+        SPARK_TRACE_SCOPE("ComputeTask::dispatch");
+        if(resources == nullptr) throw std::runtime_error("Compute task is not created!\n");
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        system::Executives* executives = system::Executives::getInstance();
+
+        wait();
+        if(logicalDevice.resetFences(1, &finishedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
+        if(recordedGroups[0] != groupCountX || recordedGroups[1] != groupCountY || recordedGroups[2] != groupCountZ)
+        {
+            commandBuffer.reset(vk::CommandBufferResetFlags());
+            record(groupCountX, groupCountY, groupCountZ);
+        }
+
+        vk::SubmitInfo submitInfo;
+        submitInfo.setCommandBufferCount(1);
+        submitInfo.setPCommandBuffers(&commandBuffer);
+        submitInfo.setWaitSemaphoreCount(0);
+        submitInfo.setPWaitSemaphores(nullptr);
+        submitInfo.setSignalSemaphoreCount(0);
+        submitInfo.setPSignalSemaphores(nullptr);
+        const vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eComputeShader;
+        if(async)
+        {
+            if(executives->removeGraphicsWait(finishedSemaphore))                       // no frame consumed the previous signal, so this submit does
+            {
+                submitInfo.setWaitSemaphoreCount(1);
+                submitInfo.setPWaitSemaphores(&finishedSemaphore);
+                submitInfo.setPWaitDstStageMask(&waitStage);
+            }
+            executives->waitForFrameSubmissions();                                      // frames in flight may still read the storage buffers or wait on the previous signal
+            if(cConsumer != nullptr)                                                    // without a consumer the results are only read after wait()
+            {
+                submitInfo.setSignalSemaphoreCount(1);
+                submitInfo.setPSignalSemaphores(&finishedSemaphore);
+            }
+        }
+
+        const vk::Queue& queue = async ? executives->getComputeQueue() : executives->getGraphicsQueue();
+        if(queue.submit(1, &submitInfo, finishedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
+        system::Statistics::getInstance()->countSubmit();
+        submitted = true;
+        if(async && cConsumer != nullptr)
+        {
+            executives->addGraphicsWait(finishedSemaphore, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput 
+                | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader, cConsumer);
+        }
+    }
+
+    void ComputeTask::wait()
+    {
+        if(!submitted) return;
+        if(system::Statistics::getInstance()->waitForFences(1, &finishedFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fence!\n");
+        submitted = false;
+    }
+
+    const bool ComputeTask::isAsync() const
+    {
+        return async;
+    }
+
+    void ComputeTask::destroy()
+    {
+        if(resources == nullptr) return;
+        wait();
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        system::Executives* executives = system::Executives::getInstance();
+        if(async)
+        {
+            if(!executives->removeGraphicsWait(finishedSemaphore)) executives->waitForGraphicsConsumer(finishedSemaphore);
+            logicalDevice.destroySemaphore(finishedSemaphore, nullptr);
+        }
+        logicalDevice.destroyFence(finishedFence, nullptr);
+        logicalDevice.freeCommandBuffers(async ? executives->getComputePool() : executives->getPool(), 1, &commandBuffer);
+        logicalDevice.destroyPipeline(pipeline, nullptr);
+        resources = nullptr;
+        shaders = nullptr;
+    }
+
+    ComputeTask::~ComputeTask()
+    {
+        destroy();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include"../include/CullingSet.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/System.hpp"
+#include"../include/DescriptorAllocator.hpp"
+#include"../include/LayoutCache.hpp"
+#include<cstring>
+#include<cmath>
+
+namespace spk
+{
+    static_assert(sizeof(BoundingSphere) == 16, "BoundingSphere must match the cull shader vec4!");
+
+    CullingSet::CullingSet(): mappedInput(nullptr), version(0), capacity(0), copies(0){}
+
+    CullingSet::CullingSet(const uint32_t cCapacity, const uint32_t cCopies): mappedInput(nullptr)
+    {
+        create(cCapacity, cCopies);
+    }
+
+    void CullingSet::create(const uint32_t cCapacity, const uint32_t cCopies)
+    {
+        destroy();
+        capacity = (cCapacity == 0) ? 1 : cCapacity;
+        copies = (cCopies == 0) ? 1 : cCopies;
+        version = 1;
+        objects.assign(capacity, Object());
+        copyVersions.assign(copies, 0);
+
+        std::memset(&parameters, 0, sizeof(parameters));
+        const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        setViewProjection(identity);
+        std::memcpy(lastViewProjection, identity, sizeof(lastViewProjection));
+        parameters.compact = system::System::getInstance()->isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) && system::System::getInstance()->getEnabledFeatures().multiDrawIndirect;
+
+        vk::PhysicalDeviceProperties properties;
+        system::System::getInstance()->getPhysicalDevice().getProperties(&properties);
+        const vk::DeviceSize alignment = properties.limits.minStorageBufferOffsetAlignment;
+        inputStride = (sizeof(Parameters) + capacity * sizeof(Object) + alignment - 1) / alignment * alignment;
+        outputStride = (getCommandOffset(0) + capacity * sizeof(DrawCommand) + alignment - 1) / alignment * alignment;
+
+        input.create(inputStride * copies, vk::BufferUsageFlagBits::eStorageBuffer, false, true);
+        input.bindMemory();
+        mappedInput = static_cast<char*>(input.map());
+        output.create(outputStride * copies, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, true, true);
+        output.bindMemory();
+        createDescriptorSet();
+    }
+
+    const std::vector<vk::DescriptorSetLayoutBinding> CullingSet::getSetBindings()
+    {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings(2);
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            bindings[i].setBinding(i);                                                  // 0 = parameters and objects, 1 = draw count and commands
+            bindings[i].setDescriptorType(vk::DescriptorType::eStorageBufferDynamic);
+            bindings[i].setDescriptorCount(1);
+            bindings[i].setStageFlags(vk::ShaderStageFlagBits::eCompute);
+            bindings[i].setPImmutableSamplers(nullptr);
+        }
+        return bindings;
+    }
+
+    vk::DescriptorSetLayout CullingSet::createSetLayout()
+    {
+        return system::LayoutCache::getInstance()->getSetLayout(getSetBindings());
+    }
+
+    void CullingSet::createDescriptorSet()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        setLayout = createSetLayout();
+        descriptorSet = system::DescriptorAllocator::getInstance()->allocate(setLayout, getSetBindings());
+
+        vk::DescriptorBufferInfo bufferInfos[2];
+        bufferInfos[0].setBuffer(input.getBuffer());
+        bufferInfos[0].setOffset(0);                                                    // the copy is picked with a dynamic offset
+        bufferInfos[0].setRange(inputStride);
+        bufferInfos[1].setBuffer(output.getBuffer());
+        bufferInfos[1].setOffset(0);
+        bufferInfos[1].setRange(outputStride);
+        vk::WriteDescriptorSet writes[2];
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            writes[i].setDstSet(descriptorSet);
+            writes[i].setDstBinding(i);
+            writes[i].setDstArrayElement(0);
+            writes[i].setDescriptorCount(1);
+            writes[i].setDescriptorType(vk::DescriptorType::eStorageBufferDynamic);
+            writes[i].setPBufferInfo(&bufferInfos[i]);
+        }
+        logicalDevice.updateDescriptorSets(2, writes, 0, nullptr);
+    }
+
+    void CullingSet::setObject(const uint32_t index, const BoundingSphere& bounds, const DrawCommand& command)
+    {
+        if(index >= capacity) throw std::runtime_error("Culling object index is out of range!\n");
+        objects[index].bounds = bounds;
+        objects[index].command = command;
+        ++version;
+    }
+
+    void CullingSet::setObjectCount(const uint32_t count)
+    {
+        if(count > capacity) throw std::runtime_error("Object count exceeds the capacity!\n");
+        if(count > parameters.objectCount) ++version;                                  // the new objects haven't been copied yet
+        parameters.objectCount = count;
+    }
+
+    void CullingSet::setViewProjection(const float* matrix)
+    {
+        std::memcpy(parameters.viewProjection, matrix, sizeof(parameters.viewProjection));
+        const float* m = matrix;
+        const float row[4][4] = 
+        {
+            {m[0], m[4], m[8], m[12]},
+            {m[1], m[5], m[9], m[13]},
+            {m[2], m[6], m[10], m[14]},
+            {m[3], m[7], m[11], m[15]}
+        };
+        for(uint32_t i = 0; i < 4; ++i)                                                 // left, right, bottom, top, near (z >= 0), far (z <= w)
+        {
+            parameters.planes[0][i] = row[3][i] + row[0][i];
+            parameters.planes[1][i] = row[3][i] - row[0][i];
+            parameters.planes[2][i] = row[3][i] + row[1][i];
+            parameters.planes[3][i] = row[3][i] - row[1][i];
+            parameters.planes[4][i] = row[2][i];
+            parameters.planes[5][i] = row[3][i] - row[2][i];
+        }
+        for(auto& plane : parameters.planes)
+        {
+            const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if(length == 0) continue;
+            for(auto& component : plane)
+            {
+                component /= length;
+            }
+        }
+    }
+
+    const uint32_t CullingSet::getObjectCount() const
+    {
+        return parameters.objectCount;
+    }
+
+    const uint32_t CullingSet::getCapacity() const
+    {
+        return capacity;
+    }
+
+    const vk::DescriptorSet& CullingSet::getDescriptorSet() const
+    {
+        return descriptorSet;
+    }
+
+    const vk::Buffer& CullingSet::getOutputBuffer() const
+    {
+        return output.getBuffer();
+    }
+
+    const uint32_t CullingSet::getCopyCount() const
+    {
+        return copies;
+    }
+
+    const bool CullingSet::isCompact() const
+    {
+        return parameters.compact != 0;
+    }
+
+    const uint32_t CullingSet::getInputOffset(const uint32_t copy) const
+    {
+        return copy * inputStride;
+    }
+
+    const uint32_t CullingSet::getOutputOffset(const uint32_t copy) const
+    {
+        return copy * outputStride;
+    }
+
+    const vk::DeviceSize CullingSet::getCommandOffset(const uint32_t copy) const
+    {
+        return copy * outputStride + 16;                                                // the count is padded to 16 bytes
+    }
+
+    void CullingSet::flush(const uint32_t copy)
+    {
+        std::memcpy(parameters.previousViewProjection, lastViewProjection, sizeof(lastViewProjection));        // flushed once per drawn frame
+        std::memcpy(lastViewProjection, parameters.viewProjection, sizeof(lastViewProjection));
+        char* data = mappedInput + getInputOffset(copy);
+        std::memcpy(data, &parameters, sizeof(Parameters));
+        if(copyVersions[copy] == version) return;
+        const size_t objectBytes = parameters.objectCount * sizeof(Object);
+        std::memcpy(data + sizeof(Parameters), objects.data(), objectBytes);
+        system::Statistics::getInstance()->countUpload(objectBytes);
+        copyVersions[copy] = version;
+    }
+
+    void CullingSet::destroy()
+    {
+        if(mappedInput == nullptr) return;
+        system::DescriptorAllocator::getInstance()->free(descriptorSet);
+        system::Executives::getInstance()->releaseFrameCopies(this);
+        input.destroy();
+        output.destroy();
+        mappedInput = nullptr;
+    }
+
+    CullingSet::~CullingSet()
+    {
+        destroy();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include"../include/DescriptorAllocator.hpp"
+#include"../include/System.hpp"
+#include"../include/Executives.hpp"
+#include"../include/Tracing.hpp"
+#include<algorithm>
+
+namespace spk
+{
+    namespace system
+    {
+        namespace
+        {
+            const uint32_t firstPoolSets = 64;
+            const uint32_t maxPoolSets = 4096;
+
+            struct PoolRatio
+            {
+                vk::DescriptorType type;
+                float perSet;                                                           // descriptors of the type per set in a new pool
+            };
+
+            const PoolRatio poolRatios[] =
+            {
+                {vk::DescriptorType::eCombinedImageSampler, 4.0f},
+                {vk::DescriptorType::eUniformBuffer, 2.0f},
+                {vk::DescriptorType::eStorageBuffer, 2.0f},
+                {vk::DescriptorType::eUniformBufferDynamic, 1.0f},
+                {vk::DescriptorType::eStorageBufferDynamic, 1.0f},
+                {vk::DescriptorType::eStorageImage, 1.0f},
+                {vk::DescriptorType::eSampledImage, 1.0f},
+                {vk::DescriptorType::eSampler, 1.0f}
+            };
+        }
+
+        std::unique_ptr<DescriptorAllocator> DescriptorAllocator::instance = nullptr;
+
+        DescriptorAllocator::DescriptorAllocator()
+        {
+            persistentPools.nextPoolSets = firstPoolSets;
+            updateAfterBindPools.nextPoolSets = firstPoolSets;
+        }
+
+        DescriptorAllocator* DescriptorAllocator::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new DescriptorAllocator());
+            }
+            return instance.get();
+        }
+
+        vk::DescriptorSet DescriptorAllocator::allocate(const vk::DescriptorSetLayout& layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind)
+        {
+            const std::string key = getLayoutKey(bindings, updateAfterBind);
+            recycleRetired();
+            vk::DescriptorSet set;
+            auto recycled = freeSets.find(key);
+            if(recycled != freeSets.end() && !recycled->second.empty())                 // identically defined layouts are compatible, so the set fits this layout as well
+            {
+                set = recycled->second.back();
+                recycled->second.pop_back();
+            }
+            else set = allocateFrom(updateAfterBind ? updateAfterBindPools : persistentPools, layout, bindings, updateAfterBind);
+            setKeys[set] = key;
+            return set;
+        }
+
+        void DescriptorAllocator::free(const vk::DescriptorSet& set)
+        {
+            auto found = setKeys.find(set);
+            if(found == setKeys.end()) throw std::runtime_error("Freeing a descriptor set that was not allocated by the descriptor allocator!\n");
+            retiredSets.push_back({set, found->second, Executives::getInstance()->getFrameSubmissionCount()});
+            setKeys.erase(found);
+        }
+
+        void DescriptorAllocator::recycleRetired()
+        {
+            const uint64_t completed = Executives::getInstance()->getCompletedFrameSubmissions();
+            size_t recycled = 0;
+            while(recycled < retiredSets.size() && retiredSets[recycled].frameSubmission <= completed)  // pending command buffers may still reference the later ones
+            {
+                freeSets[retiredSets[recycled].key].push_back(retiredSets[recycled].set);
+                ++recycled;
+            }
+            retiredSets.erase(retiredSets.begin(), retiredSets.begin() + recycled);
+        }
+
+        const uint32_t DescriptorAllocator::getPoolCount() const
+        {
+            return persistentPools.pools.size() + updateAfterBindPools.pools.size();
+        }
+
+        vk::DescriptorPool DescriptorAllocator::createPool(const uint32_t maxSets, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind)
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            std::vector<vk::DescriptorPoolSize> poolSizes;
+            for(const auto& ratio : poolRatios)
+            {
+                uint32_t required = 0;
+                for(const auto& binding : bindings)
+                {
+                    if(binding.descriptorType == ratio.type) required += binding.descriptorCount;
+                }
+                vk::DescriptorPoolSize size;
+                size.setType(ratio.type);
+                size.setDescriptorCount(std::max(uint32_t(ratio.perSet * maxSets), required));
+                poolSizes.push_back(size);
+            }
+
+            vk::DescriptorPoolCreateInfo poolInfo;
+            poolInfo.setFlags(updateAfterBind ? vk::DescriptorPoolCreateFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT) : vk::DescriptorPoolCreateFlags());      // sets are recycled, never freed one by one
+            poolInfo.setMaxSets(maxSets);
+            poolInfo.setPoolSizeCount(poolSizes.size());
+            poolInfo.setPPoolSizes(poolSizes.data());
+            vk::DescriptorPool pool;
+            if(logicalDevice.createDescriptorPool(&poolInfo, nullptr, &pool) != vk::Result::eSuccess) throw std::runtime_error("Failed to create descriptor pool!\n");
+            return pool;
+        }
+
+        vk::DescriptorSet DescriptorAllocator::allocateFrom(PoolChain& chain, const vk::DescriptorSetLayout& layout, const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind)
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            vk::DescriptorSetAllocateInfo allocInfo;
+            allocInfo.setDescriptorSetCount(1);
+            allocInfo.setPSetLayouts(&layout);
+            vk::DescriptorSet set;
+            if(!chain.pools.empty())
+            {
+                allocInfo.setDescriptorPool(chain.pools.back());
+                const vk::Result result = logicalDevice.allocateDescriptorSets(&allocInfo, &set);
+                if(result == vk::Result::eSuccess) return set;
+                if(result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool) throw std::runtime_error("Failed to allocate descriptor set!\n");
+            }
+
+            SPARK_TRACE_SCOPE("DescriptorAllocator::grow");
+            chain.pools.push_back(createPool(chain.nextPoolSets, bindings, updateAfterBind));
+            chain.nextPoolSets = std::min(chain.nextPoolSets * 2, maxPoolSets);
+            allocInfo.setDescriptorPool(chain.pools.back());
+            if(logicalDevice.allocateDescriptorSets(&allocInfo, &set) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate descriptor set!\n");
+            return set;
+        }
+
+        const std::string DescriptorAllocator::getLayoutKey(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind) const
+        {
+            std::vector<vk::DescriptorSetLayoutBinding> sorted(bindings);
+            std::sort(sorted.begin(), sorted.end(), [](const vk::DescriptorSetLayoutBinding& a, const vk::DescriptorSetLayoutBinding& b){ return a.binding < b.binding; });
+            std::string key = updateAfterBind ? "uab;" : "";
+            for(const auto& binding : sorted)
+            {
+                if(binding.pImmutableSamplers != nullptr) throw std::runtime_error("Layouts with immutable samplers can't be recycled!\n");
+                key += std::to_string(binding.binding) + ':' + std::to_string(uint32_t(binding.descriptorType)) + ':' + std::to_string(binding.descriptorCount) + ':' + std::to_string(uint32_t(binding.stageFlags)) + ';';
+            }
+            return key;
+        }
+
+        void DescriptorAllocator::destroy()
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            for(auto& pool : persistentPools.pools)
+            {
+                logicalDevice.destroyDescriptorPool(pool, nullptr);
+            }
+            persistentPools.pools.clear();
+            persistentPools.nextPoolSets = firstPoolSets;
+            for(auto& pool : updateAfterBindPools.pools)
+            {
+                logicalDevice.destroyDescriptorPool(pool, nullptr);
+            }
+            updateAfterBindPools.pools.clear();
+            updateAfterBindPools.nextPoolSets = firstPoolSets;
+            retiredSets.clear();
+            freeSets.clear();
+            setKeys.clear();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include"../include/DrawCommandBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include<cstring>
+
+namespace spk
+{
+    static_assert(sizeof(DrawCommand) == sizeof(VkDrawIndexedIndirectCommand), "DrawCommand must match VkDrawIndexedIndirectCommand!");
+
+    DrawCommandBuffer::DrawCommandBuffer(): mappedData(nullptr), version(0), capacity(0), copies(0), drawCount(0){}
+
+    DrawCommandBuffer::DrawCommandBuffer(const uint32_t cCapacity, const uint32_t cCopies): mappedData(nullptr)
+    {
+        create(cCapacity, cCopies);
+    }
+
+    void DrawCommandBuffer::create(const uint32_t cCapacity, const uint32_t cCopies)
+    {
+        destroy();
+        capacity = cCapacity;
+        copies = (cCopies == 0) ? 1 : cCopies;
+        drawCount = 0;
+        version = 1;
+        commands.assign(capacity, DrawCommand());
+        copyVersions.assign(copies, 0);
+        buffer.create(getCountOffset(copies), vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, false, true);
+        buffer.bindMemory();
+        mappedData = static_cast<char*>(buffer.map());
+    }
+
+    void DrawCommandBuffer::setDrawCommand(const uint32_t index, const DrawCommand& command)
+    {
+        if(index >= capacity) throw std::runtime_error("Draw command index is out of range!\n");
+        commands[index] = command;
+        ++version;
+    }
+
+    void DrawCommandBuffer::setDrawCount(const uint32_t count)
+    {
+        if(count > capacity) throw std::runtime_error("Draw count exceeds the capacity!\n");
+        if(drawCount == count) return;
+        drawCount = count;
+        ++version;
+    }
+
+    const uint32_t DrawCommandBuffer::getDrawCount() const
+    {
+        return drawCount;
+    }
+
+    const uint32_t DrawCommandBuffer::getCapacity() const
+    {
+        return capacity;
+    }
+
+    const vk::Buffer& DrawCommandBuffer::getBuffer() const
+    {
+        return buffer.getBuffer();
+    }
+
+    const uint32_t DrawCommandBuffer::getCopyCount() const
+    {
+        return copies;
+    }
+
+    const vk::DeviceSize DrawCommandBuffer::getCommandOffset(const uint32_t copy) const
+    {
+        return vk::DeviceSize(copy) * capacity * sizeof(DrawCommand);
+    }
+
+    const vk::DeviceSize DrawCommandBuffer::getCountOffset(const uint32_t copy) const
+    {
+        return getCommandOffset(copies) + vk::DeviceSize(copy) * sizeof(uint32_t);
+    }
+
+    void DrawCommandBuffer::flush(const uint32_t copy)
+    {
+        if(copyVersions[copy] == version) return;
+        const size_t size = drawCount * sizeof(DrawCommand);
+        std::memcpy(mappedData + getCommandOffset(copy), commands.data(), size);
+        std::memcpy(mappedData + getCountOffset(copy), &drawCount, sizeof(uint32_t));
+        system::Statistics::getInstance()->countUpload(size + sizeof(uint32_t));
+        copyVersions[copy] = version;
+    }
+
+    void DrawCommandBuffer::destroy()
+    {
+        if(mappedData == nullptr) return;
+        system::Executives::getInstance()->releaseFrameCopies(this);
+        buffer.destroy();
+        mappedData = nullptr;
+    }
+
+    DrawCommandBuffer::~DrawCommandBuffer()
+    {
+        destroy();
+    }
+}
\ No newline at end of file
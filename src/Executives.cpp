@@ -1,5 +1,7 @@
 #include"../include/Executives.hpp"
 #include"../include/System.hpp"
+#include"../include/Statistics.hpp"
+#include<algorithm>
 
 namespace spk
 {
@@ -7,7 +9,7 @@ namespace spk
     {
         std::unique_ptr<Executives> Executives::executivesInstance = nullptr;
 
-        Executives::Executives()
+        Executives::Executives(): frameSubmissionCount(0), completedFrameSubmissions(0)
         {
             uint32_t queueFamilyPropertyCount;
             const vk::PhysicalDevice& physicalDevice = System::getInstance()->getPhysicalDevice();
@@ -28,6 +30,24 @@ namespace spk
                 ++i;
             }
             if(!graphicsSupport) throw std::runtime_error("Failed to pick graphics queue!\n");
+
+            computeQueueFamilyIndex = graphicsQueueFamilyIndex;
+            if(!(queueFamilyProperties[graphicsQueueFamilyIndex].queueFlags & vk::QueueFlagBits::eCompute))
+            {
+                for(i = 0; i < queueFamilyProperties.size(); ++i)
+                {
+                    if(queueFamilyProperties[i].queueFlags & vk::QueueFlagBits::eCompute) computeQueueFamilyIndex = i;
+                }
+            }
+            for(i = 0; i < queueFamilyProperties.size(); ++i)
+            {
+                const vk::QueueFlags flags = queueFamilyProperties[i].queueFlags;
+                if((flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics))
+                {
+                    computeQueueFamilyIndex = i;                                        // dedicated family: dispatches overlap with rendering
+                    break;
+                }
+            }
         }
         
         std::pair<uint32_t, const vk::Queue*> Executives::getPresentQueue(const vk::SurfaceKHR& surface)
@@ -77,6 +97,7 @@ namespace spk
                 }
                 graphicsQueueObtained = true;
                 logicalDevice.getQueue(executivesInstance->graphicsQueueFamilyIndex, 0, &executivesInstance->graphicsQueue);
+                logicalDevice.getQueue(executivesInstance->computeQueueFamilyIndex, 0, &executivesInstance->computeQueue);
                 executivesInstance->createPool();
             }
             return executivesInstance.get();
@@ -97,6 +118,152 @@ namespace spk
             return pool;
         }
 
+        const uint32_t Executives::getComputeQueueFamilyIndex() const
+        {
+            return computeQueueFamilyIndex;
+        }
+
+        const vk::Queue& Executives::getComputeQueue() const
+        {
+            return computeQueue;
+        }
+
+        const vk::CommandPool& Executives::getComputePool() const
+        {
+            return hasAsyncCompute() ? computePool : pool;
+        }
+
+        const bool Executives::hasAsyncCompute() const
+        {
+            return computeQueueFamilyIndex != graphicsQueueFamilyIndex;
+        }
+
+        void Executives::addGraphicsWait(const vk::Semaphore& semaphore, const vk::PipelineStageFlags stages, const RenderTarget* consumer)
+        {
+            graphicsWaitSemaphores.push_back(semaphore);
+            graphicsWaitStages.push_back(stages);
+            graphicsWaitConsumers.push_back(consumer);
+        }
+
+        const bool Executives::removeGraphicsWait(const vk::Semaphore& semaphore)
+        {
+            for(size_t i = 0; i < graphicsWaitSemaphores.size(); ++i)
+            {
+                if(graphicsWaitSemaphores[i] == semaphore)
+                {
+                    graphicsWaitSemaphores.erase(graphicsWaitSemaphores.begin() + i);
+                    graphicsWaitStages.erase(graphicsWaitStages.begin() + i);
+                    graphicsWaitConsumers.erase(graphicsWaitConsumers.begin() + i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Executives::takeGraphicsWaits(const RenderTarget* consumer, std::vector<vk::Semaphore>& semaphores, std::vector<vk::PipelineStageFlags>& stages, const vk::Fence& fence)
+        {
+            for(size_t i = 0; i < graphicsWaitSemaphores.size();)
+            {
+                if(graphicsWaitConsumers[i] != consumer)
+                {
+                    ++i;
+                    continue;
+                }
+                semaphores.push_back(graphicsWaitSemaphores[i]);
+                stages.push_back(graphicsWaitStages[i]);
+                consumedWaitSemaphores.push_back(graphicsWaitSemaphores[i]);
+                consumedWaitFences.push_back(fence);
+                graphicsWaitSemaphores.erase(graphicsWaitSemaphores.begin() + i);
+                graphicsWaitStages.erase(graphicsWaitStages.begin() + i);
+                graphicsWaitConsumers.erase(graphicsWaitConsumers.begin() + i);
+            }
+        }
+
+        void Executives::addFrameSubmission(const vk::Fence& fence)
+        {
+            ++frameSubmissionCount;
+            pendingFrameFences.push_back(fence);
+            pendingFrameSerials.push_back(frameSubmissionCount);
+        }
+
+        void Executives::completeFrameSubmission(const vk::Fence& fence)
+        {
+            for(size_t i = consumedWaitFences.size(); i-- > 0;)
+            {
+                if(consumedWaitFences[i] == fence)
+                {
+                    consumedWaitSemaphores.erase(consumedWaitSemaphores.begin() + i);
+                    consumedWaitFences.erase(consumedWaitFences.begin() + i);
+                }
+            }
+            for(size_t i = 0; i < pendingFrameFences.size(); ++i)
+            {
+                if(pendingFrameFences[i] == fence)
+                {
+                    completedFrameSubmissions = std::max(completedFrameSubmissions, pendingFrameSerials[i]);
+                    pendingFrameFences.erase(pendingFrameFences.begin() + i);
+                    pendingFrameSerials.erase(pendingFrameSerials.begin() + i);
+                    return;
+                }
+            }
+        }
+
+        void Executives::waitForFrameSubmissions()
+        {
+            if(pendingFrameFences.size() == 0) return;
+            if(Statistics::getInstance()->waitForFences(pendingFrameFences.size(), pendingFrameFences.data(), ~0ULL) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+            const std::vector<vk::Fence> fences = pendingFrameFences;
+            for(const auto& fence : fences)
+            {
+                completeFrameSubmission(fence);
+            }
+        }
+
+        const uint64_t Executives::getFrameSubmissionCount() const
+        {
+            return frameSubmissionCount;
+        }
+
+        const uint64_t Executives::getCompletedFrameSubmissions() const
+        {
+            return completedFrameSubmissions;
+        }
+
+        void Executives::waitForGraphicsConsumer(const vk::Semaphore& semaphore)
+        {
+            for(size_t i = 0; i < consumedWaitSemaphores.size(); ++i)
+            {
+                if(consumedWaitSemaphores[i] == semaphore)
+                {
+                    const vk::Fence fence = consumedWaitFences[i];
+                    if(Statistics::getInstance()->waitForFences(1, &fence, ~0ULL) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fence!\n");
+                    completeFrameSubmission(fence);                                     // every wait of that submission is done
+                    return;
+                }
+            }
+        }
+
+        void Executives::claimFrameCopies(const void* object, const RenderTarget* target, const std::string& name)
+        {
+            const auto owner = frameCopyOwners.find(object);
+            if(owner == frameCopyOwners.end()) frameCopyOwners[object] = target;
+            else if(owner->second != target) throw std::runtime_error(name + " is drawn by two render targets!\n");     // both would write the copies of their own frame slots
+        }
+
+        void Executives::releaseFrameCopies(const void* object)
+        {
+            frameCopyOwners.erase(object);
+        }
+
+        void Executives::releaseFrameCopyOwner(const RenderTarget* target)
+        {
+            for(auto owner = frameCopyOwners.begin(); owner != frameCopyOwners.end();)
+            {
+                if(owner->second == target) owner = frameCopyOwners.erase(owner);
+                else ++owner;
+            }
+        }
+
         void Executives::createPool()
         {
             const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
@@ -104,6 +271,11 @@ namespace spk
             poolInfo.setQueueFamilyIndex(graphicsQueueFamilyIndex);
             poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
             logicalDevice.createCommandPool(&poolInfo, nullptr, &pool);
+            if(hasAsyncCompute())
+            {
+                poolInfo.setQueueFamilyIndex(computeQueueFamilyIndex);
+                logicalDevice.createCommandPool(&poolInfo, nullptr, &computePool);
+            }
         }
 
         void Executives::destroy()
@@ -112,6 +284,7 @@ namespace spk
             {
                 const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
                 logicalDevice.destroyCommandPool(pool, nullptr);
+                if(computePool) logicalDevice.destroyCommandPool(computePool, nullptr);
             }
         }
     }
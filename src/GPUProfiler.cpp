@@ -0,0 +1,123 @@
+#include"../include/GPUProfiler.hpp"
+#include"../include/System.hpp"
+#include"../include/Executives.hpp"
+
+namespace spk
+{
+    namespace system
+    {
+        std::unique_ptr<GPUProfiler> GPUProfiler::instance = nullptr;
+
+        GPUProfiler::GPUProfiler()
+        {
+            const vk::PhysicalDevice& physicalDevice = System::getInstance()->getPhysicalDevice();
+            vk::PhysicalDeviceProperties deviceProperties;
+            physicalDevice.getProperties(&deviceProperties);
+            timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+            uint32_t queueFamilyPropertyCount;
+            physicalDevice.getQueueFamilyProperties(&queueFamilyPropertyCount, nullptr);
+            std::vector<vk::QueueFamilyProperties> queueFamilyProperties(queueFamilyPropertyCount);
+            physicalDevice.getQueueFamilyProperties(&queueFamilyPropertyCount, queueFamilyProperties.data());
+            const uint32_t validBits = queueFamilyProperties[Executives::getInstance()->getGraphicsQueueFamilyIndex()].timestampValidBits;
+            timestampMask = validBits >= 64 ? ~0ULL : (1ULL << validBits) - 1;
+
+            uploadTimingsEnabled = false;
+            submitCount = 0;
+        }
+
+        GPUProfiler* GPUProfiler::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new GPUProfiler());
+            }
+            return instance.get();
+        }
+
+        const bool GPUProfiler::isSupported() const
+        {
+            return timestampMask != 0;
+        }
+
+        const double GPUProfiler::toMilliseconds(const uint64_t begin, const uint64_t end) const
+        {
+            return double((end - begin) & timestampMask) * timestampPeriod / 1000000.0;
+        }
+
+        void GPUProfiler::setUploadTimingsEnabled(const bool enabled)
+        {
+            if(enabled && !isSupported()) return;
+            if(enabled && !uploadPool)
+            {
+                const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+                uploadSlots.resize(32, {std::string(), UploadState::Free, 0});
+                vk::QueryPoolCreateInfo poolInfo;
+                poolInfo.setQueryType(vk::QueryType::eTimestamp);
+                poolInfo.setQueryCount(uploadSlots.size() * 2);
+                if(logicalDevice.createQueryPool(&poolInfo, nullptr, &uploadPool) != vk::Result::eSuccess) throw std::runtime_error("Failed to create query pool!\n");
+            }
+            uploadTimingsEnabled = enabled;
+        }
+
+        const uint32_t GPUProfiler::beginUpload(vk::CommandBuffer& commandBuffer, const std::string& name)
+        {
+            if(!uploadTimingsEnabled) return invalidUpload;
+            for(uint32_t i = 0; i < uploadSlots.size(); ++i)
+            {
+                if(uploadSlots[i].state == UploadState::Free)
+                {
+                    uploadSlots[i].name = name;
+                    uploadSlots[i].state = UploadState::Recording;
+                    commandBuffer.resetQueryPool(uploadPool, i * 2, 2);
+                    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, uploadPool, i * 2);
+                    return i;
+                }
+            }
+            return invalidUpload;                                                                       // dropping a timing is preferable to stalling the upload
+        }
+
+        void GPUProfiler::endUpload(vk::CommandBuffer& commandBuffer, const uint32_t upload)
+        {
+            if(upload == invalidUpload) return;
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, uploadPool, upload * 2 + 1);
+            uploadSlots[upload].state = UploadState::Submitted;
+            uploadSlots[upload].serial = submitCount;
+        }
+
+        const uint64_t GPUProfiler::markSubmit()
+        {
+            return ++submitCount;
+        }
+
+        void GPUProfiler::collectUploads(const uint64_t completedSerial, std::vector<GPUTimingRegion>& uploads)
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            for(uint32_t i = 0; i < uploadSlots.size(); ++i)
+            {
+                UploadSlot& slot = uploadSlots[i];
+                if(slot.state != UploadState::Submitted || slot.serial >= completedSerial) continue;     // the queue executes submissions in order, so a finished frame implies finished earlier uploads
+                uint64_t timestamps[2];
+                const vk::Result result = logicalDevice.getQueryPoolResults(uploadPool, i * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+                if(result == vk::Result::eNotReady) continue;
+                if(result != vk::Result::eSuccess) throw std::runtime_error("Failed to get query pool results!\n");
+                uploads.push_back({slot.name, toMilliseconds(timestamps[0], timestamps[1]), 0});
+                slot.state = UploadState::Free;
+            }
+        }
+
+        void GPUProfiler::destroy()
+        {
+            if(uploadPool)
+            {
+                const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+                logicalDevice.destroyQueryPool(uploadPool, nullptr);
+                uploadPool = vk::QueryPool();
+                uploadSlots.clear();
+            }
+            uploadTimingsEnabled = false;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include"../include/GeometryArena.hpp"
+#include<iterator>
+
+namespace spk
+{
+    void GeometryArena::RangeAllocator::reset(const uint32_t capacity)
+    {
+        freeRanges.clear();
+        if(capacity != 0) freeRanges[0] = capacity;
+        freeCount = capacity;
+    }
+
+    const uint32_t GeometryArena::RangeAllocator::allocate(const uint32_t count)
+    {
+        if(count == 0) return 0;
+        for(auto range = freeRanges.begin(); range != freeRanges.end(); ++range)
+        {
+            if(range->second < count) continue;
+            const uint32_t first = range->first;
+            if(range->second > count) freeRanges[first + count] = range->second - count;
+            freeRanges.erase(range);
+            freeCount -= count;
+            return first;
+        }
+        return ~0;
+    }
+
+    void GeometryArena::RangeAllocator::free(const uint32_t first, const uint32_t count)
+    {
+        if(count == 0) return;
+        auto next = freeRanges.lower_bound(first);
+        const bool hasPrevious = (next != freeRanges.begin());
+        const auto previous = hasPrevious ? std::prev(next) : freeRanges.end();
+        if(next != freeRanges.end() && next->first < uint64_t(first) + count) throw std::runtime_error("Range is already free!\n");      // both neighbours are checked before the free list changes
+        if(hasPrevious && uint64_t(previous->first) + previous->second > first) throw std::runtime_error("Range is already free!\n");
+        uint32_t merged = count;
+        if(next != freeRanges.end() && first + count == next->first)
+        {
+            merged += next->second;
+            next = freeRanges.erase(next);
+        }
+        if(hasPrevious && previous->first + previous->second == first) previous->second += merged;
+        else freeRanges.emplace_hint(next, first, merged);
+        freeCount += count;
+    }
+
+    const uint32_t GeometryArena::RangeAllocator::getFreeCount() const
+    {
+        return freeCount;
+    }
+
+    GeometryArena::GeometryArena(){}
+
+    GeometryArena::GeometryArena(const std::vector<uint32_t>& cBindings, const std::vector<uint32_t>& cVertexSizes, const uint32_t cVertexCapacity, const uint32_t cIndexCapacity, const IndexType cIndexType)
+    {
+        create(cBindings, cVertexSizes, cVertexCapacity, cIndexCapacity, cIndexType);
+    }
+
+    void GeometryArena::create(const std::vector<uint32_t>& cBindings, const std::vector<uint32_t>& cVertexSizes, const uint32_t cVertexCapacity, const uint32_t cIndexCapacity, const IndexType cIndexType)
+    {
+        if(cBindings.size() != cVertexSizes.size()) throw std::runtime_error("Every binding needs a vertex size!\n");
+        if(cIndexType == IndexType::automatic) throw std::runtime_error("Geometry arena needs an explicit index type!\n");       // meshes are uploaded range by range
+        indexType = cIndexType;
+        std::vector<uint32_t> bufferSizes(cBindings.size());
+        vertexSizes.clear();
+        for(uint32_t i = 0; i < cBindings.size(); ++i)
+        {
+            vertexSizes[cBindings[i]] = cVertexSizes[i];
+            bufferSizes[i] = cVertexSizes[i] * cVertexCapacity;
+        }
+        const uint32_t indexSize = (indexType == IndexType::uint16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        geometry.reset(new VertexBuffer(cBindings, bufferSizes, cIndexCapacity * indexSize, indexType));
+        vertices.reset(cVertexCapacity);
+        indices.reset(cIndexCapacity);
+    }
+
+    MeshRange GeometryArena::allocate(const uint32_t vertexCount, const uint32_t indexCount)
+    {
+        if(indexType == IndexType::uint16 && vertexCount > 0x10000) throw std::runtime_error("Mesh has too many vertices for 16-bit indices!\n");
+        MeshRange range = {0, vertexCount, 0, indexCount};
+        range.firstVertex = vertices.allocate(vertexCount);
+        if(range.firstVertex == ~uint32_t(0)) throw std::runtime_error("Geometry arena has no room for the vertices!\n");
+        range.firstIndex = indices.allocate(indexCount);
+        if(range.firstIndex == ~uint32_t(0))
+        {
+            vertices.free(range.firstVertex, vertexCount);
+            throw std::runtime_error("Geometry arena has no room for the indices!\n");
+        }
+        return range;
+    }
+
+    void GeometryArena::free(const MeshRange& range)
+    {
+        vertices.free(range.firstVertex, range.vertexCount);
+        indices.free(range.firstIndex, range.indexCount);
+    }
+
+    void GeometryArena::updateVertices(const MeshRange& range, const uint32_t binding, const void* data)
+    {
+        const uint32_t vertexSize = vertexSizes.at(binding);
+        geometry->updateVertexBuffer(data, binding, range.firstVertex * vertexSize, range.vertexCount * vertexSize);
+    }
+
+    void GeometryArena::updateIndices(const MeshRange& range, const uint32_t* data)
+    {
+        if(indexType == IndexType::uint32)
+        {
+            geometry->updateIndexBuffer(data, range.firstIndex * sizeof(uint32_t), range.indexCount * sizeof(uint32_t));
+            return;
+        }
+        std::vector<uint16_t> narrowed(range.indexCount);
+        for(uint32_t i = 0; i < range.indexCount; ++i)
+        {
+            if(data[i] >= range.vertexCount) throw std::runtime_error("Index is out of the mesh range!\n");
+            narrowed[i] = static_cast<uint16_t>(data[i]);
+        }
+        geometry->updateIndexBuffer(narrowed.data(), range.firstIndex * sizeof(uint16_t), range.indexCount * sizeof(uint16_t));
+    }
+
+    DrawCommand GeometryArena::getDrawCommand(const MeshRange& range, const uint32_t instanceCount, const uint32_t firstInstance) const
+    {
+        DrawCommand command;
+        command.indexCount = range.indexCount;
+        command.instanceCount = instanceCount;
+        command.firstIndex = range.firstIndex;
+        command.vertexOffset = static_cast<int32_t>(range.firstVertex);
+        command.firstInstance = firstInstance;
+        return command;
+    }
+
+    VertexBuffer* GeometryArena::getGeometry()
+    {
+        return geometry.get();
+    }
+
+    const uint32_t GeometryArena::getFreeVertexCount() const
+    {
+        return vertices.getFreeCount();
+    }
+
+    const uint32_t GeometryArena::getFreeIndexCount() const
+    {
+        return indices.getFreeCount();
+    }
+}
\ No newline at end of file
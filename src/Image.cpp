@@ -1,4 +1,7 @@
 #include"../include/Image.hpp"
+#include"../include/GPUProfiler.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
 
 namespace spk
 {
@@ -35,13 +38,13 @@ namespace spk
         Image::Image(const Image& img)
         {
             destroy();
-            create(img.extent, img.format, img.usage, img.subresourceRange.aspectMask);
+            create(img.extent, img.format, img.usage, img.subresourceRange.aspectMask, img.subresourceRange.levelCount);
         }
 
         Image& Image::operator=(const Image& img)
         {
             destroy();
-            create(img.extent, img.format, img.usage, img.subresourceRange.aspectMask);
+            create(img.extent, img.format, img.usage, img.subresourceRange.aspectMask, img.subresourceRange.levelCount);
             return *this;
         }
 
@@ -71,14 +74,14 @@ namespace spk
             memoryData.offset = ~0;
         }
 
-        Image::Image(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags)
+        Image::Image(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags, const uint32_t cMipLevels)
         {
             memoryData.index = ~0;
             memoryData.offset = ~0;
-            create(cExtent, cFormat, cUsage, cAspectFlags);
+            create(cExtent, cFormat, cUsage, cAspectFlags, cMipLevels);
         }
 
-        void Image::create(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags)
+        void Image::create(const vk::Extent3D cExtent, const vk::Format cFormat, const vk::ImageUsageFlags cUsage, const vk::ImageAspectFlags cAspectFlags, const uint32_t cMipLevels)
         {
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             extent = cExtent;
@@ -86,7 +89,7 @@ namespace spk
 
             subresourceRange.setAspectMask(cAspectFlags);
             subresourceRange.setBaseMipLevel(0);
-            subresourceRange.setLevelCount(1);
+            subresourceRange.setLevelCount(cMipLevels);
             subresourceRange.setBaseArrayLayer(0);
             subresourceRange.setLayerCount(1);
 
@@ -96,6 +99,7 @@ namespace spk
             if(cUsage & vk::ImageUsageFlagBits::eColorAttachment) neededProperties |= vk::FormatFeatureFlagBits::eColorAttachment;
             if(cUsage & vk::ImageUsageFlagBits::eDepthStencilAttachment) neededProperties |= vk::FormatFeatureFlagBits::eDepthStencilAttachment;
             if(cUsage & vk::ImageUsageFlagBits::eTransferDst) neededProperties |= vk::FormatFeatureFlagBits::eTransferDst;
+            if(cUsage & vk::ImageUsageFlagBits::eStorage) neededProperties |= vk::FormatFeatureFlagBits::eStorageImage;
 
             vk::ImageTiling tiling = vk::ImageTiling::eOptimal;
             std::optional formatAvailability = getSupportedFormat(formats, tiling, neededProperties);
@@ -179,6 +183,11 @@ namespace spk
                     dstStage = vk::PipelineStageFlagBits::eFragmentShader;
                     dstAccess = vk::AccessFlagBits::eShaderRead;
                 }
+                else if(newLayout == vk::ImageLayout::eGeneral)
+                {
+                    dstStage = vk::PipelineStageFlagBits::eComputeShader;
+                    dstAccess = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+                }
                 else throw std::invalid_argument("Unsupported layout transition.\n");
             }
             else if(layout == vk::ImageLayout::eTransferDstOptimal)
@@ -218,7 +227,7 @@ namespace spk
             
             if(waitFence)
             {
-                if(logicalDevice.waitForFences(1, &waitFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+                if(system::Statistics::getInstance()->waitForFences(1, &waitFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
                 if(logicalDevice.resetFences(1, &waitFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
             }
 
@@ -264,6 +273,7 @@ namespace spk
             {
                 if(graphicsQueue.submit(1, &submit, vk::Fence()) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
             }
+            system::Statistics::getInstance()->countSubmit();
 
             layout = newLayout;
         }
@@ -277,6 +287,7 @@ namespace spk
             const vk::PipelineStageFlags dstStageFlags,
             bool oneTimeSubmit)
         {
+            SPARK_TRACE_SCOPE("Image::update");
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             const vk::Queue& graphicsQueue = system::Executives::getInstance()->getGraphicsQueue();
             if(layout != vk::ImageLayout::eTransferDstOptimal && layout != vk::ImageLayout::eGeneral) throw std::runtime_error("Can't update image with this layout!\n");
@@ -297,7 +308,7 @@ namespace spk
 
             if(waitFence)
             {
-                if(logicalDevice.waitForFences(1, &waitFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+                if(system::Statistics::getInstance()->waitForFences(1, &waitFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
                 if(logicalDevice.resetFences(1, &waitFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
             }
 
@@ -308,7 +319,9 @@ namespace spk
             }
 
             if(updateBuffer.begin(&info) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+            const uint32_t upload = system::GPUProfiler::getInstance()->beginUpload(updateBuffer, "image upload");
             updateBuffer.copyBufferToImage(buffer, image, layout, 1, &copyInfo);
+            system::GPUProfiler::getInstance()->endUpload(updateBuffer, upload);
             updateBuffer.end();
 
             vk::SubmitInfo submit;
@@ -344,6 +357,7 @@ namespace spk
             {
                 if(graphicsQueue.submit(1, &submit, vk::Fence()) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
             }
+            system::Statistics::getInstance()->countSubmit();
         }
 
         void Image::destroy()
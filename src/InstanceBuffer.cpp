@@ -0,0 +1,94 @@
+#include"../include/InstanceBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include<cstring>
+
+namespace spk
+{
+    InstanceBuffer::InstanceBuffer(): mappedData(nullptr), version(0), instanceSize(0), capacity(0), copies(0), instanceCount(0){}
+
+    InstanceBuffer::InstanceBuffer(const uint32_t cInstanceSize, const uint32_t cCapacity, const uint32_t cCopies): mappedData(nullptr)
+    {
+        create(cInstanceSize, cCapacity, cCopies);
+    }
+
+    void InstanceBuffer::create(const uint32_t cInstanceSize, const uint32_t cCapacity, const uint32_t cCopies)
+    {
+        destroy();
+        instanceSize = cInstanceSize;
+        capacity = cCapacity;
+        copies = (cCopies == 0) ? 1 : cCopies;
+        instanceCount = 0;
+        version = 1;
+        instances.assign(vk::DeviceSize(capacity) * instanceSize, 0);
+        copyVersions.assign(copies, 0);
+        buffer.create(getOffset(copies), vk::BufferUsageFlagBits::eVertexBuffer, false, true);
+        buffer.bindMemory();
+        mappedData = static_cast<char*>(buffer.map());
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstanceBuffer(this);
+    }
+
+    void InstanceBuffer::setInstances(const uint32_t first, const uint32_t count, const void* data)
+    {
+        if(first + count > capacity) throw std::runtime_error("Instance range is out of the capacity!\n");
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstances(this, first, count, data);
+        std::memcpy(instances.data() + vk::DeviceSize(first) * instanceSize, data, vk::DeviceSize(count) * instanceSize);
+        ++version;
+    }
+
+    void InstanceBuffer::setInstanceCount(const uint32_t count)
+    {
+        if(count > capacity) throw std::runtime_error("Instance count exceeds the capacity!\n");
+        if(instanceCount == count) return;
+        instanceCount = count;
+        ++version;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstanceCount(this);
+    }
+
+    const uint32_t InstanceBuffer::getInstanceCount() const
+    {
+        return instanceCount;
+    }
+
+    const uint32_t InstanceBuffer::getCapacity() const
+    {
+        return capacity;
+    }
+
+    const vk::Buffer& InstanceBuffer::getBuffer() const
+    {
+        return buffer.getBuffer();
+    }
+
+    const uint32_t InstanceBuffer::getCopyCount() const
+    {
+        return copies;
+    }
+
+    const vk::DeviceSize InstanceBuffer::getOffset(const uint32_t copy) const
+    {
+        return vk::DeviceSize(copy) * capacity * instanceSize;
+    }
+
+    void InstanceBuffer::flush(const uint32_t copy)
+    {
+        if(copyVersions[copy] == version) return;
+        const size_t size = vk::DeviceSize(instanceCount) * instanceSize;               // only the first instanceCount instances are streamed
+        std::memcpy(mappedData + getOffset(copy), instances.data(), size);
+        system::Statistics::getInstance()->countUpload(size);
+        copyVersions[copy] = version;
+    }
+
+    void InstanceBuffer::destroy()
+    {
+        if(mappedData == nullptr) return;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstanceBufferDestroy(this);
+        system::Executives::getInstance()->releaseFrameCopies(this);
+        buffer.destroy();
+        mappedData = nullptr;
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        destroy();
+    }
+}
\ No newline at end of file
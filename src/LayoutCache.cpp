@@ -0,0 +1,149 @@
+#include"../include/LayoutCache.hpp"
+#include"../include/System.hpp"
+#include"../include/Tracing.hpp"
+#include<algorithm>
+
+namespace spk
+{
+    namespace system
+    {
+        std::unique_ptr<LayoutCache> LayoutCache::instance = nullptr;
+
+        LayoutCache::LayoutCache(){}
+
+        LayoutCache* LayoutCache::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new LayoutCache());
+            }
+            return instance.get();
+        }
+
+        size_t LayoutCache::KeyHash::operator()(const std::vector<uint64_t>& key) const
+        {
+            uint64_t hash = 14695981039346656037ULL;                                    // FNV-1a over the words
+            for(const uint64_t word : key)
+            {
+                hash ^= word;
+                hash *= 1099511628211ULL;
+            }
+            return size_t(hash);
+        }
+
+        vk::DescriptorSetLayout LayoutCache::getSetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings, const bool updateAfterBind)
+        {
+            std::vector<vk::DescriptorSetLayoutBinding> sorted(bindings);               // binding order doesn't change the layout
+            std::sort(sorted.begin(), sorted.end(), [](const vk::DescriptorSetLayoutBinding& a, const vk::DescriptorSetLayoutBinding& b){ return a.binding < b.binding; });
+            std::vector<uint64_t> key;
+            key.reserve(sorted.size() * 2 + 1);
+            key.push_back(updateAfterBind);
+            for(const auto& binding : sorted)
+            {
+                if(binding.pImmutableSamplers != nullptr) throw std::runtime_error("Layouts with immutable samplers can't be cached!\n");
+                key.push_back((uint64_t(binding.binding) << 32) | uint32_t(binding.descriptorType));
+                key.push_back((uint64_t(binding.descriptorCount) << 32) | uint32_t(binding.stageFlags));
+            }
+            auto found = setLayoutIdentifiers.find(key);
+            if(found != setLayoutIdentifiers.end()) return setLayouts[found->second];
+
+            SPARK_TRACE_SCOPE("LayoutCache::createSetLayout");
+            vk::DescriptorSetLayoutCreateInfo layoutInfo;
+            layoutInfo.setBindingCount(sorted.size());
+            layoutInfo.setPBindings(sorted.data());
+            std::vector<vk::DescriptorBindingFlagsEXT> bindingFlags(sorted.size(), vk::DescriptorBindingFlagBitsEXT::ePartiallyBound | vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind);
+            vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo;
+            if(updateAfterBind)
+            {
+                flagsInfo.setBindingCount(bindingFlags.size());
+                flagsInfo.setPBindingFlags(bindingFlags.data());
+                layoutInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT);
+                layoutInfo.setPNext(&flagsInfo);
+            }
+            vk::DescriptorSetLayout layout;
+            if(System::getInstance()->getLogicalDevice().createDescriptorSetLayout(&layoutInfo, nullptr, &layout) != vk::Result::eSuccess) throw std::runtime_error("Failed to create descriptor layout!\n");
+            const uint32_t identifier = setLayouts.size();
+            setLayouts.push_back(layout);
+            setLayoutIdentifiers[key] = identifier;
+            setLayoutHandles[layout] = identifier;
+            return layout;
+        }
+
+        vk::PipelineLayout LayoutCache::getPipelineLayout(const std::vector<vk::DescriptorSetLayout>& cSetLayouts, const std::vector<vk::PushConstantRange>& pushConstantRanges)
+        {
+            std::vector<uint64_t> key;
+            key.reserve(1 + cSetLayouts.size() + pushConstantRanges.size() * 2);
+            key.push_back(cSetLayouts.size());                                          // separates the set layouts from the ranges
+            for(const auto& layout : cSetLayouts)
+            {
+                key.push_back(getSetLayoutIdentifier(layout));
+            }
+            for(const auto& range : pushConstantRanges)
+            {
+                key.push_back((uint64_t(range.offset) << 32) | range.size);
+                key.push_back(uint32_t(range.stageFlags));
+            }
+            auto found = pipelineLayoutIdentifiers.find(key);
+            if(found != pipelineLayoutIdentifiers.end()) return pipelineLayouts[found->second];
+
+            SPARK_TRACE_SCOPE("LayoutCache::createPipelineLayout");
+            vk::PipelineLayoutCreateInfo layoutInfo;
+            layoutInfo.setSetLayoutCount(cSetLayouts.size());
+            layoutInfo.setPSetLayouts(cSetLayouts.data());
+            layoutInfo.setPushConstantRangeCount(pushConstantRanges.size());
+            layoutInfo.setPPushConstantRanges(pushConstantRanges.data());
+            vk::PipelineLayout layout;
+            if(System::getInstance()->getLogicalDevice().createPipelineLayout(&layoutInfo, nullptr, &layout) != vk::Result::eSuccess) throw std::runtime_error("Failed to create pipeline layout!\n");
+            const uint32_t identifier = pipelineLayouts.size();
+            pipelineLayouts.push_back(layout);
+            pipelineLayoutIdentifiers[key] = identifier;
+            pipelineLayoutHandles[layout] = identifier;
+            return layout;
+        }
+
+        const uint32_t LayoutCache::getIdentifier(const vk::PipelineLayout& layout) const
+        {
+            auto found = pipelineLayoutHandles.find(layout);
+            if(found == pipelineLayoutHandles.end()) throw std::runtime_error("Pipeline layout was not created by the layout cache!\n");
+            return found->second;
+        }
+
+        const uint32_t LayoutCache::getSetLayoutIdentifier(const vk::DescriptorSetLayout& layout) const
+        {
+            auto found = setLayoutHandles.find(layout);
+            if(found == setLayoutHandles.end()) throw std::runtime_error("Descriptor set layout was not created by the layout cache!\n");
+            return found->second;
+        }
+
+        const uint32_t LayoutCache::getSetLayoutCount() const
+        {
+            return setLayouts.size();
+        }
+
+        const uint32_t LayoutCache::getPipelineLayoutCount() const
+        {
+            return pipelineLayouts.size();
+        }
+
+        void LayoutCache::destroy()
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            for(auto& layout : pipelineLayouts)
+            {
+                logicalDevice.destroyPipelineLayout(layout, nullptr);
+            }
+            for(auto& layout : setLayouts)
+            {
+                logicalDevice.destroyDescriptorSetLayout(layout, nullptr);
+            }
+            pipelineLayouts.clear();
+            setLayouts.clear();
+            pipelineLayoutIdentifiers.clear();
+            setLayoutIdentifiers.clear();
+            pipelineLayoutHandles.clear();
+            setLayoutHandles.clear();
+        }
+    }
+}
\ No newline at end of file
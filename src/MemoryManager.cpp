@@ -1,5 +1,7 @@
 #include"../include/MemoryManager.hpp"
 #include"../include/System.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
 
 namespace spk
 {
@@ -57,6 +59,7 @@ namespace spk
 
         void MemoryManager::allocateMemoryBlock(const MemoryAllocationInfo& info, index_t index)
         {
+            SPARK_TRACE_SCOPE("MemoryManager::allocateMemoryBlock");
             const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
             vk::MemoryAllocateInfo vkInfo;
             vkInfo.setAllocationSize(info.size);
@@ -65,6 +68,7 @@ namespace spk
             {
                 throw std::runtime_error("Failed to allocate memory!\n");
             }
+            Statistics::getInstance()->countAllocation(info.size);
         }
 
         void MemoryManager::flushLazyAllocations()
@@ -0,0 +1,546 @@
+#include"../include/MeshOptimizer.hpp"
+#include<algorithm>
+#include<cmath>
+#include<cstring>
+#include<numeric>
+#include<stdexcept>
+#include<string_view>
+#include<unordered_map>
+
+namespace spk
+{
+    namespace utils
+    {
+        namespace
+        {
+            struct ClusterOrder
+            {
+                uint32_t first;
+                uint32_t count;
+                float sortKey;
+            };
+
+            class VertexCache                                                           // FIFO post-transform cache, as the statistics assume
+            {
+            public:
+                VertexCache(const uint32_t vertexCount, const uint32_t cCacheSize): timestamps(vertexCount, 0), time(cCacheSize + 1), cacheSize(cCacheSize) {}
+                bool transform(const uint32_t vertex)                                   // true on a miss
+                {
+                    if(time - timestamps[vertex] <= cacheSize) return false;
+                    timestamps[vertex] = time++;
+                    return true;
+                }
+                void clear()
+                {
+                    time += cacheSize + 1;
+                }
+            private:
+                std::vector<uint64_t> timestamps;
+                uint64_t time;
+                uint32_t cacheSize;
+            };
+
+            void checkIndices(const std::vector<uint32_t>& indices, const uint32_t vertexCount)
+            {
+                if(indices.size() % 3 != 0) throw std::runtime_error("Index count must be a multiple of 3!\n");
+                for(const uint32_t index : indices)
+                {
+                    if(index >= vertexCount) throw std::runtime_error("Index is out of the vertex range!\n");
+                }
+            }
+
+            const float* position(const char* positions, const uint32_t stride, const uint32_t vertex)
+            {
+                return reinterpret_cast<const float*>(positions + size_t(vertex) * stride);
+            }
+
+            struct Quadric                                                              // area-weighted sum of squared distances to the planes of the triangles around a vertex
+            {
+                double coefficients[10];                                                // xx, xy, xz, xw, yy, yz, yw, zz, zw, ww of the symmetric 4x4 matrix
+                double weight;
+            };
+
+            struct Collapse
+            {
+                uint32_t from;
+                uint32_t to;
+                float error;
+            };
+
+            void addPlane(Quadric& quadric, const double* plane, const double weight)
+            {
+                const double a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+                const double terms[10] = {a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d};
+                for(uint32_t i = 0; i < 10; ++i)
+                {
+                    quadric.coefficients[i] += terms[i] * weight;
+                }
+                quadric.weight += weight;
+            }
+
+            void addQuadric(Quadric& quadric, const Quadric& other)
+            {
+                for(uint32_t i = 0; i < 10; ++i)
+                {
+                    quadric.coefficients[i] += other.coefficients[i];
+                }
+                quadric.weight += other.weight;
+            }
+
+            float evaluateCollapse(const Quadric& from, const Quadric& to, const float* p)     // distance from the merged planes to p
+            {
+                double q[10];
+                for(uint32_t i = 0; i < 10; ++i)
+                {
+                    q[i] = from.coefficients[i] + to.coefficients[i];
+                }
+                const double x = p[0], y = p[1], z = p[2], weight = from.weight + to.weight;
+                const double squared = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y + q[7] * z * z + 2 * q[8] * z + q[9];
+                return (weight == 0) ? 0.0f : float(std::sqrt(std::max(squared, 0.0) / weight));
+            }
+
+            void triangleNormal(const float* a, const float* b, const float* c, double* normal)      // not normalized, its length is twice the area
+            {
+                const double ab[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]}, ac[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+                normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+                normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+                normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+            }
+
+            uint64_t edgeKey(const uint32_t a, const uint32_t b)
+            {
+                return (a < b) ? (uint64_t(a) << 32 | b) : (uint64_t(b) << 32 | a);
+            }
+        }
+
+        VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize)
+        {
+            checkIndices(indices, vertexCount);
+            VertexCache cache(vertexCount, cacheSize);
+            std::vector<bool> referenced(vertexCount, false);
+            uint32_t misses = 0, referencedCount = 0;
+            for(const uint32_t index : indices)
+            {
+                if(cache.transform(index)) ++misses;
+                if(!referenced[index])
+                {
+                    referenced[index] = true;
+                    ++referencedCount;
+                }
+            }
+            VertexCacheStatistics statistics;
+            statistics.acmr = indices.empty() ? 0.0f : float(misses) / float(indices.size() / 3);
+            statistics.atvr = (referencedCount == 0) ? 0.0f : float(misses) / float(referencedCount);
+            return statistics;
+        }
+
+        uint32_t deduplicateVertices(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices)
+        {
+            const uint32_t vertexCount = vertices.size() / vertexSize;
+            if(indices.empty())
+            {
+                indices.resize(vertexCount);
+                std::iota(indices.begin(), indices.end(), 0);
+            }
+            checkIndices(indices, vertexCount);
+
+            std::vector<uint32_t> remap(vertexCount);
+            std::unordered_map<std::string_view, uint32_t> uniqueVertices;             // keys point into the input, which is compacted only afterwards
+            uniqueVertices.reserve(vertexCount);
+            std::vector<char> compacted;
+            compacted.reserve(vertices.size());
+            for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                const std::string_view key(vertices.data() + size_t(vertex) * vertexSize, vertexSize);
+                auto inserted = uniqueVertices.emplace(key, uint32_t(uniqueVertices.size()));
+                remap[vertex] = inserted.first->second;
+                if(inserted.second) compacted.insert(compacted.end(), key.begin(), key.end());
+            }
+            for(auto& index : indices)
+            {
+                index = remap[index];
+            }
+            vertices.swap(compacted);
+            return uniqueVertices.size();
+        }
+
+        std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize)
+        {
+            checkIndices(indices, vertexCount);
+            const uint32_t triangleCount = indices.size() / 3;
+
+            std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);                // triangles of every vertex, packed
+            for(const uint32_t index : indices)
+            {
+                ++adjacencyOffsets[index + 1];
+            }
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+            std::vector<uint32_t> adjacency(indices.size()), fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for(uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+            {
+                for(uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    adjacency[fill[indices[3 * triangle + corner]]++] = triangle;
+                }
+            }
+
+            std::vector<uint32_t> liveTriangles(vertexCount);
+            for(uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                liveTriangles[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+            }
+            std::vector<uint64_t> timestamps(vertexCount, 0);
+            uint64_t time = cacheSize + 1;
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> deadEnds, candidates, result, clusters;
+            result.reserve(indices.size());
+            uint32_t cursor = 0;
+
+            auto skipDeadEnd = [&]() -> int64_t
+            {
+                while(!deadEnds.empty())
+                {
+                    const uint32_t vertex = deadEnds.back();
+                    deadEnds.pop_back();
+                    if(liveTriangles[vertex] > 0) return vertex;
+                }
+                for(; cursor < vertexCount; ++cursor)
+                {
+                    if(liveTriangles[cursor] > 0) return cursor;
+                }
+                return -1;
+            };
+
+            int64_t fanning = skipDeadEnd();
+            bool clusterStart = true;
+            while(fanning >= 0)
+            {
+                if(clusterStart) clusters.push_back(result.size() / 3);
+                candidates.clear();
+                for(uint32_t i = adjacencyOffsets[fanning]; i < adjacencyOffsets[fanning + 1]; ++i)
+                {
+                    const uint32_t triangle = adjacency[i];
+                    if(emitted[triangle]) continue;
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        const uint32_t vertex = indices[3 * triangle + corner];
+                        result.push_back(vertex);
+                        deadEnds.push_back(vertex);
+                        candidates.push_back(vertex);
+                        --liveTriangles[vertex];
+                        if(time - timestamps[vertex] > cacheSize) timestamps[vertex] = time++;
+                    }
+                    emitted[triangle] = true;
+                }
+
+                int64_t next = -1, bestPriority = -1;                                   // the candidate that stays longest in the cache after its remaining triangles are emitted
+                for(const uint32_t vertex : candidates)
+                {
+                    if(liveTriangles[vertex] == 0) continue;
+                    int64_t priority = 0;
+                    if(time - timestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize) priority = time - timestamps[vertex];
+                    if(priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = vertex;
+                    }
+                }
+                clusterStart = (next < 0);
+                fanning = (next < 0) ? skipDeadEnd() : next;
+            }
+            indices.swap(result);
+            return clusters;
+        }
+
+        void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const char* positions, const uint32_t stride, const uint32_t vertexCount, const float threshold, const uint32_t cacheSize)
+        {
+            checkIndices(indices, vertexCount);
+            const uint32_t triangleCount = indices.size() / 3;
+            if(triangleCount == 0) return;
+
+            std::vector<uint32_t> softClusters;                                         // clusters are split further wherever their ACMR is already low enough
+            const float targetACMR = analyzeVertexCache(indices, vertexCount, cacheSize).acmr * threshold;
+            VertexCache cache(vertexCount, cacheSize);
+            for(uint32_t cluster = 0; cluster < clusters.size(); ++cluster)
+            {
+                const uint32_t end = (cluster + 1 < clusters.size()) ? clusters[cluster + 1] : triangleCount;
+                uint32_t clusterMisses = 0, clusterTriangles = 0;
+                softClusters.push_back(clusters[cluster]);
+                cache.clear();
+                for(uint32_t triangle = clusters[cluster]; triangle < end; ++triangle)
+                {
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        if(cache.transform(indices[3 * triangle + corner])) ++clusterMisses;
+                    }
+                    ++clusterTriangles;
+                    if(triangle + 1 < end && clusterMisses <= targetACMR * clusterTriangles)
+                    {
+                        softClusters.push_back(triangle + 1);
+                        clusterMisses = clusterTriangles = 0;
+                        cache.clear();
+                    }
+                }
+            }
+
+            std::vector<ClusterOrder> order(softClusters.size());
+            std::vector<float> centroids(3 * softClusters.size()), normals(3 * softClusters.size());
+            float meshCentroid[3] = {0, 0, 0}, meshArea = 0;
+            for(uint32_t cluster = 0; cluster < softClusters.size(); ++cluster)
+            {
+                order[cluster].first = softClusters[cluster];
+                order[cluster].count = ((cluster + 1 < softClusters.size()) ? softClusters[cluster + 1] : triangleCount) - softClusters[cluster];
+                float* centroid = &centroids[3 * cluster];
+                float* normal = &normals[3 * cluster];
+                float area = 0;
+                for(uint32_t triangle = order[cluster].first; triangle < order[cluster].first + order[cluster].count; ++triangle)
+                {
+                    const float* a = position(positions, stride, indices[3 * triangle]);
+                    const float* b = position(positions, stride, indices[3 * triangle + 1]);
+                    const float* c = position(positions, stride, indices[3 * triangle + 2]);
+                    const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]}, ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                    const float cross[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+                    const float triangleArea = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+                    for(uint32_t axis = 0; axis < 3; ++axis)
+                    {
+                        centroid[axis] += (a[axis] + b[axis] + c[axis]) / 3.0f * triangleArea;
+                        normal[axis] += cross[axis];
+                    }
+                    area += triangleArea;
+                }
+                for(uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    meshCentroid[axis] += centroid[axis];
+                    centroid[axis] = (area == 0) ? 0 : centroid[axis] / area;
+                }
+                meshArea += area;
+            }
+            for(uint32_t axis = 0; axis < 3; ++axis)
+            {
+                meshCentroid[axis] = (meshArea == 0) ? 0 : meshCentroid[axis] / meshArea;
+            }
+            for(uint32_t cluster = 0; cluster < order.size(); ++cluster)                // clusters facing away from the mesh centre occlude the others, so they go first
+            {
+                const float* centroid = &centroids[3 * cluster];
+                const float* normal = &normals[3 * cluster];
+                const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                const float outward = (centroid[0] - meshCentroid[0]) * normal[0] + (centroid[1] - meshCentroid[1]) * normal[1] + (centroid[2] - meshCentroid[2]) * normal[2];
+                order[cluster].sortKey = (length == 0) ? 0 : outward / length;
+            }
+            std::stable_sort(order.begin(), order.end(), [](const ClusterOrder& a, const ClusterOrder& b){ return a.sortKey > b.sortKey; });
+
+            std::vector<uint32_t> result;
+            result.reserve(indices.size());
+            for(const auto& cluster : order)
+            {
+                result.insert(result.end(), indices.begin() + 3 * cluster.first, indices.begin() + 3 * (cluster.first + cluster.count));
+            }
+            indices.swap(result);
+        }
+
+        uint32_t optimizeVertexFetch(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices)
+        {
+            const uint32_t vertexCount = vertices.size() / vertexSize;
+            checkIndices(indices, vertexCount);
+            std::vector<uint32_t> remap(vertexCount, ~uint32_t(0));
+            std::vector<char> reordered;
+            reordered.reserve(vertices.size());
+            uint32_t nextVertex = 0;
+            for(auto& index : indices)
+            {
+                if(remap[index] == ~uint32_t(0))
+                {
+                    remap[index] = nextVertex++;
+                    reordered.insert(reordered.end(), vertices.begin() + size_t(index) * vertexSize, vertices.begin() + size_t(index + 1) * vertexSize);
+                }
+                index = remap[index];
+            }
+            vertices.swap(reordered);
+            return nextVertex;
+        }
+
+        MeshOptimizationReport optimizeMesh(std::vector<char>& vertices, const uint32_t vertexSize, std::vector<uint32_t>& indices, const uint32_t positionOffset, const MeshOptimizationOptions& options)
+        {
+            if(vertexSize == 0 || vertices.size() % vertexSize != 0) throw std::runtime_error("Vertex data is not a whole number of vertices!\n");
+            if(options.optimizeOverdraw && positionOffset + 3 * sizeof(float) > vertexSize) throw std::runtime_error("Vertex position is out of the vertex!\n");
+            MeshOptimizationReport report;
+            report.vertexCountBefore = vertices.size() / vertexSize;
+            if(indices.empty())
+            {
+                indices.resize(report.vertexCountBefore);
+                std::iota(indices.begin(), indices.end(), 0);
+            }
+            report.before = analyzeVertexCache(indices, report.vertexCountBefore, options.cacheSize);
+
+            uint32_t vertexCount = report.vertexCountBefore;
+            if(options.deduplicate) vertexCount = deduplicateVertices(vertices, vertexSize, indices);
+            if(options.optimizeVertexCache)
+            {
+                const std::vector<uint32_t> clusters = optimizeVertexCache(indices, vertexCount, options.cacheSize);
+                if(options.optimizeOverdraw) optimizeOverdraw(indices, clusters, vertices.data() + positionOffset, vertexSize, vertexCount, options.overdrawThreshold, options.cacheSize);
+            }
+            if(options.optimizeVertexFetch) vertexCount = optimizeVertexFetch(vertices, vertexSize, indices);
+
+            report.after = analyzeVertexCache(indices, vertexCount, options.cacheSize);
+            report.vertexCountAfter = vertexCount;
+            return report;
+        }
+
+        LevelOfDetail simplifyMesh(const std::vector<uint32_t>& indices, const char* positions, const uint32_t stride, const uint32_t vertexCount, const uint32_t targetIndexCount)
+        {
+            checkIndices(indices, vertexCount);
+            LevelOfDetail result;
+            result.indices = indices;
+            result.error = 0;
+            std::vector<uint32_t>& current = result.indices;
+
+            std::vector<Quadric> quadrics(vertexCount, Quadric());
+            std::unordered_map<uint64_t, uint32_t> edgeUses;
+            edgeUses.reserve(indices.size());
+            for(uint32_t triangle = 0; triangle < indices.size() / 3; ++triangle)
+            {
+                const uint32_t* corners = &indices[3 * triangle];
+                double plane[4];
+                triangleNormal(position(positions, stride, corners[0]), position(positions, stride, corners[1]), position(positions, stride, corners[2]), plane);
+                const double length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                if(length > 0)
+                {
+                    const float* a = position(positions, stride, corners[0]);
+                    for(uint32_t axis = 0; axis < 3; ++axis)
+                    {
+                        plane[axis] /= length;
+                    }
+                    plane[3] = -(plane[0] * a[0] + plane[1] * a[1] + plane[2] * a[2]);
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        addPlane(quadrics[corners[corner]], plane, length * 0.5);
+                    }
+                }
+                for(uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    ++edgeUses[edgeKey(corners[corner], corners[(corner + 1) % 3])];
+                }
+            }
+            std::vector<bool> locked(vertexCount, false);                               // open borders, UV and normal seams included, and non-manifold edges keep their shape
+            for(const auto& edge : edgeUses)
+            {
+                if(edge.second == 2) continue;
+                locked[edge.first >> 32] = true;
+                locked[edge.first & 0xFFFFFFFF] = true;
+            }
+
+            const uint32_t targetTriangles = targetIndexCount / 3;
+            std::vector<uint32_t> adjacencyOffsets, adjacency, remap(vertexCount);
+            std::vector<bool> touched;
+            std::vector<Collapse> collapses;
+            while(current.size() / 3 > targetTriangles)                                 // every pass collapses independent edges, cheapest first
+            {
+                const uint32_t triangleCount = current.size() / 3;
+                adjacencyOffsets.assign(vertexCount + 1, 0);
+                for(const uint32_t index : current)
+                {
+                    ++adjacencyOffsets[index + 1];
+                }
+                std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+                adjacency.resize(current.size());
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for(uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+                {
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        adjacency[fill[current[3 * triangle + corner]]++] = triangle;
+                    }
+                }
+
+                collapses.clear();
+                for(uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+                {
+                    for(uint32_t corner = 0; corner < 3; ++corner)
+                    {
+                        const uint32_t a = current[3 * triangle + corner], b = current[3 * triangle + (corner + 1) % 3];
+                        if(!locked[a]) collapses.push_back({a, b, evaluateCollapse(quadrics[a], quadrics[b], position(positions, stride, b))});
+                        if(!locked[b]) collapses.push_back({b, a, evaluateCollapse(quadrics[b], quadrics[a], position(positions, stride, a))});
+                    }
+                }
+                if(collapses.empty()) break;
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b){ return a.error < b.error; });
+                const float errorLimit = collapses[std::min<size_t>(triangleCount - targetTriangles, collapses.size() - 1)].error;       // every directed edge is listed twice and removes two triangles; costlier collapses wait for a pass with fresh neighbourhoods
+
+                touched.assign(vertexCount, false);
+                std::iota(remap.begin(), remap.end(), 0);
+                uint32_t removed = 0;
+                for(const auto& collapse : collapses)
+                {
+                    if(triangleCount - removed <= targetTriangles || collapse.error > errorLimit) break;
+                    if(touched[collapse.from] || touched[collapse.to]) continue;
+                    bool valid = true;
+                    uint32_t collapsed = 0;
+                    for(uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && valid; ++i)
+                    {
+                        const uint32_t* corners = &current[3 * adjacency[i]];
+                        if(corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+                        {
+                            ++collapsed;
+                            continue;
+                        }
+                        const float* moved[3];
+                        for(uint32_t corner = 0; corner < 3; ++corner)
+                        {
+                            moved[corner] = position(positions, stride, (corners[corner] == collapse.from) ? collapse.to : corners[corner]);
+                        }
+                        double before[3], after[3];
+                        triangleNormal(position(positions, stride, corners[0]), position(positions, stride, corners[1]), position(positions, stride, corners[2]), before);
+                        triangleNormal(moved[0], moved[1], moved[2], after);
+                        const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                        const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+                        valid = dot > 0.25 * lengths;                                   // rejects flipped and sharply folded triangles
+                    }
+                    if(!valid) continue;
+
+                    for(uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; ++i)
+                    {
+                        for(uint32_t corner = 0; corner < 3; ++corner)
+                        {
+                            touched[current[3 * adjacency[i] + corner]] = true;
+                        }
+                    }
+                    remap[collapse.from] = collapse.to;
+                    addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+                    result.error = std::max(result.error, collapse.error);
+                    removed += collapsed;
+                }
+                if(removed == 0) break;
+
+                uint32_t kept = 0;
+                for(uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+                {
+                    const uint32_t a = remap[current[3 * triangle]], b = remap[current[3 * triangle + 1]], c = remap[current[3 * triangle + 2]];
+                    if(a == b || b == c || a == c) continue;
+                    current[3 * kept] = a;
+                    current[3 * kept + 1] = b;
+                    current[3 * kept + 2] = c;
+                    ++kept;
+                }
+                current.resize(3 * kept);
+            }
+            return result;
+        }
+
+        std::vector<LevelOfDetail> generateLevelsOfDetail(const std::vector<uint32_t>& indices, const char* positions, const uint32_t stride, const uint32_t vertexCount, const uint32_t maxLevelCount, const float reduction, const uint32_t cacheSize)
+        {
+            std::vector<LevelOfDetail> levels;
+            for(uint32_t level = 0; level < maxLevelCount; ++level)                     // every level starts from the previous one, so its error adds up
+            {
+                const std::vector<uint32_t>& source = levels.empty() ? indices : levels.back().indices;
+                const uint32_t targetIndexCount = uint32_t(source.size() / 3 * reduction) * 3;
+                if(targetIndexCount == 0) break;
+                LevelOfDetail simplified = simplifyMesh(source, positions, stride, vertexCount, targetIndexCount);
+                if(simplified.indices.size() > source.size() * 0.9) break;              // mostly locked vertices left
+                if(!levels.empty()) simplified.error += levels.back().error;
+                optimizeVertexCache(simplified.indices, vertexCount, cacheSize);
+                levels.push_back(std::move(simplified));
+            }
+            return levels;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,422 @@
+#include"../include/Model.hpp"
+#include"../include/Tracing.hpp"
+#include<assimp/Importer.hpp>
+#include<assimp/scene.h>
+#include<assimp/postprocess.h>
+#include<algorithm>
+#include<cmath>
+#include<cstddef>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+namespace spk
+{
+    namespace
+    {
+        const char modelCacheMagic[8] = {'S', 'P', 'K', 'M', 'O', 'D', 'E', 'L'};
+        const uint32_t modelCacheVersion = 2;
+        const uint64_t modelCacheAlignment = 16;                                        // every blob starts aligned, so it is read in place from the mapping
+
+        struct CacheHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t vertexSize;
+            uint64_t sourceSize;                                                        // the cache is stale once the model file changes
+            int64_t sourceTime;
+            uint32_t optimized;                                                         // import options the content depends on
+            uint32_t levelsOfDetail;
+            uint32_t meshCount;
+            uint32_t materialCount;
+        };
+
+        struct CacheMesh
+        {
+            uint64_t vertexOffset;                                                      // from the start of the file
+            uint64_t indexOffset;
+            uint64_t levelOffset;                                                       // levelCount CacheLevels
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t materialIndex;
+            uint32_t levelCount;
+            float bounds[4];
+        };
+
+        struct CacheLevel
+        {
+            uint64_t indexOffset;
+            uint32_t indexCount;
+            float error;
+        };
+
+        struct CacheMaterial
+        {
+            uint64_t nameOffset;                                                        // diffuse texture followed by normal texture
+            uint32_t diffuseLength;
+            uint32_t normalLength;
+        };
+
+        class MappedFile
+        {
+        public:
+            MappedFile(const std::string& filename): data(nullptr), size(0)
+            {
+                const int descriptor = open(filename.c_str(), O_RDONLY);
+                if(descriptor < 0) return;
+                struct stat status;
+                if(fstat(descriptor, &status) == 0 && status.st_size > 0)
+                {
+                    void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                    if(mapping != MAP_FAILED)
+                    {
+                        madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+                        data = static_cast<const char*>(mapping);
+                        size = status.st_size;
+                    }
+                }
+                close(descriptor);
+            }
+            ~MappedFile()
+            {
+                if(data != nullptr) munmap(const_cast<char*>(data), size);
+            }
+            const char* data;
+            size_t size;
+        };
+
+        bool blobInRange(const uint64_t offset, const uint64_t count, const uint64_t elementSize, const uint64_t alignment, const uint64_t size)    // written so that no corrupt value can wrap around
+        {
+            if(offset > size || offset % alignment != 0) return false;                  // the mapping is page aligned, so aligned offsets give aligned pointers
+            return count <= (size - offset) / elementSize;
+        }
+
+        bool getSourceIdentity(const std::string& filename, uint64_t& size, int64_t& time)
+        {
+            std::error_code error;
+            size = std::filesystem::file_size(filename, error);
+            if(error) return false;
+            time = std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+            return !error;
+        }
+
+        uint64_t alignCacheOffset(const uint64_t offset)
+        {
+            return (offset + modelCacheAlignment - 1) / modelCacheAlignment * modelCacheAlignment;
+        }
+    }
+
+    Model::Model(): loadedFromCache(false){}
+
+    Model::Model(const std::string& filename, const ModelImportOptions& options): loadedFromCache(false)
+    {
+        load(filename, options);
+    }
+
+    void Model::load(const std::string& filename, const ModelImportOptions& options)
+    {
+        SPARK_TRACE_SCOPE("Model::load");
+        vertexBuffers.clear();
+        materialIndices.clear();
+        materials.clear();
+        optimizationReports.clear();
+        alignmentInfo.create({{0, sizeof(ModelVertex), {
+            {0, FieldFormat::vec3f, offsetof(ModelVertex, position)},
+            {1, FieldFormat::vec3f, offsetof(ModelVertex, normal)},
+            {2, FieldFormat::vec2f, offsetof(ModelVertex, uv)}}}});
+
+        const std::string cacheFilename = filename + ".spkmodel";
+        loadedFromCache = options.useCache && loadCache(cacheFilename, filename, options);
+        if(loadedFromCache) return;
+
+        std::vector<ImportedMesh> meshes;
+        import(filename, options, meshes);
+        for(const auto& mesh : meshes)
+        {
+            addMesh(mesh.vertices.data(), mesh.vertices.size() / sizeof(ModelVertex), mesh.indices.data(), mesh.indices.size(), mesh.materialIndex, mesh.bounds, mesh.levels);
+        }
+        if(options.useCache) writeCache(cacheFilename, filename, options, meshes);
+    }
+
+    bool Model::loadCache(const std::string& cacheFilename, const std::string& filename, const ModelImportOptions& options)
+    {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        if(!getSourceIdentity(filename, sourceSize, sourceTime)) return false;
+        const MappedFile cache(cacheFilename);
+        if(cache.data == nullptr || cache.size < sizeof(CacheHeader)) return false;
+
+        CacheHeader header;
+        std::memcpy(&header, cache.data, sizeof(header));
+        if(std::memcmp(header.magic, modelCacheMagic, sizeof(modelCacheMagic)) != 0 || header.version != modelCacheVersion || header.vertexSize != sizeof(ModelVertex)) return false;
+        if(header.sourceSize != sourceSize || header.sourceTime != sourceTime || header.optimized != options.optimize || header.levelsOfDetail != options.levelsOfDetail) return false;
+        if(!blobInRange(sizeof(CacheHeader), header.meshCount, sizeof(CacheMesh), alignof(CacheMesh), cache.size)) return false;
+        const uint64_t materialTableOffset = sizeof(CacheHeader) + uint64_t(header.meshCount) * sizeof(CacheMesh);
+        if(!blobInRange(materialTableOffset, header.materialCount, sizeof(CacheMaterial), alignof(CacheMaterial), cache.size)) return false;
+
+        auto indicesInRange = [&cache](const uint64_t offset, const uint32_t count, const uint32_t vertexCount)
+        {
+            const uint32_t* indices = reinterpret_cast<const uint32_t*>(cache.data + offset);
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                if(indices[i] >= vertexCount) return false;
+            }
+            return true;
+        };
+        const CacheMesh* meshTable = reinterpret_cast<const CacheMesh*>(cache.data + sizeof(CacheHeader));
+        const CacheMaterial* materialTable = reinterpret_cast<const CacheMaterial*>(cache.data + materialTableOffset);
+        for(uint32_t i = 0; i < header.meshCount; ++i)                                 // validated before anything is created, a truncated or corrupt cache is simply rebuilt
+        {
+            const CacheMesh& mesh = meshTable[i];
+            if(!blobInRange(mesh.vertexOffset, mesh.vertexCount, sizeof(ModelVertex), alignof(ModelVertex), cache.size)) return false;
+            if(!blobInRange(mesh.indexOffset, mesh.indexCount, sizeof(uint32_t), alignof(uint32_t), cache.size)) return false;
+            if(!indicesInRange(mesh.indexOffset, mesh.indexCount, mesh.vertexCount)) return false;      // a corrupt index would fetch past the vertex buffer on the GPU
+            if(mesh.materialIndex >= header.materialCount && header.materialCount != 0) return false;
+            if(!blobInRange(mesh.levelOffset, mesh.levelCount, sizeof(CacheLevel), alignof(CacheLevel), cache.size)) return false;
+            const CacheLevel* levels = reinterpret_cast<const CacheLevel*>(cache.data + mesh.levelOffset);
+            for(uint32_t level = 0; level < mesh.levelCount; ++level)
+            {
+                if(!blobInRange(levels[level].indexOffset, levels[level].indexCount, sizeof(uint32_t), alignof(uint32_t), cache.size)) return false;
+                if(!indicesInRange(levels[level].indexOffset, levels[level].indexCount, mesh.vertexCount)) return false;
+            }
+        }
+        for(uint32_t i = 0; i < header.materialCount; ++i)
+        {
+            const CacheMaterial& material = materialTable[i];
+            if(!blobInRange(material.nameOffset, uint64_t(material.diffuseLength) + material.normalLength, 1, 1, cache.size)) return false;
+        }
+
+        for(uint32_t i = 0; i < header.materialCount; ++i)
+        {
+            const char* names = cache.data + materialTable[i].nameOffset;
+            materials.push_back({std::string(names, materialTable[i].diffuseLength), std::string(names + materialTable[i].diffuseLength, materialTable[i].normalLength)});
+        }
+        for(uint32_t i = 0; i < header.meshCount; ++i)                                 // the staging copies read straight from the mapped pages
+        {
+            const CacheMesh& mesh = meshTable[i];
+            const CacheLevel* levelTable = reinterpret_cast<const CacheLevel*>(cache.data + mesh.levelOffset);
+            std::vector<utils::LevelOfDetail> levels(mesh.levelCount);
+            for(uint32_t level = 0; level < mesh.levelCount; ++level)
+            {
+                const uint32_t* indices = reinterpret_cast<const uint32_t*>(cache.data + levelTable[level].indexOffset);
+                levels[level].indices.assign(indices, indices + levelTable[level].indexCount);
+                levels[level].error = levelTable[level].error;
+            }
+            const BoundingSphere bounds = {{mesh.bounds[0], mesh.bounds[1], mesh.bounds[2]}, mesh.bounds[3]};
+            addMesh(cache.data + mesh.vertexOffset, mesh.vertexCount, reinterpret_cast<const uint32_t*>(cache.data + mesh.indexOffset), mesh.indexCount, mesh.materialIndex, bounds, levels);
+        }
+        return true;
+    }
+
+    void Model::import(const std::string& filename, const ModelImportOptions& options, std::vector<ImportedMesh>& meshes)
+    {
+        SPARK_TRACE_SCOPE("Model::import");
+        Assimp::Importer importer;
+        importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+        unsigned int flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals | aiProcess_SortByPType | aiProcess_PreTransformVertices;
+        if(options.flipUVs) flags |= aiProcess_FlipUVs;
+        const aiScene* scene = importer.ReadFile(filename, flags);
+        if(scene == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) throw std::runtime_error("Failed to import model " + filename + ": " + importer.GetErrorString() + "\n");
+
+        const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+        auto getTexture = [&directory](const aiMaterial* material, const aiTextureType type)
+        {
+            aiString path;
+            if(material->GetTexture(type, 0, &path) != aiReturn_SUCCESS) return std::string();
+            if(path.C_Str()[0] == '*') return std::string(path.C_Str());
+            return (directory / path.C_Str()).string();
+        };
+        for(uint32_t i = 0; i < scene->mNumMaterials; ++i)
+        {
+            const aiMaterial* material = scene->mMaterials[i];
+            std::string normalTexture = getTexture(material, aiTextureType_NORMALS);
+            if(normalTexture.empty()) normalTexture = getTexture(material, aiTextureType_HEIGHT);              // OBJ files keep normal maps as bump maps
+            materials.push_back({getTexture(material, aiTextureType_DIFFUSE), normalTexture});
+        }
+
+        for(uint32_t i = 0; i < scene->mNumMeshes; ++i)
+        {
+            const aiMesh* source = scene->mMeshes[i];
+            if(!(source->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) || source->mNumVertices == 0) continue;
+            meshes.push_back(ImportedMesh());
+            ImportedMesh& mesh = meshes.back();
+            mesh.materialIndex = source->mMaterialIndex;
+            mesh.vertices.resize(size_t(source->mNumVertices) * sizeof(ModelVertex));
+            ModelVertex* vertices = reinterpret_cast<ModelVertex*>(mesh.vertices.data());
+            for(uint32_t v = 0; v < source->mNumVertices; ++v)
+            {
+                ModelVertex& vertex = vertices[v];
+                vertex.position[0] = source->mVertices[v].x;
+                vertex.position[1] = source->mVertices[v].y;
+                vertex.position[2] = source->mVertices[v].z;
+                const aiVector3D normal = source->HasNormals() ? source->mNormals[v] : aiVector3D(0, 0, 0);
+                vertex.normal[0] = normal.x;
+                vertex.normal[1] = normal.y;
+                vertex.normal[2] = normal.z;
+                const aiVector3D uv = source->HasTextureCoords(0) ? source->mTextureCoords[0][v] : aiVector3D(0, 0, 0);
+                vertex.uv[0] = uv.x;
+                vertex.uv[1] = uv.y;
+            }
+            mesh.indices.reserve(size_t(source->mNumFaces) * 3);
+            for(uint32_t f = 0; f < source->mNumFaces; ++f)
+            {
+                if(source->mFaces[f].mNumIndices != 3) continue;
+                mesh.indices.insert(mesh.indices.end(), source->mFaces[f].mIndices, source->mFaces[f].mIndices + 3);
+            }
+            if(mesh.indices.empty())
+            {
+                meshes.pop_back();
+                continue;
+            }
+            if(options.optimize) optimizationReports.push_back(utils::optimizeMesh(mesh.vertices, sizeof(ModelVertex), mesh.indices, offsetof(ModelVertex, position)));
+
+            const uint32_t vertexCount = mesh.vertices.size() / sizeof(ModelVertex);
+            vertices = reinterpret_cast<ModelVertex*>(mesh.vertices.data());
+            float minimum[3] = {vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]}, maximum[3] = {minimum[0], minimum[1], minimum[2]};
+            for(uint32_t v = 1; v < vertexCount; ++v)
+            {
+                for(uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    minimum[axis] = std::min(minimum[axis], vertices[v].position[axis]);
+                    maximum[axis] = std::max(maximum[axis], vertices[v].position[axis]);
+                }
+            }
+            mesh.bounds = {{(minimum[0] + maximum[0]) / 2, (minimum[1] + maximum[1]) / 2, (minimum[2] + maximum[2]) / 2}, 0};
+            for(uint32_t v = 0; v < vertexCount; ++v)
+            {
+                const float offset[3] = {vertices[v].position[0] - mesh.bounds.center[0], vertices[v].position[1] - mesh.bounds.center[1], vertices[v].position[2] - mesh.bounds.center[2]};
+                mesh.bounds.radius = std::max(mesh.bounds.radius, std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]));
+            }
+            if(options.levelsOfDetail > 0 && !mesh.indices.empty()) mesh.levels = utils::generateLevelsOfDetail(mesh.indices, mesh.vertices.data() + offsetof(ModelVertex, position), sizeof(ModelVertex), vertexCount, options.levelsOfDetail);
+        }
+    }
+
+    void Model::writeCache(const std::string& cacheFilename, const std::string& filename, const ModelImportOptions& options, const std::vector<ImportedMesh>& meshes) const
+    {
+        SPARK_TRACE_SCOPE("Model::writeCache");
+        CacheHeader header;
+        std::memcpy(header.magic, modelCacheMagic, sizeof(modelCacheMagic));
+        header.version = modelCacheVersion;
+        header.vertexSize = sizeof(ModelVertex);
+        header.optimized = options.optimize;
+        header.levelsOfDetail = options.levelsOfDetail;
+        if(!getSourceIdentity(filename, header.sourceSize, header.sourceTime)) return;
+        header.meshCount = meshes.size();
+        header.materialCount = materials.size();
+
+        std::vector<CacheMaterial> materialTable(materials.size());
+        uint64_t offset = sizeof(CacheHeader) + meshes.size() * sizeof(CacheMesh) + materials.size() * sizeof(CacheMaterial);
+        for(uint32_t i = 0; i < materials.size(); ++i)
+        {
+            materialTable[i] = {offset, uint32_t(materials[i].diffuseTexture.size()), uint32_t(materials[i].normalTexture.size())};
+            offset += materials[i].diffuseTexture.size() + materials[i].normalTexture.size();
+        }
+        std::vector<CacheMesh> meshTable(meshes.size());
+        std::vector<std::vector<CacheLevel> > levelTables(meshes.size());
+        for(uint32_t i = 0; i < meshes.size(); ++i)
+        {
+            const ImportedMesh& mesh = meshes[i];
+            meshTable[i].vertexOffset = offset = alignCacheOffset(offset);
+            offset += mesh.vertices.size();
+            meshTable[i].indexOffset = offset = alignCacheOffset(offset);
+            offset += mesh.indices.size() * sizeof(uint32_t);
+            meshTable[i].levelOffset = offset = alignCacheOffset(offset);
+            offset += mesh.levels.size() * sizeof(CacheLevel);
+            for(const auto& level : mesh.levels)
+            {
+                levelTables[i].push_back({offset = alignCacheOffset(offset), uint32_t(level.indices.size()), level.error});
+                offset += level.indices.size() * sizeof(uint32_t);
+            }
+            meshTable[i].vertexCount = mesh.vertices.size() / sizeof(ModelVertex);
+            meshTable[i].indexCount = mesh.indices.size();
+            meshTable[i].materialIndex = mesh.materialIndex;
+            meshTable[i].levelCount = mesh.levels.size();
+            std::copy(mesh.bounds.center, mesh.bounds.center + 3, meshTable[i].bounds);
+            meshTable[i].bounds[3] = mesh.bounds.radius;
+        }
+
+        const std::string temporaryFilename = cacheFilename + ".tmp";                  // renamed once complete, so a crash never leaves a truncated cache behind
+        {
+            std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+            if(!file.is_open()) return;                                                 // the model is loaded anyway, it is just parsed again next time
+            const char padding[modelCacheAlignment] = {};
+            uint64_t written = 0;
+            auto write = [&file, &written, &padding](const void* data, const uint64_t size, const uint64_t at)
+            {
+                file.write(padding, at - written);
+                file.write(static_cast<const char*>(data), size);
+                written = at + size;
+            };
+            write(&header, sizeof(header), 0);
+            write(meshTable.data(), meshTable.size() * sizeof(CacheMesh), written);
+            write(materialTable.data(), materialTable.size() * sizeof(CacheMaterial), written);
+            for(const auto& material : materials)
+            {
+                write(material.diffuseTexture.data(), material.diffuseTexture.size(), written);
+                write(material.normalTexture.data(), material.normalTexture.size(), written);
+            }
+            for(uint32_t i = 0; i < meshes.size(); ++i)
+            {
+                write(meshes[i].vertices.data(), meshes[i].vertices.size(), meshTable[i].vertexOffset);
+                write(meshes[i].indices.data(), meshes[i].indices.size() * sizeof(uint32_t), meshTable[i].indexOffset);
+                write(levelTables[i].data(), levelTables[i].size() * sizeof(CacheLevel), meshTable[i].levelOffset);
+                for(uint32_t level = 0; level < levelTables[i].size(); ++level)
+                {
+                    write(meshes[i].levels[level].indices.data(), meshes[i].levels[level].indices.size() * sizeof(uint32_t), levelTables[i][level].indexOffset);
+                }
+            }
+            if(!file.good()) return;
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryFilename, cacheFilename, error);
+    }
+
+    void Model::addMesh(const void* vertices, const uint32_t vertexCount, const uint32_t* indices, const uint32_t indexCount, const uint32_t materialIndex, const BoundingSphere& bounds, const std::vector<utils::LevelOfDetail>& levels)
+    {
+        vertexBuffers.emplace_back(new VertexBuffer({0}, {uint32_t(vertexCount * sizeof(ModelVertex))}, indexCount * sizeof(uint32_t), IndexType::automatic));
+        vertexBuffers.back()->updateVertexBuffer(vertices, 0);
+        vertexBuffers.back()->setBounds(bounds);
+        if(indexCount != 0) vertexBuffers.back()->updateIndexBuffer(indices);
+        if(indexCount != 0 && !levels.empty()) vertexBuffers.back()->setLevelsOfDetail(levels);
+        materialIndices.push_back(materialIndex);
+    }
+
+    const uint32_t Model::getMeshCount() const
+    {
+        return vertexBuffers.size();
+    }
+
+    VertexBuffer* Model::getVertexBuffer(const uint32_t mesh)
+    {
+        return vertexBuffers.at(mesh).get();
+    }
+
+    const uint32_t Model::getMaterialIndex(const uint32_t mesh) const
+    {
+        return materialIndices.at(mesh);
+    }
+
+    const std::vector<ModelMaterial>& Model::getMaterials() const
+    {
+        return materials;
+    }
+
+    const VertexAlignmentInfo& Model::getAlignmentInfo() const
+    {
+        return alignmentInfo;
+    }
+
+    const bool Model::isLoadedFromCache() const
+    {
+        return loadedFromCache;
+    }
+
+    const std::vector<utils::MeshOptimizationReport>& Model::getOptimizationReports() const
+    {
+        return optimizationReports;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include"../include/OffscreenTarget.hpp"
+#include"../include/System.hpp"
+
+namespace spk
+{
+
+    OffscreenTarget::OffscreenTarget(){}
+
+    OffscreenTarget::OffscreenTarget(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions)
+    {
+        create(cWidth, cHeight, cOptions);
+    }
+
+    void OffscreenTarget::create(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions)
+    {
+        init(cWidth, cHeight, cOptions);
+        nextImage = 0;
+        uint32_t count = (options.minImageCount == 0) ? 3 : options.minImageCount;
+        if(count < framesInFlight) count = framesInFlight;                              // every frame in flight needs its own image
+        createColorImages(count);
+
+        std::vector<vk::ImageView> views;
+        for(const auto& view : colorImageViews)
+        {
+            views.push_back(view.getView());
+        }
+        createTarget(colorImageFormat, vk::ImageLayout::eTransferSrcOptimal, views, count);
+    }
+
+    const uint32_t OffscreenTarget::getImageCount() const
+    {
+        return imageCount;
+    }
+
+    void OffscreenTarget::createColorImages(const uint32_t count)
+    {
+        std::vector<vk::Format> formats = {vk::Format::eR8G8B8A8Unorm, vk::Format::eB8G8R8A8Unorm};
+        std::optional<vk::Format> format = utils::Image::getSupportedFormat(formats, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eColorAttachment);
+        if(!format.has_value()) throw std::runtime_error("Failed to pick format!\n");
+        colorImageFormat = format.value();
+
+        colorImages.resize(count);                                                      // resized once: utils::Image must not be copied
+        colorImageViews.resize(count);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            colorImages[i].create({width, height, 1}, colorImageFormat, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::ImageAspectFlagBits::eColor);
+            colorImages[i].bindMemory();
+            colorImageViews[i].create(colorImages[i].getImage(), colorImageFormat, colorImages[i].getSubresource());
+        }
+    }
+
+    vk::Semaphore OffscreenTarget::acquireImage(const uint32_t frame, uint32_t& imageIndex)
+    {
+        imageIndex = nextImage;
+        nextImage = (nextImage + 1) % imageCount;
+        return vk::Semaphore();
+    }
+
+    vk::Semaphore OffscreenTarget::getRenderFinishedSemaphore(const uint32_t frame) const
+    {
+        return vk::Semaphore();
+    }
+
+    void OffscreenTarget::present(const uint32_t frame, const uint32_t imageIndex){}
+
+    const vk::Image& OffscreenTarget::getColorImage(const uint32_t imageIndex) const
+    {
+        return colorImages[imageIndex].getImage();
+    }
+
+    void OffscreenTarget::destroy()
+    {
+        if(colorImages.size() != 0)
+        {
+            destroyTarget();
+            for(auto& view : colorImageViews)
+            {
+                view.destroy();
+            }
+            for(auto& image : colorImages)
+            {
+                image.destroy();
+            }
+            colorImageViews.clear();
+            colorImages.clear();
+        }
+    }
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        destroy();
+    }
+
+}
\ No newline at end of file
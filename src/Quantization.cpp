@@ -0,0 +1,230 @@
+#include"../include/Quantization.hpp"
+#include<algorithm>
+#include<cmath>
+#include<cstring>
+#if defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+
+namespace spk
+{
+    namespace utils
+    {
+        namespace
+        {
+            uint16_t halfFromFloat(const float value)                                   // rounds to nearest even, NaNs stay NaNs
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                const uint32_t sign = bits & 0x80000000u;
+                bits ^= sign;
+                uint16_t result;
+                if(bits >= (127u + 16u) << 23)                                          // too large for a half, infinity or NaN
+                {
+                    result = (bits > 0x7F800000u) ? 0x7E00 : 0x7C00;
+                }
+                else if(bits < (127u - 14u) << 23)                                      // subnormal half; the float addition does the rounding
+                {
+                    const uint32_t magicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+                    float magic, subnormal;
+                    std::memcpy(&magic, &magicBits, sizeof(magic));
+                    std::memcpy(&subnormal, &bits, sizeof(subnormal));
+                    subnormal += magic;
+                    std::memcpy(&bits, &subnormal, sizeof(bits));
+                    result = bits - magicBits;
+                }
+                else
+                {
+                    const uint32_t mantissaOdd = (bits >> 13) & 1;
+                    bits += ((15u - 127u) << 23) + 0xFFF + mantissaOdd;
+                    result = bits >> 13;
+                }
+                return result | (sign >> 16);
+            }
+
+            int32_t quantize(const float value, const float low, const float scale)
+            {
+                return static_cast<int32_t>(std::nearbyint(std::min(std::max(value, low), 1.0f) * scale));
+            }
+
+            void octahedral(const float x, const float y, const float z, float& u, float& v)
+            {
+                const float length = std::max(std::fabs(x) + std::fabs(y) + std::fabs(z), 1e-20f);
+                u = x / length;
+                v = y / length;
+                if(z < 0)
+                {
+                    const float wrappedU = (1.0f - std::fabs(v)) * std::copysign(1.0f, u);
+                    v = (1.0f - std::fabs(u)) * std::copysign(1.0f, v);
+                    u = wrappedU;
+                }
+            }
+
+#if defined(__SSE2__)
+            __m128i quantize(const __m128 values, const __m128 low, const __m128 scale)
+            {
+                return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(values, low), _mm_set1_ps(1.0f)), scale));
+            }
+
+            __m128i halfFromFloat(const __m128 values)                                  // four halves, sign-extended to 32 bits
+            {
+                const __m128 sign = _mm_and_ps(values, _mm_set1_ps(-0.0f));
+                const __m128 absolute = _mm_xor_ps(values, sign);
+                const __m128i bits = _mm_castps_si128(absolute);
+                const __m128i magicBits = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+                const __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+                const __m128i isFinite = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+                const __m128i special = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+                const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+                const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(magicBits))), magicBits);
+
+                const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);     // -1 if the half mantissa is odd
+                const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(0xFFF - ((127 - 15) << 23))), mantissaOdd), 13);
+
+                const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+                const __m128i result = _mm_or_si128(_mm_and_si128(isFinite, finite), _mm_andnot_si128(isFinite, special));
+                return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+            }
+#endif
+        }
+
+        void quantizeHalf(const float* src, uint16_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            for(; i + 8 <= count; i += 8)
+            {
+                const __m128i low = halfFromFloat(_mm_loadu_ps(src + i));
+                const __m128i high = halfFromFloat(_mm_loadu_ps(src + i + 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(low, high));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                dst[i] = halfFromFloat(src[i]);
+            }
+        }
+
+        void quantizeSnorm16(const float* src, int16_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128 low = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+            for(; i + 8 <= count; i += 8)
+            {
+                const __m128i first = quantize(_mm_loadu_ps(src + i), low, scale);
+                const __m128i second = quantize(_mm_loadu_ps(src + i + 4), low, scale);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(first, second));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                dst[i] = quantize(src[i], -1.0f, 32767.0f);
+            }
+        }
+
+        void quantizeUnorm16(const float* src, uint16_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128 low = _mm_setzero_ps(), scale = _mm_set1_ps(65535.0f);
+            const __m128i bias = _mm_set1_epi32(32768);
+            for(; i + 8 <= count; i += 8)                                               // SSE2 only packs signed, so the values are biased into the int16 range and back
+            {
+                const __m128i first = _mm_sub_epi32(quantize(_mm_loadu_ps(src + i), low, scale), bias);
+                const __m128i second = _mm_sub_epi32(quantize(_mm_loadu_ps(src + i + 4), low, scale), bias);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(_mm_packs_epi32(first, second), _mm_set1_epi16(-0x8000)));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                dst[i] = quantize(src[i], 0.0f, 65535.0f);
+            }
+        }
+
+        void quantizeSnorm8(const float* src, int8_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128 low = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(127.0f);
+            for(; i + 16 <= count; i += 16)
+            {
+                const __m128i first = _mm_packs_epi32(quantize(_mm_loadu_ps(src + i), low, scale), quantize(_mm_loadu_ps(src + i + 4), low, scale));
+                const __m128i second = _mm_packs_epi32(quantize(_mm_loadu_ps(src + i + 8), low, scale), quantize(_mm_loadu_ps(src + i + 12), low, scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi16(first, second));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                dst[i] = quantize(src[i], -1.0f, 127.0f);
+            }
+        }
+
+        void quantizeUnorm8(const float* src, uint8_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128 low = _mm_setzero_ps(), scale = _mm_set1_ps(255.0f);
+            for(; i + 16 <= count; i += 16)
+            {
+                const __m128i first = _mm_packs_epi32(quantize(_mm_loadu_ps(src + i), low, scale), quantize(_mm_loadu_ps(src + i + 4), low, scale));
+                const __m128i second = _mm_packs_epi32(quantize(_mm_loadu_ps(src + i + 8), low, scale), quantize(_mm_loadu_ps(src + i + 12), low, scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(first, second));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                dst[i] = quantize(src[i], 0.0f, 255.0f);
+            }
+        }
+
+        void packSnorm1010102(const float* src, uint32_t* dst, const size_t count)
+        {
+            for(size_t i = 0; i < count; ++i)
+            {
+                const float* vector = src + 4 * i;
+                dst[i] = (uint32_t(quantize(vector[0], -1.0f, 511.0f)) & 0x3FF)
+                    | ((uint32_t(quantize(vector[1], -1.0f, 511.0f)) & 0x3FF) << 10)
+                    | ((uint32_t(quantize(vector[2], -1.0f, 511.0f)) & 0x3FF) << 20)
+                    | (uint32_t(quantize(vector[3], -1.0f, 1.0f)) << 30);
+            }
+        }
+
+        void packOctahedral(const float* normals, int16_t* dst, const size_t count)
+        {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128 signMask = _mm_set1_ps(-0.0f), one = _mm_set1_ps(1.0f);
+            for(; i + 4 <= count; i += 4)
+            {
+                const float* source = normals + 3 * i;
+                const __m128 a = _mm_loadu_ps(source), b = _mm_loadu_ps(source + 4), c = _mm_loadu_ps(source + 8);     // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+                const __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+                const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+
+                const __m128 length = _mm_max_ps(_mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z)), _mm_set1_ps(1e-20f));
+                const __m128 u = _mm_div_ps(x, length), v = _mm_div_ps(y, length);
+                const __m128 wrappedU = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, v)), _mm_or_ps(_mm_and_ps(u, signMask), one));
+                const __m128 wrappedV = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, u)), _mm_or_ps(_mm_and_ps(v, signMask), one));
+                const __m128 lowerHemisphere = _mm_cmplt_ps(z, _mm_setzero_ps());
+                const __m128 resultU = _mm_or_ps(_mm_and_ps(lowerHemisphere, wrappedU), _mm_andnot_ps(lowerHemisphere, u));
+                const __m128 resultV = _mm_or_ps(_mm_and_ps(lowerHemisphere, wrappedV), _mm_andnot_ps(lowerHemisphere, v));
+
+                const __m128 low = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+                const __m128i quantizedU = quantize(resultU, low, scale), quantizedV = quantize(resultV, low, scale);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_packs_epi32(_mm_unpacklo_epi32(quantizedU, quantizedV), _mm_unpackhi_epi32(quantizedU, quantizedV)));
+            }
+#endif
+            for(; i < count; ++i)
+            {
+                float u, v;
+                octahedral(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2], u, v);
+                dst[2 * i] = quantize(u, -1.0f, 32767.0f);
+                dst[2 * i + 1] = quantize(v, -1.0f, 32767.0f);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,1414 @@
+#include"../include/RenderTarget.hpp"
+#include"../include/GPUProfiler.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
+#include"../include/System.hpp"
+#include"../include/LayoutCache.hpp"
+#include"../include/SamplerCache.hpp"
+
+namespace spk
+{
+
+    RenderTarget::RenderTarget(){}
+
+    void RenderTarget::init(const uint32_t cWidth, const uint32_t cHeight, const DrawOptions cOptions)
+    {
+        currentPipeline = {~uint32_t(0), ~uint32_t(0), ~uint32_t(0)};
+        currentResources = ~uint32_t(0);
+        currentDrawCommands = nullptr;
+        currentCulling = nullptr;
+        currentDrawCount = 0;
+        levelOfDetailViewSet = false;
+        levelOfDetailPixelError = 1.0f;
+        cullPipeline = vk::Pipeline();
+        pyramidLevels = 0;
+        drawIndirectCount = system::System::getInstance()->isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) && system::System::getInstance()->getEnabledFeatures().multiDrawIndirect;
+        contentVersion = 0;
+        currentFrame = 0;
+        frameWaited = false;
+        readbackCount = 0;
+        colorReadable = true;
+        drawNumber = 0;
+        gpuTimings = GPUFrameTimings();
+        width = cWidth;
+        height = cHeight;
+        options = cOptions;
+        framesInFlight = (options.maxFramesInFlight == 0) ? 1 : options.maxFramesInFlight;
+    }
+
+    void RenderTarget::createTarget(const vk::Format cColorFormat, const vk::ImageLayout cColorFinalLayout, const std::vector<vk::ImageView>& cColorViews, const uint32_t depthMapCount)
+    {
+        colorFormat = cColorFormat;
+        colorFinalLayout = cColorFinalLayout;
+        imageCount = cColorViews.size();
+        createSyncObjects();
+        createDepthMaps(depthMapCount);
+        createCommandBuffers();
+        createRenderPass();
+        createFramebuffers(cColorViews);
+        if(options.gpuTimings && system::GPUProfiler::getInstance()->isSupported()) createTimestampQueries();
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordTarget(this);
+    }
+
+    const uint32_t RenderTarget::getWidth() const
+    {
+        return width;
+    }
+
+    const uint32_t RenderTarget::getHeight() const
+    {
+        return height;
+    }
+
+    void RenderTarget::setTimingRegion(const std::string& name, const uint32_t firstDraw, const uint32_t drawCount)
+    {
+        if(drawCount == 0) return;
+        timingRegions.push_back({name, firstDraw, drawCount});
+        ++contentVersion;
+    }
+
+    void RenderTarget::clearTimingRegions()
+    {
+        if(timingRegions.size() == 0) return;
+        timingRegions.clear();
+        ++contentVersion;
+    }
+
+    const GPUFrameTimings& RenderTarget::getGPUTimings() const
+    {
+        return gpuTimings;
+    }
+
+    void RenderTarget::draw(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, const ShaderSet* shaders)
+    {
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordDraw(this, resources, alignmentInfo, vertexBuffers, shaders);
+        drawFrame(resources, alignmentInfo, vertexBuffers, nullptr, nullptr, shaders);
+    }
+
+    void RenderTarget::drawIndirect(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, VertexBuffer* geometry, DrawCommandBuffer* drawCommands, const ShaderSet* shaders)
+    {
+        if(geometry->getIndexCount() == 0) throw std::runtime_error("Indirect draws need an index buffer!\n");
+        if(drawCommands->getCopyCount() < framesInFlight) throw std::runtime_error("Draw command buffer has fewer copies than frames in flight!\n");
+        drawFrame(resources, alignmentInfo, {geometry}, drawCommands, nullptr, shaders);
+    }
+
+    void RenderTarget::drawCulled(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, VertexBuffer* geometry, CullingSet* objects, const ShaderSet* shaders)
+    {
+        if(geometry->getIndexCount() == 0) throw std::runtime_error("Culled draws need an index buffer!\n");
+        if(objects->getCopyCount() < framesInFlight) throw std::runtime_error("Culling set has fewer copies than frames in flight!\n");
+        if(!cullPipeline) createCulling();
+        drawFrame(resources, alignmentInfo, {geometry}, nullptr, objects, shaders);
+    }
+
+    void RenderTarget::setLevelOfDetailView(const float* viewProjection, const float pixelError)
+    {
+        levelOfDetailViewSet = (viewProjection != nullptr);
+        if(levelOfDetailViewSet) std::copy(viewProjection, viewProjection + 16, levelOfDetailView);
+        levelOfDetailPixelError = pixelError;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordLevelOfDetailView(this);
+    }
+
+    void RenderTarget::drawFrame(const ResourceSet* resources, const VertexAlignmentInfo* alignmentInfo, const std::vector<VertexBuffer*>& vertexBuffers, DrawCommandBuffer* drawCommands, CullingSet* culling, const ShaderSet* shaders)
+    {
+        SPARK_TRACE_SCOPE("RenderTarget::draw");
+        system::Statistics* statistics = system::Statistics::getInstance();
+        statistics->endFrame();
+        const auto drawStart = std::chrono::steady_clock::now();
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const vk::Queue& graphicsQueue = system::Executives::getInstance()->getGraphicsQueue();
+        if(resources->getCopyCount() < framesInFlight) throw std::runtime_error("Resource set has fewer uniform copies than frames in flight!\n");
+        std::tuple<uint32_t, uint32_t, uint32_t> key = {resources->getLayoutIdentifier(), alignmentInfo->getIdentifier(), shaders->getIdentifier()};      // resource sets with equal layouts share pipelines
+        if(drawComponents.count(key) == 0)
+        {
+            drawComponents[key] = {vk::Pipeline(), alignmentInfo, shaders};
+            createPipeline(drawComponents[key].pipeline, shaders->getShaderStages(), alignmentInfo->getAlignmentInfos(), resources->getPipelineLayout());
+        }
+        uint32_t drawCount = vertexBuffers.size();
+        if(drawCommands != nullptr) drawCount = drawCommands->getDrawCount();
+        if(culling != nullptr) drawCount = culling->getObjectCount();                  // upper bound; the GPU decides how many are drawn
+        std::vector<uint64_t> instancing;
+        std::vector<InstanceBuffer*> instanceBuffers;
+        for(const VertexBuffer* vertexBuffer : vertexBuffers)
+        {
+            instancing.push_back(vertexBuffer->getInstanceCount());
+            instancing.push_back(vertexBuffer->getFirstInstance());
+            for(const auto& alignment : alignmentInfo->getAlignmentInfos())
+            {
+                InstanceBuffer* instances = vertexBuffer->getInstanceBuffer(alignment.binding);
+                instancing.push_back(reinterpret_cast<uintptr_t>(instances));
+                if(instances == nullptr) continue;
+                if(instances->getCopyCount() < framesInFlight) throw std::runtime_error("Instance buffer has fewer copies than frames in flight!\n");
+                instanceBuffers.push_back(instances);
+            }
+        }
+        std::vector<uint64_t> pushConstants;
+        for(const VertexBuffer* vertexBuffer : vertexBuffers)
+        {
+            if(vertexBuffer->getPushConstants().size() > resources->getPushConstantSize()) throw std::runtime_error("Push constants exceed the range of the resource set!\n");
+            pushConstants.push_back(vertexBuffer->getPushConstantVersion());
+        }
+        std::vector<uint64_t> levelsOfDetail;
+        for(const VertexBuffer* vertexBuffer : vertexBuffers)                           // indirect batches draw whatever ranges their commands name
+        {
+            const bool select = levelOfDetailViewSet && drawCommands == nullptr && culling == nullptr && vertexBuffer->getLevelOfDetailCount() > 1;
+            levelsOfDetail.push_back(select ? vertexBuffer->selectLevelOfDetail(levelOfDetailView, height, levelOfDetailPixelError) : 0);
+            levelsOfDetail.push_back(vertexBuffer->getLevelOfDetailVersion());
+        }
+        if(currentPipeline != key || currentResources != resources->getIdentifier() || currentVertexBuffers != vertexBuffers || currentDrawCommands != drawCommands || currentCulling != culling || (!drawIndirectCount && currentDrawCount != drawCount) || currentInstancing != instancing || currentLevelsOfDetail != levelsOfDetail || currentPushConstants != pushConstants)
+        {
+            currentPipeline = key;
+            currentResources = resources->getIdentifier();
+            currentVertexBuffers = vertexBuffers;
+            currentDrawCommands = drawCommands;
+            currentCulling = culling;
+            currentDrawCount = drawCount;
+            currentInstancing = instancing;
+            currentLevelsOfDetail = levelsOfDetail;
+            currentPushConstants = pushConstants;
+            ++contentVersion;                                                           // command buffers are re-recorded lazily, once their frame is no longer in flight
+        }
+
+        waitForFrame();
+        pollReadbacks();
+        collectTimings();
+        system::Executives* executives = system::Executives::getInstance();
+        if(drawCommands != nullptr) executives->claimFrameCopies(drawCommands, this, "Draw command buffer");
+        if(resources->getCopyCount() != ~uint32_t(0)) executives->claimFrameCopies(resources, this, "Resource set with dynamic uniform buffers");
+        if(culling != nullptr) executives->claimFrameCopies(culling, this, "Culling set");
+        for(auto instances : instanceBuffers)
+        {
+            executives->claimFrameCopies(instances, this, "Instance buffer");
+        }
+        if(drawCommands != nullptr) drawCommands->flush(currentFrame);                 // the copy of this frame is no longer read by the GPU
+        resources->flush(currentFrame);
+        if(culling != nullptr) culling->flush(currentFrame);
+        for(auto instances : instanceBuffers)
+        {
+            instances->flush(currentFrame);
+        }
+
+        uint32_t imageIndex;
+        const vk::Semaphore waitSemaphore = acquireImage(currentFrame, imageIndex);
+
+        if(imageFences[imageIndex] && imageFences[imageIndex] != frameFences[currentFrame])
+        {
+            if(statistics->waitForFences(1, &imageFences[imageIndex], ~0ULL) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        }
+        imageFences[imageIndex] = frameFences[currentFrame];
+
+        const uint32_t commandBufferIndex = currentFrame * imageCount + imageIndex;
+        vk::CommandBuffer& commandBuffer = frameCommandBuffers[commandBufferIndex];
+        if(frameCommandBufferVersions[commandBufferIndex] != contentVersion)
+        {
+            commandBuffer.reset(vk::CommandBufferResetFlags());
+            frameCommandCounts[commandBufferIndex] = RecordedCommands();
+            initCommandBuffer(commandBuffer, currentFrame, imageIndex, drawComponents[key], resources, vertexBuffers, drawCommands, culling, frameTimestamps.size() == 0 ? nullptr : &frameTimestamps[commandBufferIndex], frameCommandCounts[commandBufferIndex]);
+            frameCommandBufferVersions[commandBufferIndex] = contentVersion;
+        }
+
+        std::vector<ReadbackSlot*> requestedReadbacks;
+        for(auto& slot : readbackSlots)
+        {
+            if(slot.state == ReadbackState::Requested) requestedReadbacks.push_back(&slot);
+        }
+
+        const vk::Semaphore presentSemaphore = getRenderFinishedSemaphore(currentFrame);
+        const vk::Semaphore signalSemaphore = requestedReadbacks.size() == 0 ? presentSemaphore : vk::Semaphore();      // with readbacks, the last copy signals presentation
+        vk::PipelineStageFlags renderStageFlags = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        vk::SubmitInfo renderSubmit;
+        renderSubmit.setCommandBufferCount(1);
+        renderSubmit.setPCommandBuffers(&commandBuffer);
+        if(signalSemaphore)
+        {
+            renderSubmit.setSignalSemaphoreCount(1);
+            renderSubmit.setPSignalSemaphores(&signalSemaphore);
+        }
+        else
+        {
+            renderSubmit.setSignalSemaphoreCount(0);
+            renderSubmit.setPSignalSemaphores(nullptr);
+        }
+        std::vector<vk::Semaphore> waitSemaphores;
+        std::vector<vk::PipelineStageFlags> waitStages;
+        if(waitSemaphore)
+        {
+            waitSemaphores.push_back(waitSemaphore);
+            waitStages.push_back(renderStageFlags);
+        }
+        system::Executives::getInstance()->takeGraphicsWaits(this, waitSemaphores, waitStages, frameFences[currentFrame]);          // async compute results this target consumes
+        renderSubmit.setWaitSemaphoreCount(waitSemaphores.size());
+        renderSubmit.setPWaitSemaphores(waitSemaphores.data());
+        renderSubmit.setPWaitDstStageMask(waitStages.data());
+
+        if(logicalDevice.resetFences(1, &frameFences[currentFrame]) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
+        if(graphicsQueue.submit(1, &renderSubmit, frameFences[currentFrame]) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
+        system::Executives::getInstance()->addFrameSubmission(frameFences[currentFrame]);
+        statistics->countSubmit();
+        const RecordedCommands& counts = frameCommandCounts[commandBufferIndex];
+        statistics->countCommands(counts.draws, counts.pipelineBinds, counts.descriptorBinds, counts.vertexBufferBinds, counts.indexBufferBinds);
+        ++drawNumber;
+        if(frameTimestamps.size() != 0)
+        {
+            frameSubmittedCommandBuffers[currentFrame] = commandBufferIndex;
+            frameSubmitSerials[currentFrame] = system::GPUProfiler::getInstance()->markSubmit();
+            frameDrawNumbers[currentFrame] = drawNumber;
+            frameSubmitTimes[currentFrame] = SPARK_TRACE_NOW();
+        }
+
+        for(size_t i = 0; i < requestedReadbacks.size(); ++i)
+        {
+            ReadbackSlot& slot = *requestedReadbacks[i];
+            recordReadback(slot, imageIndex);
+            vk::SubmitInfo readbackSubmit;
+            readbackSubmit.setCommandBufferCount(1);
+            readbackSubmit.setPCommandBuffers(&slot.commandBuffer);
+            readbackSubmit.setWaitSemaphoreCount(0);
+            readbackSubmit.setPWaitSemaphores(nullptr);
+            if(i + 1 == requestedReadbacks.size() && presentSemaphore)
+            {
+                readbackSubmit.setSignalSemaphoreCount(1);
+                readbackSubmit.setPSignalSemaphores(&presentSemaphore);
+            }
+            else
+            {
+                readbackSubmit.setSignalSemaphoreCount(0);
+                readbackSubmit.setPSignalSemaphores(nullptr);
+            }
+            if(logicalDevice.resetFences(1, &slot.fence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
+            if(graphicsQueue.submit(1, &readbackSubmit, slot.fence) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
+            statistics->countSubmit();
+            slot.state = ReadbackState::Pending;
+        }
+
+        present(currentFrame, imageIndex);
+
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        frameWaited = false;
+        if(framesInFlight == 1) waitForFrame();                                         // resources may be updated or destroyed as soon as draw returns
+        statistics->countDrawTime(std::chrono::steady_clock::now() - drawStart);
+    }
+
+    void RenderTarget::waitForFrame()
+    {
+        if(frameWaited) return;
+        if(system::Statistics::getInstance()->waitForFences(1, &frameFences[currentFrame], ~0ULL) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        system::Executives::getInstance()->completeFrameSubmission(frameFences[currentFrame]);     // the fence is about to be reset
+        frameWaited = true;
+    }
+
+    void RenderTarget::initCommandBuffer(vk::CommandBuffer& commandBuffer, const uint32_t frame, const uint32_t imageIndex, DrawComponents& drawComponents, const ResourceSet* resources, const std::vector<VertexBuffer*>& vertexBuffers, const DrawCommandBuffer* drawCommands, const CullingSet* culling, utils::TimestampQueries* timestamps, RecordedCommands& counts)
+    {
+        SPARK_TRACE_SCOPE("RenderTarget::initCommandBuffer");
+        vk::CommandBufferBeginInfo beginInfo;
+        if(commandBuffer.begin(&beginInfo) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+        system::Statistics::getInstance()->countCommandBufferRecord();
+
+        uint32_t frameRegion = utils::TimestampQueries::invalidRegion, renderPassRegion = utils::TimestampQueries::invalidRegion;
+        std::vector<uint32_t> userRegions(timingRegions.size(), utils::TimestampQueries::invalidRegion);
+        if(timestamps != nullptr)
+        {
+            timestamps->reset(commandBuffer);
+            frameRegion = timestamps->begin(commandBuffer, "frame");                  // region 0, reported as GPUFrameTimings::milliseconds
+        }
+        if(culling != nullptr)
+        {
+            const uint32_t cullRegion = (timestamps == nullptr) ? utils::TimestampQueries::invalidRegion : timestamps->begin(commandBuffer, "culling");
+            recordCulling(commandBuffer, frame, culling, counts);
+            if(timestamps != nullptr) timestamps->end(commandBuffer, cullRegion);
+        }
+        if(timestamps != nullptr) renderPassRegion = timestamps->begin(commandBuffer, "render pass");
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, drawComponents.pipeline);
+        ++counts.pipelineBinds;
+
+        vk::ClearValue clearValues[2];
+        vk::ClearColorValue clearColorValue;
+        vk::ClearDepthStencilValue clearDSValue;
+        clearColorValue.setUint32({0, 0, 0, 0});
+        clearValues[0].setColor(clearColorValue);
+        clearDSValue.setDepth(1.0f);
+        clearDSValue.setStencil(0);
+        clearValues[1].setDepthStencil(clearDSValue);
+
+        vk::RenderPassBeginInfo renderPassInfo;
+        renderPassInfo.setRenderPass(renderPass);
+        renderPassInfo.setFramebuffer(framebuffers[imageIndex]);
+        renderPassInfo.setRenderArea(vk::Rect2D({0, 0}, {width, height}));
+        renderPassInfo.setClearValueCount(2);
+        renderPassInfo.setPClearValues(clearValues);
+        commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents());
+        const std::vector<uint32_t> dynamicOffsets = resources->getDynamicOffsets(frame); // the uniform copy of this frame
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, resources->getPipelineLayout(), 0, resources->getDescriptorSets().size(), resources->getDescriptorSets().data(), dynamicOffsets.size(), dynamicOffsets.data());
+        ++counts.descriptorBinds;
+
+        const std::vector<BindingAlignmentInfo>& alignmentInfos = drawComponents.alignmentInfo->getAlignmentInfos();
+        const uint32_t directDraws = (drawCommands == nullptr && culling == nullptr) ? vertexBuffers.size() : 0;
+        for(uint32_t draw = 0; draw < directDraws; ++draw)
+        {
+            const VertexBuffer* vertexBuffer = vertexBuffers[draw];
+            uint32_t drawRegion = utils::TimestampQueries::invalidRegion;
+            if(timestamps != nullptr)
+            {
+                for(uint32_t i = 0; i < timingRegions.size(); ++i)
+                {
+                    if(timingRegions[i].firstDraw == draw) userRegions[i] = timestamps->begin(commandBuffer, timingRegions[i].name);
+                }
+                drawRegion = timestamps->begin(commandBuffer, "draw " + std::to_string(draw));
+            }
+            const uint32_t level = currentLevelsOfDetail[2 * draw];
+            const uint32_t indexCount = vertexBuffer->getIndexCount(level);
+            bindVertexBuffers(commandBuffer, vertexBuffer, alignmentInfos, frame, counts);
+            if(indexCount != 0)
+            {
+                const vk::Buffer& ib = vertexBuffer->getIndexBuffer(level);
+                commandBuffer.bindIndexBuffer(ib, vertexBuffer->getIndexOffset(level), vertexBuffer->getVulkanIndexType());
+                ++counts.indexBufferBinds;
+            }
+
+            pushDrawConstants(commandBuffer, resources, vertexBuffer);
+            const uint32_t instanceCount = vertexBuffer->getInstanceCount(), firstInstance = vertexBuffer->getFirstInstance();
+
+            if(indexCount != 0)
+            {
+                commandBuffer.drawIndexed(indexCount, instanceCount, 0, 0, firstInstance);
+                ++counts.draws;
+            }
+            else
+            {
+                const auto perVertex = std::find_if(alignmentInfos.begin(), alignmentInfos.end(), [](const BindingAlignmentInfo& alignment){ return alignment.inputRate == InputRate::vertex; });
+                if(perVertex == alignmentInfos.end()) throw std::runtime_error("Non-indexed draws need a per-vertex binding!\n");
+                uint32_t vertexCount = vertexBuffer->getVertexBufferSize(perVertex->binding) / perVertex->structSize;
+                commandBuffer.draw(vertexCount, instanceCount, 0, firstInstance);
+                ++counts.draws;
+            }
+
+            if(timestamps != nullptr)
+            {
+                timestamps->end(commandBuffer, drawRegion);
+                for(uint32_t i = 0; i < timingRegions.size(); ++i)
+                {
+                    const uint32_t lastDraw = std::min<uint32_t>(timingRegions[i].firstDraw + timingRegions[i].drawCount, vertexBuffers.size()) - 1;
+                    if(draw == lastDraw) timestamps->end(commandBuffer, userRegions[i]);
+                }
+            }
+        }
+        if(drawCommands != nullptr)
+        {
+            const uint32_t indirectRegion = (timestamps == nullptr) ? utils::TimestampQueries::invalidRegion : timestamps->begin(commandBuffer, "indirect draws");
+            pushDrawConstants(commandBuffer, resources, vertexBuffers[0]);              // shared by every draw of the batch
+            recordIndirectDraws(commandBuffer, frame, vertexBuffers[0], alignmentInfos, drawCommands->getBuffer(), drawCommands->getCommandOffset(frame), drawCommands->getCountOffset(frame), drawCommands->getCapacity(), counts);
+            if(timestamps != nullptr) timestamps->end(commandBuffer, indirectRegion);
+        }
+        if(culling != nullptr)
+        {
+            const uint32_t culledRegion = (timestamps == nullptr) ? utils::TimestampQueries::invalidRegion : timestamps->begin(commandBuffer, "culled draws");
+            pushDrawConstants(commandBuffer, resources, vertexBuffers[0]);
+            recordIndirectDraws(commandBuffer, frame, vertexBuffers[0], alignmentInfos, culling->getOutputBuffer(), culling->getCommandOffset(frame), culling->getOutputOffset(frame), culling->getCapacity(), counts);
+            if(timestamps != nullptr) timestamps->end(commandBuffer, culledRegion);
+        }
+
+        commandBuffer.endRenderPass();
+        if(timestamps != nullptr) timestamps->end(commandBuffer, renderPassRegion);
+        if(culling != nullptr && options.occlusionCulling)
+        {
+            const uint32_t pyramidRegion = (timestamps == nullptr) ? utils::TimestampQueries::invalidRegion : timestamps->begin(commandBuffer, "depth pyramid");
+            recordDepthPyramid(commandBuffer, imageIndex, counts);
+            if(timestamps != nullptr) timestamps->end(commandBuffer, pyramidRegion);
+        }
+        if(timestamps != nullptr) timestamps->end(commandBuffer, frameRegion);
+        commandBuffer.end();
+    }
+
+    void RenderTarget::pushDrawConstants(vk::CommandBuffer& commandBuffer, const ResourceSet* resources, const VertexBuffer* vertexBuffer)
+    {
+        const uint32_t size = resources->getPushConstantSize();
+        if(size == 0) return;
+        std::vector<char> constants(size, 0);                                           // draws without their own constants see zeros, not those of the previous draw
+        const std::vector<char>& drawConstants = vertexBuffer->getPushConstants();
+        std::copy(drawConstants.begin(), drawConstants.end(), constants.begin());
+        commandBuffer.pushConstants(resources->getPipelineLayout(), resources->getPushConstantStages(), 0, size, constants.data());
+    }
+
+    void RenderTarget::bindVertexBuffers(vk::CommandBuffer& commandBuffer, const VertexBuffer* vertexBuffer, const std::vector<BindingAlignmentInfo>& alignmentInfos, const uint32_t frame, RecordedCommands& counts)
+    {
+        for(const auto& alignment : alignmentInfos)
+        {
+            const InstanceBuffer* instances = vertexBuffer->getInstanceBuffer(alignment.binding);
+            const vk::Buffer& buffer = (instances == nullptr) ? vertexBuffer->getVertexBuffer(alignment.binding) : instances->getBuffer();
+            const vk::DeviceSize offset = (instances == nullptr) ? 0 : instances->getOffset(frame);
+            commandBuffer.bindVertexBuffers(alignment.binding, 1, &buffer, &offset);
+            ++counts.vertexBufferBinds;
+        }
+    }
+
+    void RenderTarget::recordIndirectDraws(vk::CommandBuffer& commandBuffer, const uint32_t frame, const VertexBuffer* geometry, const std::vector<BindingAlignmentInfo>& alignmentInfos, const vk::Buffer& commands, const vk::DeviceSize commandOffset, const vk::DeviceSize countOffset, const uint32_t maxDrawCount, RecordedCommands& counts)
+    {
+        vk::DeviceSize offset = 0;
+        bindVertexBuffers(commandBuffer, geometry, alignmentInfos, frame, counts);
+        commandBuffer.bindIndexBuffer(geometry->getIndexBuffer(), offset, geometry->getVulkanIndexType());
+        ++counts.indexBufferBinds;
+
+        if(drawIndirectCount)
+        {
+            commandBuffer.drawIndexedIndirectCountKHR(commands, commandOffset, commands, countOffset, maxDrawCount, sizeof(DrawCommand), system::System::getInstance()->getLoader());
+            ++counts.draws;
+        }
+        else if(system::System::getInstance()->getEnabledFeatures().multiDrawIndirect)
+        {
+            commandBuffer.drawIndexedIndirect(commands, commandOffset, currentDrawCount, sizeof(DrawCommand));
+            ++counts.draws;
+        }
+        else
+        {
+            for(uint32_t i = 0; i < currentDrawCount; ++i)
+            {
+                commandBuffer.drawIndexedIndirect(commands, commandOffset + i * sizeof(DrawCommand), 1, sizeof(DrawCommand));
+            }
+            counts.draws += currentDrawCount;
+        }
+    }
+
+    std::pair<vk::VertexInputBindingDescription, std::vector<vk::VertexInputAttributeDescription> > RenderTarget::createPipelineVertexInputStateBase(const BindingAlignmentInfo& vertexAlignmentInfo)
+    {
+        vk::VertexInputBindingDescription bindingDesc;
+        bindingDesc.setBinding(vertexAlignmentInfo.binding);
+        bindingDesc.setInputRate((vertexAlignmentInfo.inputRate == InputRate::instance) ? vk::VertexInputRate::eInstance : vk::VertexInputRate::eVertex);
+        bindingDesc.setStride(vertexAlignmentInfo.structSize);
+
+        const vk::PhysicalDevice& physicalDevice = system::System::getInstance()->getPhysicalDevice();
+        std::vector<vk::VertexInputAttributeDescription> attributeDescriptions(vertexAlignmentInfo.fields.size());
+        for(int i = 0; i < attributeDescriptions.size(); ++i)
+        {
+            attributeDescriptions[i].setLocation(vertexAlignmentInfo.fields[i].location);
+            attributeDescriptions[i].setBinding(vertexAlignmentInfo.binding);
+            attributeDescriptions[i].setOffset(vertexAlignmentInfo.fields[i].offset);
+            switch (vertexAlignmentInfo.fields[i].format)
+            {
+            case FieldFormat::double64:
+                attributeDescriptions[i].setFormat(vk::Format::eR64Sfloat);
+                break;
+            case FieldFormat::float32 :
+                attributeDescriptions[i].setFormat(vk::Format::eR32Sfloat);
+                break;
+            case FieldFormat::int32 :
+                attributeDescriptions[i].setFormat(vk::Format::eR32Sint);
+                break;
+            case FieldFormat::uint32 :
+                attributeDescriptions[i].setFormat(vk::Format::eR32Uint);
+                break;
+            case FieldFormat::vec2d :
+                attributeDescriptions[i].setFormat(vk::Format::eR64G64Sfloat);
+                break;
+            case FieldFormat::vec2f :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32Sfloat);
+                break;
+            case FieldFormat::vec2i :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32Sint);
+                break;
+            case FieldFormat::vec2u :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32Uint);
+                break;
+            case FieldFormat::vec3d :
+                attributeDescriptions[i].setFormat(vk::Format::eR64G64B64Sfloat);
+                break;
+            case FieldFormat::vec3f :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32Sfloat);
+                break;
+            case FieldFormat::vec3i :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32Sint);
+                break;
+            case FieldFormat::vec3u :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32Uint);
+                break;
+            case FieldFormat::vec4d :
+                attributeDescriptions[i].setFormat(vk::Format::eR64G64B64A64Sfloat);
+                break;
+            case FieldFormat::vec4f :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32A32Sfloat);
+                break;
+            case FieldFormat::vec4i :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32A32Sint);
+                break;
+            case FieldFormat::vec4u :
+                attributeDescriptions[i].setFormat(vk::Format::eR32G32B32A32Uint);
+                break;
+            case FieldFormat::vec2half :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16Sfloat);
+                break;
+            case FieldFormat::vec4half :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16B16A16Sfloat);
+                break;
+            case FieldFormat::vec2snorm16 :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16Snorm);
+                break;
+            case FieldFormat::vec4snorm16 :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16B16A16Snorm);
+                break;
+            case FieldFormat::vec2unorm16 :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16Unorm);
+                break;
+            case FieldFormat::vec4unorm16 :
+                attributeDescriptions[i].setFormat(vk::Format::eR16G16B16A16Unorm);
+                break;
+            case FieldFormat::vec4snorm8 :
+                attributeDescriptions[i].setFormat(vk::Format::eR8G8B8A8Snorm);
+                break;
+            case FieldFormat::vec4unorm8 :
+                attributeDescriptions[i].setFormat(vk::Format::eR8G8B8A8Unorm);
+                break;
+            case FieldFormat::vec4snorm1010102 :
+                attributeDescriptions[i].setFormat(vk::Format::eA2B10G10R10SnormPack32);
+                break;
+            case FieldFormat::vec4unorm1010102 :
+                attributeDescriptions[i].setFormat(vk::Format::eA2B10G10R10UnormPack32);
+                break;
+            }
+
+            vk::FormatProperties properties;
+            physicalDevice.getFormatProperties(attributeDescriptions[i].format, &properties);
+            if(!(properties.bufferFeatures & vk::FormatFeatureFlagBits::eVertexBuffer)) throw std::runtime_error("Vertex field format " + vk::to_string(attributeDescriptions[i].format) + " is not supported by the device!\n");
+        }
+        return {bindingDesc, attributeDescriptions};
+    }
+
+    void RenderTarget::createPipeline(vk::Pipeline& pipeline, const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos, const std::vector<BindingAlignmentInfo>& vertexAlignmentInfos, const vk::PipelineLayout& layout)
+    {
+        SPARK_TRACE_SCOPE("RenderTarget::createPipeline");
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+
+        vk::GraphicsPipelineCreateInfo pipelineInfo;
+
+        pipelineInfo.setStageCount(shaderStageInfos.size());
+        pipelineInfo.setPStages(shaderStageInfos.data());
+        
+        vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
+
+        std::vector<vk::VertexInputBindingDescription> bindingDescriptions(vertexAlignmentInfos.size());
+        std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+
+        for(int i = 0; i < bindingDescriptions.size(); ++i)
+        {
+            auto base = createPipelineVertexInputStateBase(vertexAlignmentInfos[i]);
+            bindingDescriptions[i] = base.first;
+            attributeDescriptions.insert(attributeDescriptions.end(), base.second.begin(), base.second.end());
+        }
+
+        vertexInputInfo.setVertexBindingDescriptionCount(bindingDescriptions.size());
+        vertexInputInfo.setPVertexBindingDescriptions(bindingDescriptions.data());
+        
+        vertexInputInfo.setVertexAttributeDescriptionCount(attributeDescriptions.size());
+        vertexInputInfo.setPVertexAttributeDescriptions(attributeDescriptions.data());
+
+        pipelineInfo.setPVertexInputState(&vertexInputInfo);
+
+        vk::PipelineInputAssemblyStateCreateInfo assemblyInfo;
+        assemblyInfo.setTopology(vk::PrimitiveTopology::eTriangleList);
+        assemblyInfo.setPrimitiveRestartEnable(false);
+
+        pipelineInfo.setPInputAssemblyState(&assemblyInfo);
+
+//        vk::PipelineTessellationStateCreateInfo tesselationInfo;
+        pipelineInfo.setPTessellationState(nullptr);
+
+        vk::PipelineViewportStateCreateInfo viewportInfo;
+        viewportInfo.setViewportCount(1);
+        vk::Viewport vp;
+        vp.setX(0);
+        vp.setY(0);
+        vp.setWidth(width);
+        vp.setHeight(height);
+        vp.setMinDepth(0.0);
+        vp.setMaxDepth(1.0);
+        viewportInfo.setPViewports(&vp);
+        viewportInfo.setScissorCount(1);
+        vk::Rect2D scissor;
+        scissor.setOffset({0, 0});
+        scissor.setExtent({width, height});
+        viewportInfo.setPScissors(&scissor);
+
+        pipelineInfo.setPViewportState(&viewportInfo);
+
+        vk::PipelineRasterizationStateCreateInfo rasterizationInfo;
+        rasterizationInfo.setDepthClampEnable(false);
+        rasterizationInfo.setRasterizerDiscardEnable(false);
+        rasterizationInfo.setPolygonMode(vk::PolygonMode::eFill);
+        switch (options.cullMode)
+        {
+        case CullMode::None :
+            rasterizationInfo.setCullMode(vk::CullModeFlagBits::eNone);
+            break;
+        case CullMode::CounterClockwise :
+            rasterizationInfo.setCullMode(vk::CullModeFlagBits::eBack);
+            rasterizationInfo.setFrontFace(vk::FrontFace::eClockwise);
+            break;
+        case CullMode::Clockwise :
+            rasterizationInfo.setCullMode(vk::CullModeFlagBits::eBack);
+            rasterizationInfo.setFrontFace(vk::FrontFace::eCounterClockwise);
+            break;
+        
+        default:
+            break;
+        }
+        rasterizationInfo.setDepthBiasEnable(false);
+        rasterizationInfo.setLineWidth(1.0);
+
+        pipelineInfo.setPRasterizationState(&rasterizationInfo);
+
+        vk::PipelineMultisampleStateCreateInfo multisampleInfo;
+        multisampleInfo.setSampleShadingEnable(false);
+        multisampleInfo.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+
+        pipelineInfo.setPMultisampleState(&multisampleInfo);
+
+        vk::PipelineDepthStencilStateCreateInfo depthStencilInfo;
+        depthStencilInfo.setDepthTestEnable(true);
+        depthStencilInfo.setDepthWriteEnable(true);
+        depthStencilInfo.setDepthCompareOp(vk::CompareOp::eLess);
+        depthStencilInfo.setDepthBoundsTestEnable(false);
+        depthStencilInfo.setStencilTestEnable(false);
+
+        pipelineInfo.setPDepthStencilState(&depthStencilInfo);
+
+        vk::PipelineColorBlendStateCreateInfo colorBlendInfo;
+        colorBlendInfo.setLogicOpEnable(false);
+
+        vk::PipelineColorBlendAttachmentState attachmentState;
+        attachmentState.setBlendEnable(false);
+        attachmentState.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+        colorBlendInfo.setLogicOpEnable(false);
+        colorBlendInfo.setAttachmentCount(1);
+        colorBlendInfo.setPAttachments(&attachmentState);
+
+        pipelineInfo.setPColorBlendState(&colorBlendInfo);
+
+        /*vk::PipelineDynamicStateCreateInfo dynamicStateInfo;                  // for future
+        dynamicStateInfo.setDynamicStateCount(2);
+        vk::DynamicState dynamicStates[] = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+        dynamicStateInfo.setPDynamicStates(dynamicStates);*/
+        pipelineInfo.setPDynamicState(nullptr);
+
+        pipelineInfo.setLayout(layout);
+        pipelineInfo.setRenderPass(renderPass);
+        pipelineInfo.setSubpass(0);
+
+        if(logicalDevice.createGraphicsPipelines(system::System::getInstance()->getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != vk::Result::eSuccess) throw std::runtime_error("Failed to create pipeline!\n");
+    }
+    void RenderTarget::createDepthMaps(const uint32_t count)
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+        vk::CommandBuffer depthMapLayoutChangeCB;
+        vk::CommandBufferAllocateInfo commandBufferAllocationInfo;
+        commandBufferAllocationInfo.setCommandBufferCount(1);
+        commandBufferAllocationInfo.setCommandPool(pool);
+        commandBufferAllocationInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        logicalDevice.allocateCommandBuffers(&commandBufferAllocationInfo, &depthMapLayoutChangeCB);
+
+        vk::Fence depthMapAvailableFence;
+        vk::FenceCreateInfo fenceInfo;
+        logicalDevice.createFence(&fenceInfo, nullptr, &depthMapAvailableFence);
+
+        std::optional<vk::Format> format;
+        std::vector<vk::Format> formats = {vk::Format::eD32Sfloat, vk::Format::eD16Unorm};
+        format = utils::Image::getSupportedFormat(formats, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eDepthStencilAttachment);
+        if(!format.has_value()) throw std::runtime_error("Failed to pick format!\n");
+        depthMapFormat = format.value();
+
+        depthMaps.resize(count);                                                        // resized once: utils::Image must not be copied
+        depthMapViews.resize(count);
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            vk::ImageUsageFlags depthUsage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+            if(options.storeDepth) depthUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+            if(options.occlusionCulling) depthUsage |= vk::ImageUsageFlagBits::eSampled;
+            depthMaps[i].create({width, height, 1}, depthMapFormat, depthUsage, vk::ImageAspectFlagBits::eDepth);
+            depthMaps[i].bindMemory();
+            depthMaps[i].changeLayout(depthMapLayoutChangeCB, vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::Semaphore(), vk::Semaphore(), vk::Fence(), depthMapAvailableFence);
+
+            if(logicalDevice.waitForFences(1, &depthMapAvailableFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+            if(logicalDevice.resetFences(1, &depthMapAvailableFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
+            depthMapLayoutChangeCB.reset(vk::CommandBufferResetFlags());
+
+            depthMapViews[i].create(depthMaps[i].getImage(), depthMapFormat, depthMaps[i].getSubresource());
+        }
+        logicalDevice.destroyFence(depthMapAvailableFence, nullptr);
+        logicalDevice.freeCommandBuffers(pool, 1, &depthMapLayoutChangeCB);
+    }
+
+    void RenderTarget::createRenderPass()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+
+        vk::AttachmentDescription colorAttachment;
+        colorAttachment.setFormat(colorFormat);
+        colorAttachment.setSamples(vk::SampleCountFlagBits::e1);
+        colorAttachment.setLoadOp(vk::AttachmentLoadOp::eClear);
+        colorAttachment.setStoreOp(vk::AttachmentStoreOp::eStore);
+        colorAttachment.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
+        colorAttachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+        colorAttachment.setInitialLayout(vk::ImageLayout::eUndefined);          
+        colorAttachment.setFinalLayout(colorFinalLayout);
+
+        vk::AttachmentDescription depthAttachment;
+        depthAttachment.setFormat(depthMapFormat);
+        depthAttachment.setSamples(vk::SampleCountFlagBits::e1);
+        depthAttachment.setLoadOp(vk::AttachmentLoadOp::eClear);
+        depthAttachment.setStoreOp((options.storeDepth || options.occlusionCulling) ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare);
+        depthAttachment.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
+        depthAttachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+        depthAttachment.setInitialLayout(vk::ImageLayout::eUndefined);
+        depthAttachment.setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+        vk::AttachmentDescription attachments[] = {colorAttachment, depthAttachment};
+
+        vk::AttachmentReference colorAttachmentReference;
+        colorAttachmentReference.setAttachment(0);
+        colorAttachmentReference.setLayout(vk::ImageLayout::eColorAttachmentOptimal);
+
+        vk::AttachmentReference depthAttachmentReference;
+        depthAttachmentReference.setAttachment(1);
+        depthAttachmentReference.setLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+        vk::SubpassDescription subpassDesc;
+        subpassDesc.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+        subpassDesc.setInputAttachmentCount(0);
+        subpassDesc.setColorAttachmentCount(1);
+        subpassDesc.setPColorAttachments(&colorAttachmentReference);
+        subpassDesc.setPResolveAttachments(nullptr);
+        subpassDesc.setPDepthStencilAttachment(&depthAttachmentReference);
+        subpassDesc.setPreserveAttachmentCount(0);
+
+        vk::RenderPassCreateInfo info;
+        info.setAttachmentCount(2);
+        info.setPAttachments(attachments);
+        info.setSubpassCount(1);
+        info.setPSubpasses(&subpassDesc);
+
+        vk::SubpassDependency dependency;                                               // orders the shared depth map and the acquired image between frames in flight
+        dependency.setSrcSubpass(VK_SUBPASS_EXTERNAL);
+        dependency.setDstSubpass(0);
+        dependency.setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests);
+        dependency.setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests);
+        dependency.setSrcAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+        dependency.setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+        info.setDependencyCount(1);
+        info.setPDependencies(&dependency);
+
+        if(logicalDevice.createRenderPass(&info, nullptr, &renderPass) != vk::Result::eSuccess) throw std::runtime_error("Failed to create render pass!\n");
+    }
+
+    void RenderTarget::createFramebuffers(const std::vector<vk::ImageView>& colorViews)
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        framebuffers.resize(colorViews.size());
+        int i = 0;
+        for(auto& fb : framebuffers)
+        {
+            vk::ImageView views[] = {colorViews[i], depthMapViews[i % depthMapViews.size()].getView()};
+            vk::FramebufferCreateInfo info;
+            info.setRenderPass(renderPass);
+            info.setAttachmentCount(2);
+            info.setPAttachments(views);
+            info.setWidth(width);
+            info.setHeight(height);
+            info.setLayers(1);
+            if(logicalDevice.createFramebuffer(&info, nullptr, &fb) != vk::Result::eSuccess) throw std::runtime_error("Failed to create framebuffer!\n");
+            ++i;
+        }
+    }
+
+    void RenderTarget::createCommandBuffers()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+        frameCommandBuffers.resize(framesInFlight * imageCount);
+        frameCommandBufferVersions.resize(frameCommandBuffers.size(), ~uint32_t(0));
+        frameCommandCounts.resize(frameCommandBuffers.size());
+        vk::CommandBufferAllocateInfo allocInfo;
+        allocInfo.setCommandBufferCount(frameCommandBuffers.size());
+        allocInfo.setCommandPool(pool);
+        allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        logicalDevice.allocateCommandBuffers(&allocInfo, frameCommandBuffers.data());
+    }
+
+    void RenderTarget::createSyncObjects()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        vk::FenceCreateInfo fenceInfo;
+        fenceInfo.setFlags(vk::FenceCreateFlagBits::eSignaled);
+        frameFences.resize(framesInFlight);
+        for(auto& fence : frameFences)
+        {
+            if(logicalDevice.createFence(&fenceInfo, nullptr, &fence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
+        }
+        imageFences.resize(imageCount, vk::Fence());
+    }
+
+    void RenderTarget::createReadbackSlots()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+        size_t texelSize = colorReadable ? getTexelSize(colorFormat) : 0;
+        if(options.storeDepth && getTexelSize(depthMapFormat) > texelSize) texelSize = getTexelSize(depthMapFormat);
+
+        vk::CommandBufferAllocateInfo commandInfo;
+        commandInfo.setCommandBufferCount(1);
+        commandInfo.setCommandPool(pool);
+        commandInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        vk::FenceCreateInfo fenceInfo;
+
+        readbackSlots.resize(framesInFlight + 2);                                       // resized once: utils::Buffer must not be copied
+        for(auto& slot : readbackSlots)
+        {
+            slot.buffer.create(texelSize * width * height, vk::BufferUsageFlagBits::eTransferDst, false, true);
+            slot.buffer.bindMemory();
+            slot.data = slot.buffer.map();
+            if(logicalDevice.allocateCommandBuffers(&commandInfo, &slot.commandBuffer) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate command buffer!\n");
+            if(logicalDevice.createFence(&fenceInfo, nullptr, &slot.fence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
+            slot.handle = invalidReadback;
+            slot.state = ReadbackState::Free;
+            slot.size = 0;
+        }
+    }
+
+    const size_t RenderTarget::getTexelSize(const vk::Format format) const
+    {
+        switch (format)
+        {
+        case vk::Format::eD16Unorm :
+            return 2;
+        case vk::Format::eD32Sfloat :
+        case vk::Format::eR8G8B8A8Unorm :
+        case vk::Format::eR8G8B8A8Srgb :
+        case vk::Format::eB8G8R8A8Unorm :
+        case vk::Format::eB8G8R8A8Srgb :
+        case vk::Format::eA2B10G10R10UnormPack32 :
+        case vk::Format::eA2R10G10B10UnormPack32 :
+            return 4;
+        case vk::Format::eR16G16B16A16Unorm :
+        case vk::Format::eR16G16B16A16Sfloat :
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    ReadbackHandle RenderTarget::requestReadback(const ReadbackAttachment attachment, const ReadbackCallback callback)
+    {
+        if(attachment == ReadbackAttachment::Depth && !options.storeDepth) throw std::runtime_error("Depth readback requires DrawOptions::storeDepth!\n");
+        if(attachment == ReadbackAttachment::Color && !colorReadable) throw std::runtime_error("Color images of this target can't be read back!\n");
+        const size_t texelSize = getTexelSize(attachment == ReadbackAttachment::Color ? colorFormat : depthMapFormat);
+        if(texelSize == 0) throw std::runtime_error("Unsupported readback format!\n");
+        if(readbackSlots.size() == 0) createReadbackSlots();
+        pollReadbacks();
+        for(auto& slot : readbackSlots)
+        {
+            if(slot.state == ReadbackState::Free)
+            {
+                slot.handle = ++readbackCount;
+                slot.attachment = attachment;
+                slot.callback = callback;
+                slot.state = ReadbackState::Requested;
+                slot.size = width * height * texelSize;
+                return slot.handle;
+            }
+        }
+        return invalidReadback;                                                         // dropping a readback is preferable to stalling the render loop
+    }
+
+    RenderTarget::ReadbackSlot* RenderTarget::findReadbackSlot(const ReadbackHandle handle)
+    {
+        if(handle == invalidReadback) return nullptr;
+        for(auto& slot : readbackSlots)
+        {
+            if(slot.handle == handle && slot.state != ReadbackState::Free) return &slot;
+        }
+        return nullptr;
+    }
+
+    const RenderTarget::ReadbackSlot* RenderTarget::findReadbackSlot(const ReadbackHandle handle) const
+    {
+        if(handle == invalidReadback) return nullptr;
+        for(const auto& slot : readbackSlots)
+        {
+            if(slot.handle == handle && slot.state != ReadbackState::Free) return &slot;
+        }
+        return nullptr;
+    }
+
+    const bool RenderTarget::isReadbackReady(const ReadbackHandle handle)
+    {
+        pollReadbacks();
+        const ReadbackSlot* slot = findReadbackSlot(handle);
+        return slot != nullptr && slot->state == ReadbackState::Ready;
+    }
+
+    const void* RenderTarget::getReadbackData(const ReadbackHandle handle) const
+    {
+        const ReadbackSlot* slot = findReadbackSlot(handle);
+        if(slot == nullptr || slot->state != ReadbackState::Ready) throw std::runtime_error("Readback is not ready!\n");
+        return slot->data;
+    }
+
+    const size_t RenderTarget::getReadbackSize(const ReadbackHandle handle) const
+    {
+        const ReadbackSlot* slot = findReadbackSlot(handle);
+        if(slot == nullptr) throw std::runtime_error("Unknown readback!\n");
+        return slot->size;
+    }
+
+    void RenderTarget::releaseReadback(const ReadbackHandle handle)
+    {
+        ReadbackSlot* slot = findReadbackSlot(handle);
+        if(slot == nullptr) return;
+        if(slot->state == ReadbackState::Pending) throw std::runtime_error("Can't release pending readback!\n");
+        slot->state = ReadbackState::Free;
+        slot->callback = nullptr;
+    }
+
+    void RenderTarget::pollReadbacks()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        for(auto& slot : readbackSlots)
+        {
+            if(slot.state != ReadbackState::Pending) continue;
+            if(logicalDevice.getFenceStatus(slot.fence) != vk::Result::eSuccess) continue;
+            slot.state = ReadbackState::Ready;
+            if(slot.callback)
+            {
+                slot.callback(slot.data, slot.size);
+                slot.state = ReadbackState::Free;
+                slot.callback = nullptr;
+            }
+        }
+    }
+
+    void RenderTarget::recordReadback(ReadbackSlot& slot, const uint32_t imageIndex)
+    {
+        const bool color = slot.attachment == ReadbackAttachment::Color;
+        const vk::Image& image = color ? getColorImage(imageIndex) : depthMaps[imageIndex % depthMaps.size()].getImage();
+        const vk::ImageLayout attachmentLayout = color ? colorFinalLayout : vk::ImageLayout::eDepthStencilAttachmentOptimal;
+        const vk::ImageAspectFlags aspect = color ? vk::ImageAspectFlags(vk::ImageAspectFlagBits::eColor) : vk::ImageAspectFlags(vk::ImageAspectFlagBits::eDepth);
+        const vk::PipelineStageFlags attachmentStage = color ? vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput) : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests);
+        const vk::AccessFlags attachmentAccess = color ? vk::AccessFlags(vk::AccessFlagBits::eColorAttachmentWrite) : vk::AccessFlags(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+
+        vk::ImageSubresourceRange range;
+        range.setAspectMask(aspect);
+        range.setBaseMipLevel(0);
+        range.setLevelCount(1);
+        range.setBaseArrayLayer(0);
+        range.setLayerCount(1);
+
+        vk::ImageMemoryBarrier toTransfer;
+        toTransfer.setSrcAccessMask(attachmentAccess);
+        toTransfer.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+        toTransfer.setOldLayout(attachmentLayout);
+        toTransfer.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+        toTransfer.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toTransfer.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toTransfer.setImage(image);
+        toTransfer.setSubresourceRange(range);
+
+        vk::ImageMemoryBarrier toAttachment = toTransfer;                               // the next frame rendering to this image must wait for the copy
+        toAttachment.setSrcAccessMask(vk::AccessFlags());
+        toAttachment.setDstAccessMask(attachmentAccess);
+        toAttachment.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+        toAttachment.setNewLayout(attachmentLayout);
+
+        vk::BufferMemoryBarrier toHost;
+        toHost.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        toHost.setDstAccessMask(vk::AccessFlagBits::eHostRead);
+        toHost.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toHost.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toHost.setBuffer(slot.buffer.getBuffer());
+        toHost.setOffset(0);
+        toHost.setSize(VK_WHOLE_SIZE);
+
+        vk::ImageSubresourceLayers subresource;
+        subresource.setAspectMask(aspect);
+        subresource.setMipLevel(0);
+        subresource.setBaseArrayLayer(0);
+        subresource.setLayerCount(1);
+
+        vk::BufferImageCopy copyInfo;
+        copyInfo.setBufferOffset(0);
+        copyInfo.setBufferRowLength(0);
+        copyInfo.setBufferImageHeight(0);
+        copyInfo.setImageSubresource(subresource);
+        copyInfo.setImageOffset(vk::Offset3D());
+        copyInfo.setImageExtent({width, height, 1});
+
+        slot.commandBuffer.reset(vk::CommandBufferResetFlags());
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        if(slot.commandBuffer.begin(&beginInfo) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+        slot.commandBuffer.pipelineBarrier(attachmentStage, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &toTransfer);
+        slot.commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer.getBuffer(), 1, &copyInfo);
+        slot.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, attachmentStage | vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), 0, nullptr, 1, &toHost, 1, &toAttachment);
+        slot.commandBuffer.end();
+    }
+
+    void RenderTarget::destroyReadbackSlots()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+        for(auto& slot : readbackSlots)
+        {
+            slot.buffer.destroy();
+            logicalDevice.freeCommandBuffers(pool, 1, &slot.commandBuffer);
+            logicalDevice.destroyFence(slot.fence, nullptr);
+        }
+        readbackSlots.clear();
+    }
+
+    void RenderTarget::createTimestampQueries()
+    {
+        frameTimestamps.resize(frameCommandBuffers.size());                             // resized once: utils::TimestampQueries must not be copied
+        for(auto& timestamps : frameTimestamps)
+        {
+            timestamps.create(64);
+        }
+        frameSubmittedCommandBuffers.resize(framesInFlight, 0);
+        frameSubmitSerials.resize(framesInFlight, 0);
+        frameDrawNumbers.resize(framesInFlight, 0);
+        frameSubmitTimes.resize(framesInFlight, 0);
+        system::GPUProfiler::getInstance()->setUploadTimingsEnabled(true);
+    }
+
+    void RenderTarget::collectTimings()
+    {
+        if(frameTimestamps.size() == 0 || frameSubmitSerials[currentFrame] == 0) return;
+        GPUFrameTimings timings;
+        if(!frameTimestamps[frameSubmittedCommandBuffers[currentFrame]].collect(timings.regions) || timings.regions.size() == 0) return;
+        timings.frame = frameDrawNumbers[currentFrame];
+        timings.milliseconds = timings.regions[0].milliseconds;
+        timings.regions.erase(timings.regions.begin());
+    #ifdef SPARK_TRACING
+        const uint64_t frameBegin = frameSubmitTimes[currentFrame];                     // GPU and CPU clocks aren't calibrated: the GPU frame is drawn as starting at its submission
+        SPARK_TRACE_GPU_SPAN("frame", frameBegin, frameBegin + uint64_t(timings.milliseconds * 1000000.0));
+        for(const auto& region : timings.regions)
+        {
+            const uint64_t regionBegin = frameBegin + uint64_t(region.startMilliseconds * 1000000.0);
+            SPARK_TRACE_GPU_SPAN(region.name, regionBegin, regionBegin + uint64_t(region.milliseconds * 1000000.0));
+        }
+    #endif
+        system::GPUProfiler::getInstance()->collectUploads(frameSubmitSerials[currentFrame], timings.uploads);
+        gpuTimings = std::move(timings);
+        frameSubmitSerials[currentFrame] = 0;
+    }
+
+    void RenderTarget::createCulling()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        cullShaders.reset(new ShaderSet({{ShaderType::Compute, options.shaderDirectory + "cull.comp.spv"}}));
+        pyramidShaders.reset(new ShaderSet({{ShaderType::Compute, options.shaderDirectory + "hiz.comp.spv"}}));
+
+        system::LayoutCache* layoutCache = system::LayoutCache::getInstance();
+        cullingSetLayout = CullingSet::createSetLayout();
+        std::vector<vk::DescriptorSetLayoutBinding> pyramidBindings(2);
+        pyramidBindings[0].setBinding(0);
+        pyramidBindings[0].setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+        pyramidBindings[0].setDescriptorCount(1);
+        pyramidBindings[0].setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        pyramidBindings[0].setPImmutableSamplers(nullptr);
+        pyramidBindings[1] = pyramidBindings[0];
+        pyramidBindings[1].setBinding(1);
+        pyramidBindings[1].setDescriptorType(vk::DescriptorType::eStorageImage);
+        pyramidSampleLayout = layoutCache->getSetLayout({pyramidBindings[0]});
+        pyramidBuildLayout = layoutCache->getSetLayout(pyramidBindings);
+
+        vk::PushConstantRange pyramidConstants;                                         // pyramid width, height and level count (0 = no occlusion test)
+        pyramidConstants.setStageFlags(vk::ShaderStageFlagBits::eCompute);
+        pyramidConstants.setOffset(0);
+        pyramidConstants.setSize(3 * sizeof(uint32_t));
+        cullPipelineLayout = layoutCache->getPipelineLayout({cullingSetLayout, pyramidSampleLayout}, {pyramidConstants});
+        pyramidPipelineLayout = layoutCache->getPipelineLayout({pyramidBuildLayout});
+
+        vk::ComputePipelineCreateInfo pipelineInfos[2];
+        pipelineInfos[0].setStage(cullShaders->getShaderStages()[0]);
+        pipelineInfos[0].setLayout(cullPipelineLayout);
+        pipelineInfos[0].setBasePipelineIndex(-1);
+        pipelineInfos[1].setStage(pyramidShaders->getShaderStages()[0]);
+        pipelineInfos[1].setLayout(pyramidPipelineLayout);
+        pipelineInfos[1].setBasePipelineIndex(-1);
+        vk::Pipeline pipelines[2];
+        if(logicalDevice.createComputePipelines(system::System::getInstance()->getPipelineCache(), 2, pipelineInfos, nullptr, pipelines) != vk::Result::eSuccess) throw std::runtime_error("Failed to create compute pipeline!\n");
+        cullPipeline = pipelines[0];
+        pyramidPipeline = pipelines[1];
+
+        createDepthPyramid();
+    }
+
+    void RenderTarget::createDepthPyramid()
+    {
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        const uint32_t pyramidWidth = options.occlusionCulling ? width : 1, pyramidHeight = options.occlusionCulling ? height : 1;
+        pyramidLevels = 1;
+        while((std::max(pyramidWidth, pyramidHeight) >> pyramidLevels) != 0) ++pyramidLevels;
+
+        depthPyramid.create({pyramidWidth, pyramidHeight, 1}, vk::Format::eR32Sfloat, vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::ImageAspectFlagBits::eColor, pyramidLevels);
+        depthPyramid.bindMemory();
+        depthPyramidViews.resize(pyramidLevels + 1);                                    // resized once: utils::ImageView must not be copied
+        vk::ImageSubresourceRange range = depthPyramid.getSubresource();
+        depthPyramidViews[0].create(depthPyramid.getImage(), vk::Format::eR32Sfloat, range);
+        for(uint32_t level = 0; level < pyramidLevels; ++level)
+        {
+            range.setBaseMipLevel(level);
+            range.setLevelCount(1);
+            depthPyramidViews[level + 1].create(depthPyramid.getImage(), vk::Format::eR32Sfloat, range);
+        }
+
+        SamplerInfo samplerInfo;
+        samplerInfo.magFilter = Filter::Nearest;
+        samplerInfo.minFilter = Filter::Nearest;
+        samplerInfo.addressModeU = samplerInfo.addressModeV = samplerInfo.addressModeW = AddressMode::ClampToEdge;
+        samplerInfo.maxLod = pyramidLevels;
+        pyramidSampler = system::SamplerCache::getInstance()->getSampler(samplerInfo);  // targets with equally deep pyramids share it
+
+        const uint32_t buildSetCount = options.occlusionCulling ? depthMaps.size() + pyramidLevels - 1 : 0;
+        vk::DescriptorPoolSize poolSizes[2];
+        poolSizes[0].setType(vk::DescriptorType::eCombinedImageSampler);
+        poolSizes[0].setDescriptorCount(1 + buildSetCount);
+        poolSizes[1].setType(vk::DescriptorType::eStorageImage);
+        poolSizes[1].setDescriptorCount(std::max<uint32_t>(buildSetCount, 1));
+        vk::DescriptorPoolCreateInfo poolInfo;
+        poolInfo.setMaxSets(1 + buildSetCount);
+        poolInfo.setPoolSizeCount(2);
+        poolInfo.setPPoolSizes(poolSizes);
+        if(logicalDevice.createDescriptorPool(&poolInfo, nullptr, &cullingDescriptorPool) != vk::Result::eSuccess) throw std::runtime_error("Failed to create descriptor pool!\n");
+
+        std::vector<vk::DescriptorSetLayout> setLayouts(1 + buildSetCount, pyramidBuildLayout);
+        setLayouts[0] = pyramidSampleLayout;
+        std::vector<vk::DescriptorSet> sets(setLayouts.size());
+        vk::DescriptorSetAllocateInfo allocInfo;
+        allocInfo.setDescriptorPool(cullingDescriptorPool);
+        allocInfo.setDescriptorSetCount(sets.size());
+        allocInfo.setPSetLayouts(setLayouts.data());
+        if(logicalDevice.allocateDescriptorSets(&allocInfo, sets.data()) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate descriptor sets!\n");
+        pyramidSampleSet = sets[0];
+        pyramidBuildSets.assign(sets.begin() + 1, sets.end());
+
+        std::vector<vk::DescriptorImageInfo> imageInfos(1 + 2 * buildSetCount);         // reserved up front: the writes keep pointers into it
+        std::vector<vk::WriteDescriptorSet> writes(1 + 2 * buildSetCount);
+        imageInfos[0].setSampler(pyramidSampler);
+        imageInfos[0].setImageView(depthPyramidViews[0].getView());
+        imageInfos[0].setImageLayout(vk::ImageLayout::eGeneral);
+        for(uint32_t i = 0; i < buildSetCount; ++i)
+        {
+            const bool fromDepth = i < depthMaps.size();
+            const uint32_t level = fromDepth ? 0 : i - depthMaps.size() + 1;
+            imageInfos[1 + 2 * i].setSampler(pyramidSampler);
+            imageInfos[1 + 2 * i].setImageView(fromDepth ? depthMapViews[i].getView() : depthPyramidViews[level].getView());     // view of the previous level
+            imageInfos[1 + 2 * i].setImageLayout(fromDepth ? vk::ImageLayout::eDepthStencilReadOnlyOptimal : vk::ImageLayout::eGeneral);
+            imageInfos[2 + 2 * i].setImageView(depthPyramidViews[level + 1].getView());
+            imageInfos[2 + 2 * i].setImageLayout(vk::ImageLayout::eGeneral);
+        }
+        for(uint32_t i = 0; i < writes.size(); ++i)
+        {
+            const bool storage = i != 0 && i % 2 == 0;
+            writes[i].setDstSet(i == 0 ? pyramidSampleSet : pyramidBuildSets[(i - 1) / 2]);
+            writes[i].setDstBinding(storage ? 1 : 0);
+            writes[i].setDstArrayElement(0);
+            writes[i].setDescriptorCount(1);
+            writes[i].setDescriptorType(storage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eCombinedImageSampler);
+            writes[i].setPImageInfo(&imageInfos[i]);
+        }
+        logicalDevice.updateDescriptorSets(writes.size(), writes.data(), 0, nullptr);
+
+        const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+        vk::CommandBuffer clearCB;
+        vk::CommandBufferAllocateInfo commandInfo;
+        commandInfo.setCommandBufferCount(1);
+        commandInfo.setCommandPool(pool);
+        commandInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        if(logicalDevice.allocateCommandBuffers(&commandInfo, &clearCB) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate command buffer!\n");
+        vk::Fence clearedFence;
+        vk::FenceCreateInfo fenceInfo;
+        if(logicalDevice.createFence(&fenceInfo, nullptr, &clearedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
+
+        vk::ImageMemoryBarrier toTransfer;
+        toTransfer.setSrcAccessMask(vk::AccessFlags());
+        toTransfer.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        toTransfer.setOldLayout(vk::ImageLayout::eUndefined);
+        toTransfer.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+        toTransfer.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toTransfer.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        toTransfer.setImage(depthPyramid.getImage());
+        toTransfer.setSubresourceRange(depthPyramid.getSubresource());
+        vk::ImageMemoryBarrier toGeneral = toTransfer;
+        toGeneral.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        toGeneral.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        toGeneral.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+        toGeneral.setNewLayout(vk::ImageLayout::eGeneral);
+        vk::ClearColorValue farthest;
+        farthest.setFloat32({1.0f, 1.0f, 1.0f, 1.0f});                                  // nothing is occluded until the first pyramid is built
+        const vk::ImageSubresourceRange clearRange = depthPyramid.getSubresource();
+
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        if(clearCB.begin(&beginInfo) != vk::Result::eSuccess) throw std::runtime_error("Failed to begin command buffer!\n");
+        clearCB.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &toTransfer);
+        clearCB.clearColorImage(depthPyramid.getImage(), vk::ImageLayout::eTransferDstOptimal, &farthest, 1, &clearRange);
+        clearCB.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &toGeneral);
+        clearCB.end();
+
+        vk::SubmitInfo submit;
+        submit.setCommandBufferCount(1);
+        submit.setPCommandBuffers(&clearCB);
+        if(system::Executives::getInstance()->getGraphicsQueue().submit(1, &submit, clearedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to submit queue!\n");
+        system::Statistics::getInstance()->countSubmit();
+        if(system::Statistics::getInstance()->waitForFences(1, &clearedFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        logicalDevice.destroyFence(clearedFence, nullptr);
+        logicalDevice.freeCommandBuffers(pool, 1, &clearCB);
+    }
+
+    void RenderTarget::recordCulling(vk::CommandBuffer& commandBuffer, const uint32_t frame, const CullingSet* culling, RecordedCommands& counts)
+    {
+        vk::MemoryBarrier pyramidWritten;                                               // the pyramid is built by the previous frame
+        pyramidWritten.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        pyramidWritten.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 1, &pyramidWritten, 0, nullptr, 0, nullptr);
+        if(culling->isCompact())
+        {
+            commandBuffer.fillBuffer(culling->getOutputBuffer(), culling->getOutputOffset(frame), sizeof(uint32_t), 0);
+            vk::MemoryBarrier countCleared;
+            countCleared.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+            countCleared.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 1, &countCleared, 0, nullptr, 0, nullptr);
+        }
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, cullPipeline);
+        ++counts.pipelineBinds;
+        const vk::DescriptorSet sets[] = {culling->getDescriptorSet(), pyramidSampleSet};
+        const uint32_t offsets[] = {culling->getInputOffset(frame), culling->getOutputOffset(frame)};
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, cullPipelineLayout, 0, 2, sets, 2, offsets);
+        ++counts.descriptorBinds;
+        const vk::Extent3D pyramidExtent = {options.occlusionCulling ? width : 1, options.occlusionCulling ? height : 1, 1};
+        const uint32_t constants[] = {pyramidExtent.width, pyramidExtent.height, options.occlusionCulling ? pyramidLevels : 0};
+        commandBuffer.pushConstants(cullPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(constants), constants);
+        commandBuffer.dispatch((culling->getCapacity() + 63) / 64, 1, 1);              // invocations past the object count return at once
+
+        vk::MemoryBarrier drawsWritten;
+        drawsWritten.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        drawsWritten.setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, vk::DependencyFlags(), 1, &drawsWritten, 0, nullptr, 0, nullptr);
+    }
+
+    void RenderTarget::recordDepthPyramid(vk::CommandBuffer& commandBuffer, const uint32_t imageIndex, RecordedCommands& counts)
+    {
+        const uint32_t depthIndex = imageIndex % depthMaps.size();
+        vk::ImageMemoryBarrier depthToRead;
+        depthToRead.setSrcAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+        depthToRead.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        depthToRead.setOldLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        depthToRead.setNewLayout(vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+        depthToRead.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        depthToRead.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        depthToRead.setImage(depthMaps[depthIndex].getImage());
+        depthToRead.setSubresourceRange(depthMaps[depthIndex].getSubresource());
+        vk::ImageMemoryBarrier pyramidToWrite;                                          // the cull pass of this frame has read the old pyramid
+        pyramidToWrite.setSrcAccessMask(vk::AccessFlagBits::eShaderRead);
+        pyramidToWrite.setDstAccessMask(vk::AccessFlagBits::eShaderWrite);
+        pyramidToWrite.setOldLayout(vk::ImageLayout::eGeneral);
+        pyramidToWrite.setNewLayout(vk::ImageLayout::eGeneral);
+        pyramidToWrite.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        pyramidToWrite.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        pyramidToWrite.setImage(depthPyramid.getImage());
+        pyramidToWrite.setSubresourceRange(depthPyramid.getSubresource());
+        const vk::ImageMemoryBarrier toPyramid[] = {depthToRead, pyramidToWrite};
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 2, toPyramid);
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pyramidPipeline);
+        ++counts.pipelineBinds;
+        vk::MemoryBarrier levelWritten;
+        levelWritten.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        levelWritten.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        for(uint32_t level = 0; level < pyramidLevels; ++level)
+        {
+            const vk::DescriptorSet& set = (level == 0) ? pyramidBuildSets[depthIndex] : pyramidBuildSets[depthMaps.size() + level - 1];
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pyramidPipelineLayout, 0, 1, &set, 0, nullptr);
+            ++counts.descriptorBinds;
+            const uint32_t levelWidth = std::max<uint32_t>(width >> level, 1), levelHeight = std::max<uint32_t>(height >> level, 1);
+            commandBuffer.dispatch((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), 1, &levelWritten, 0, nullptr, 0, nullptr);
+        }
+
+        vk::ImageMemoryBarrier depthToAttachment = depthToRead;                         // later readbacks and frames expect the attachment layout
+        depthToAttachment.setSrcAccessMask(vk::AccessFlagBits::eShaderRead);
+        depthToAttachment.setDstAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eTransferRead);
+        depthToAttachment.setOldLayout(vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+        depthToAttachment.setNewLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &depthToAttachment);
+    }
+
+    void RenderTarget::destroyCulling()
+    {
+        if(!cullPipeline) return;
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        logicalDevice.destroyPipeline(cullPipeline, nullptr);
+        logicalDevice.destroyPipeline(pyramidPipeline, nullptr);
+        logicalDevice.destroyDescriptorPool(cullingDescriptorPool, nullptr);
+        pyramidBuildSets.clear();
+        for(auto& view : depthPyramidViews)
+        {
+            view.destroy();
+        }
+        depthPyramidViews.clear();
+        depthPyramid.destroy();
+        cullShaders.reset();
+        pyramidShaders.reset();
+        cullPipeline = vk::Pipeline();
+    }
+
+    void RenderTarget::destroyTarget()
+    {
+        if(frameFences.size() != 0)
+        {
+            const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+            const vk::CommandPool& pool = system::Executives::getInstance()->getPool();
+            logicalDevice.waitIdle();
+            if(system::Capture::isActive()) system::Capture::getInstance()->recordTargetDestroy(this);
+            destroyReadbackSlots();
+            system::Executives::getInstance()->releaseFrameCopyOwner(this);
+            frameTimestamps.clear();
+            frameSubmittedCommandBuffers.clear();
+            frameSubmitSerials.clear();
+            frameDrawNumbers.clear();
+            frameSubmitTimes.clear();
+            for(auto& fence : frameFences)
+            {
+                system::Executives::getInstance()->completeFrameSubmission(fence);
+                logicalDevice.destroyFence(fence, nullptr);
+            }
+            frameFences.clear();
+            imageFences.clear();
+            logicalDevice.freeCommandBuffers(pool, frameCommandBuffers.size(), frameCommandBuffers.data());
+            frameCommandBuffers.clear();
+            frameCommandBufferVersions.clear();
+            frameCommandCounts.clear();
+            for(auto& fb : framebuffers)
+            {
+                logicalDevice.destroyFramebuffer(fb, nullptr);
+            }
+            framebuffers.clear();
+            for(auto& component : drawComponents)
+            {
+                logicalDevice.destroyPipeline(component.second.pipeline, nullptr);
+            }
+            drawComponents.clear();
+            logicalDevice.destroyRenderPass(renderPass, nullptr);
+            destroyCulling();
+            for(auto& view : depthMapViews)
+            {
+                view.destroy();
+            }
+            for(auto& map : depthMaps)
+            {
+                map.destroy();
+            }
+        }
+    }
+
+    RenderTarget::~RenderTarget(){}
+
+}
\ No newline at end of file
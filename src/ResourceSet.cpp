@@ -1,19 +1,25 @@
 #include"../include/ResourceSet.hpp"
+#include<algorithm>
 
 namespace spk
 {
     uint32_t ResourceSet::count = 0;
 
-    ResourceSet::ResourceSet(): identifier(count)
+    ResourceSet::ResourceSet(): identifier(count), pushConstantSize(0), bindlessSet(0), bindlessCapacity(0)
     {
         ++count;
     }
 
     ResourceSet::ResourceSet(const ResourceSet& set): 
         identifier(count),
-        textures(set.textures),
-        uniformBuffers(set.uniformBuffers)
+        uniformBuffers(set.uniformBuffers),
+        storageBuffers(set.storageBuffers),
+        pushConstantSize(set.pushConstantSize),
+        bindlessSet(set.bindlessSet),
+        bindlessCapacity(set.bindlessCapacity)
     {
+        textures.reserve(set.textures.size() + bindlessCapacity);                       // added textures never move the others, which would copy their images
+        textures.insert(textures.end(), set.textures.begin(), set.textures.end());
         init();
         ++count;
     }
@@ -23,8 +29,14 @@ namespace spk
         destroy();
         identifier = count;
         ++count;
-        textures = set.textures;
         uniformBuffers = set.uniformBuffers;
+        storageBuffers = set.storageBuffers;
+        pushConstantSize = set.pushConstantSize;
+        bindlessSet = set.bindlessSet;
+        bindlessCapacity = set.bindlessCapacity;
+        textures.clear();
+        textures.reserve(set.textures.size() + bindlessCapacity);
+        textures.insert(textures.end(), set.textures.begin(), set.textures.end());
         init();
         return *this;
     }
@@ -32,7 +44,23 @@ namespace spk
     ResourceSet::ResourceSet(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers): 
         identifier(count),
         textures(cTextures), 
-        uniformBuffers(cUniformBuffers)
+        uniformBuffers(cUniformBuffers),
+        pushConstantSize(0),
+        bindlessSet(0),
+        bindlessCapacity(0)
+    {
+        init();
+        ++count;
+    }
+
+    ResourceSet::ResourceSet(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers, std::vector<StorageBuffer>& cStorageBuffers): 
+        identifier(count),
+        textures(cTextures), 
+        uniformBuffers(cUniformBuffers),
+        storageBuffers(cStorageBuffers),
+        pushConstantSize(0),
+        bindlessSet(0),
+        bindlessCapacity(0)
     {
         init();
         ++count;
@@ -40,11 +68,18 @@ namespace spk
 
     void ResourceSet::create(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers)
     {
+        textures.reserve(textures.size() + cTextures.size() + bindlessCapacity);
         textures.insert(textures.begin(), cTextures.begin(), cTextures.end());
         uniformBuffers.insert(uniformBuffers.begin(), cUniformBuffers.begin(), cUniformBuffers.end());
         init();
     }
 
+    void ResourceSet::create(std::vector<Texture>& cTextures, std::vector<UniformBuffer>& cUniformBuffers, std::vector<StorageBuffer>& cStorageBuffers)
+    {
+        storageBuffers.insert(storageBuffers.begin(), cStorageBuffers.begin(), cStorageBuffers.end());
+        create(cTextures, cUniformBuffers);
+    }
+
     const vk::PipelineLayout& ResourceSet::getPipelineLayout() const 
     {
         return pipelineLayout;
@@ -60,16 +95,130 @@ namespace spk
         return identifier;
     }
 
-    void ResourceSet::update(const uint32_t set, const uint32_t binding, const void* data)
+    const uint32_t ResourceSet::getLayoutIdentifier() const
     {
-        uint32_t index = setContainmentData[set].bindings[binding].first;
-        if(setContainmentData[set].bindings[binding].second)
+        return layoutIdentifier;
+    }
+
+    void ResourceSet::setPushConstantSize(const uint32_t size)
+    {
+        vk::PhysicalDeviceProperties properties;
+        system::System::getInstance()->getPhysicalDevice().getProperties(&properties);
+        if(size % 4 != 0 || size > properties.limits.maxPushConstantsSize) throw std::runtime_error("Push constant size must be a multiple of 4 within maxPushConstantsSize!\n");
+        pushConstantSize = size;
+        if(pipelineLayout)                                                              // the descriptor sets stay, only the pipeline layout changes
+        {
+            system::LayoutCache* layoutCache = system::LayoutCache::getInstance();
+            pipelineLayout = layoutCache->getPipelineLayout(descriptorLayouts, getPushConstantRanges());
+            layoutIdentifier = layoutCache->getIdentifier(pipelineLayout);
+            if(system::Capture::isActive()) system::Capture::getInstance()->recordPushConstantSize(*this);
+        }
+    }
+
+    const uint32_t ResourceSet::getPushConstantSize() const
+    {
+        return pushConstantSize;
+    }
+
+    void ResourceSet::setBindlessSet(const uint32_t set, const uint32_t capacity)
+    {
+        if(pipelineLayout) throw std::runtime_error("Bindless set must be chosen before the resource set is created!\n");
+        if(capacity > system::System::getInstance()->getMaxBindlessTextures()) throw std::runtime_error("Bindless capacity exceeds the device limit or descriptor indexing is not supported!\n");
+        bindlessSet = set;
+        bindlessCapacity = capacity;
+    }
+
+    void ResourceSet::addTexture(const Texture& texture)
+    {
+        if(!pipelineLayout) throw std::runtime_error("Resource set is not created!\n");
+        if(!isBindless(texture.getSet())) throw std::runtime_error("Textures can only be added to the bindless set!\n");
+        addBinding(texture.getSet(), texture.getBinding(), textures.size(), ResourceType::Texture);
+        textures.push_back(texture);                                                    // the capacity was reserved at creation
+        textures.back().bindMemory();
+
+        const vk::DescriptorImageInfo imgInfo = getImageInfo(textures.size() - 1);
+        vk::WriteDescriptorSet write;
+        write.setDstSet(descriptorSets[bindlessSet]);
+        write.setDstBinding(0);
+        write.setDstArrayElement(texture.getBinding());
+        write.setDescriptorCount(1);
+        write.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+        write.setPImageInfo(&imgInfo);
+        write.setPBufferInfo(nullptr);
+        write.setPTexelBufferView(nullptr);
+        system::System::getInstance()->getLogicalDevice().updateDescriptorSets(1, &write, 0, nullptr);      // update after bind: draws already recorded see the texture without re-recording
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordTextureAdd(*this, textures.back());
+    }
+
+    const bool ResourceSet::isBindless(const uint32_t set) const
+    {
+        return bindlessCapacity != 0 && set == bindlessSet;
+    }
+
+    const vk::ShaderStageFlags ResourceSet::getPushConstantStages() const
+    {
+        return vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute;     // same as the bindings
+    }
+
+    const std::vector<vk::PushConstantRange> ResourceSet::getPushConstantRanges() const
+    {
+        std::vector<vk::PushConstantRange> ranges;
+        if(pushConstantSize == 0) return ranges;
+        vk::PushConstantRange range;
+        range.setStageFlags(getPushConstantStages());
+        range.setOffset(0);
+        range.setSize(pushConstantSize);
+        ranges.push_back(range);
+        return ranges;
+    }
+
+    const uint32_t ResourceSet::getCopyCount() const
+    {
+        uint32_t copies = ~uint32_t(0);
+        for(const auto& buffer : uniformBuffers)
         {
-            textures[index].update(data);
+            copies = std::min(copies, buffer.getCopyCount());
         }
-        else
+        return copies;
+    }
+
+    const std::vector<uint32_t> ResourceSet::getDynamicOffsets(const uint32_t copy) const
+    {
+        std::vector<uint32_t> offsets;
+        for(const auto& set : setContainmentData)
         {
-            uniformBuffers[index].update(data);
+            for(const auto& binding : set.second.bindings)
+            {
+                if(binding.second.second == ResourceType::DynamicUniformBuffer) offsets.push_back(uniformBuffers[binding.second.first].getDynamicOffset(copy));
+            }
+        }
+        return offsets;
+    }
+
+    void ResourceSet::flush(const uint32_t copy) const
+    {
+        for(const auto& buffer : uniformBuffers)
+        {
+            buffer.flush(copy);
+        }
+    }
+
+    void ResourceSet::update(const uint32_t set, const uint32_t binding, const void* data)
+    {
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordResourceSetUpdate(*this, set, binding, data);
+        uint32_t index = setContainmentData[set].bindings[binding].first;
+        switch(setContainmentData[set].bindings[binding].second)
+        {
+            case ResourceType::Texture:
+                textures[index].update(data);
+                break;
+            case ResourceType::UniformBuffer:
+            case ResourceType::DynamicUniformBuffer:
+                uniformBuffers[index].update(data);
+                break;
+            case ResourceType::StorageBuffer:
+                storageBuffers[index].update(data);
+                break;
         }
     }
 
@@ -83,64 +232,22 @@ namespace spk
         cbAllocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
         cbAllocInfo.setCommandPool(commandPool);
 
-        vk::SamplerCreateInfo samplerInfo;
-        samplerInfo.setMagFilter(vk::Filter::eLinear);
-        samplerInfo.setMinFilter(vk::Filter::eNearest);
-        samplerInfo.setMipmapMode(vk::SamplerMipmapMode::eNearest);
-        samplerInfo.setAddressModeU(vk::SamplerAddressMode::eRepeat);
-        samplerInfo.setAddressModeV(vk::SamplerAddressMode::eRepeat);
-        samplerInfo.setAddressModeW(vk::SamplerAddressMode::eRepeat);
-        samplerInfo.setMipLodBias(0);
-        samplerInfo.setAnisotropyEnable(false);
-        samplerInfo.setCompareEnable(false);
-        samplerInfo.setMinLod(0);
-        samplerInfo.setMaxLod(1);
-        samplerInfo.setBorderColor(vk::BorderColor::eFloatTransparentBlack);
-        samplerInfo.setUnnormalizedCoordinates(false);
-
-        if(logicalDevice.createSampler(&samplerInfo, nullptr, &uniqueSampler) != vk::Result::eSuccess) throw std::runtime_error("Failed to create sampler!\n");
-
-        if(textures.size() != 0 || uniformBuffers.size() != 0)
+        if(textures.size() != 0 || uniformBuffers.size() != 0 || storageBuffers.size() != 0 || bindlessCapacity != 0)
         {
-            uint32_t index = 0;
-            for(const auto& texture : textures)
+            for(uint32_t i = 0; i < textures.size(); ++i)
             {
-                uint32_t set = texture.getSet();
-                uint32_t binding = texture.getBinding();
-                if(setContainmentData.count(set) == 0)
-                {
-                    setContainmentData[set].bindings[binding] = std::make_pair(index, true);
-                }
-                else
-                {
-                    if(setContainmentData[set].bindings.count(binding) == 0 && setContainmentData[set].bindings.begin()->second.second)
-                    {
-                        setContainmentData[set].bindings[binding] = std::make_pair(index, true);
-                    }
-                    else throw std::runtime_error("Binding already exists or the set is used by the other type of resource!\n");
-                }
-                ++index;
+                addBinding(textures[i].getSet(), textures[i].getBinding(), i, ResourceType::Texture);
             }
-            index = 0;
-            for(const auto& buffer : uniformBuffers)
+            for(uint32_t i = 0; i < uniformBuffers.size(); ++i)
             {
-                uint32_t set = buffer.getSet();
-                uint32_t binding = buffer.getBinding();
-                if(setContainmentData.count(set) == 0)
-                {
-                    setContainmentData[set].bindings[binding] = std::make_pair(index, false);
-                }
-                else
-                {
-                    if(setContainmentData[set].bindings.count(binding) == 0 && !setContainmentData[set].bindings.begin()->second.second)
-                    {
-                        setContainmentData[set].bindings[binding] = std::make_pair(index, false);
-                    }
-                    else throw std::runtime_error("Binding already exists or the set is used by the other type of resource!\n");
-                }
-                ++index;
+                addBinding(uniformBuffers[i].getSet(), uniformBuffers[i].getBinding(), i, uniformBuffers[i].isDynamic() ? ResourceType::DynamicUniformBuffer : ResourceType::UniformBuffer);
             }
-            index = 0;
+            for(uint32_t i = 0; i < storageBuffers.size(); ++i)
+            {
+                addBinding(storageBuffers[i].getSet(), storageBuffers[i].getBinding(), i, ResourceType::StorageBuffer);
+            }
+            if(bindlessCapacity != 0) setContainmentData[bindlessSet];                  // the set exists even before its first texture
+            uint32_t index = 0;
             for(auto& set : setContainmentData)
             {
                 if(set.first != index) throw std::runtime_error("Non-consecutive sets!\n");
@@ -150,10 +257,32 @@ namespace spk
 
         bindTextureMemory();
         bindBufferMemory();
-        createDescriptorPool();
         createDescriptorLayouts();
         allocateDescriptorSets();
         writeDescriptorData();
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordResourceSet(*this);
+    }
+
+    void ResourceSet::addBinding(const uint32_t set, const uint32_t binding, const uint32_t index, const ResourceType type)
+    {
+        if(isBindless(set) && (type != ResourceType::Texture || binding >= bindlessCapacity)) throw std::runtime_error("Bindless set holds only textures with bindings below its capacity!\n");
+        if(setContainmentData[set].bindings.count(binding) != 0) throw std::runtime_error("Binding already exists!\n");     // textures and buffers may share a set
+        setContainmentData[set].bindings[binding] = std::make_pair(index, type);
+    }
+
+    const vk::DescriptorType ResourceSet::getDescriptorType(const ResourceType type) const
+    {
+        switch(type)
+        {
+            case ResourceType::Texture:
+                return vk::DescriptorType::eCombinedImageSampler;
+            case ResourceType::UniformBuffer:
+                return vk::DescriptorType::eUniformBuffer;
+            case ResourceType::DynamicUniformBuffer:
+                return vk::DescriptorType::eUniformBufferDynamic;
+            default:
+                return vk::DescriptorType::eStorageBuffer;
+        }
     }
 
     void ResourceSet::bindTextureMemory()
@@ -170,73 +299,61 @@ namespace spk
         {
             buffer.bindMemory();
         }
-    }
-
-    void ResourceSet::createDescriptorPool()
-    {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
-
-        vk::DescriptorPoolSize textureSize;
-        textureSize.setType(vk::DescriptorType::eCombinedImageSampler);
-        textureSize.setDescriptorCount(textures.size());
-        vk::DescriptorPoolSize uniformBufferSize;
-        uniformBufferSize.setType(vk::DescriptorType::eUniformBuffer);
-        uniformBufferSize.setDescriptorCount(uniformBuffers.size());
-        vk::DescriptorPoolSize poolSizes[] = {textureSize, uniformBufferSize};
-
-        vk::DescriptorPoolCreateInfo poolInfo;
-        poolInfo.setFlags(vk::DescriptorPoolCreateFlags());     // no individual reset
-        poolInfo.setMaxSets(setContainmentData.size());
-        poolInfo.setPoolSizeCount(2);
-        poolInfo.setPPoolSizes(poolSizes);
-
-        if(logicalDevice.createDescriptorPool(&poolInfo, nullptr, &descriptorPool) != vk::Result::eSuccess) throw std::runtime_error("Failed to create descriptor pool!\n");
+        for(auto& buffer : storageBuffers)
+        {
+            buffer.bindMemory();
+        }
     }
 
     void ResourceSet::createDescriptorLayouts()
     {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        system::LayoutCache* layoutCache = system::LayoutCache::getInstance();
         descriptorLayouts.resize(setContainmentData.size());
+        layoutBindings.resize(setContainmentData.size());
         size_t setIndex = 0;
         for(auto& set : setContainmentData)
         {
-            std::vector<vk::DescriptorSetLayoutBinding> bindings(set.second.bindings.size());
+            std::vector<vk::DescriptorSetLayoutBinding>& bindings = layoutBindings[setIndex];
+            if(isBindless(set.first))                                                   // one partially bound array, elements are written by addTexture after binding
+            {
+                bindings.resize(1);
+                bindings[0].setBinding(0);
+                bindings[0].setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+                bindings[0].setDescriptorCount(bindlessCapacity);
+                bindings[0].setStageFlags(vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute);
+                bindings[0].setPImmutableSamplers(nullptr);
+                descriptorLayouts[setIndex] = layoutCache->getSetLayout(bindings, true);
+                ++setIndex;
+                continue;
+            }
+            bindings.resize(set.second.bindings.size());
             size_t index = 0;
-            vk::DescriptorType descType = set.second.bindings.begin()->second.second ? vk::DescriptorType::eCombinedImageSampler : vk::DescriptorType::eUniformBuffer;
             for(auto& binding : set.second.bindings)
             {
                 bindings[index].setBinding(binding.first);
-                bindings[index].setDescriptorType(descType);
+                bindings[index].setDescriptorType(getDescriptorType(binding.second.second));
                 bindings[index].setDescriptorCount(1);
-                bindings[index].setStageFlags(vk::ShaderStageFlagBits::eAllGraphics);       // TODO: synchronize it with shader modules of pipeline
+                bindings[index].setStageFlags(vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute);       // TODO: synchronize it with shader modules of pipeline
                 bindings[index].setPImmutableSamplers(nullptr);
                 ++index;
             }
-            vk::DescriptorSetLayoutCreateInfo layoutInfo;
-            layoutInfo.setBindingCount(bindings.size());
-            layoutInfo.setPBindings(bindings.data());
-            if(logicalDevice.createDescriptorSetLayout(&layoutInfo, nullptr, &descriptorLayouts[setIndex]) != vk::Result::eSuccess) throw std::runtime_error("Failed to create descriptor layout!\n");
+            descriptorLayouts[setIndex] = layoutCache->getSetLayout(bindings);         // shared with every structurally equal set
 
             ++setIndex;
         }
 
-        vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-        pipelineLayoutInfo.setSetLayoutCount(descriptorLayouts.size());
-        pipelineLayoutInfo.setPSetLayouts(descriptorLayouts.data());
-        pipelineLayoutInfo.setPushConstantRangeCount(0);
-        pipelineLayoutInfo.setPPushConstantRanges(nullptr);
-        if(logicalDevice.createPipelineLayout(&pipelineLayoutInfo, nullptr, &pipelineLayout) != vk::Result::eSuccess) throw std::runtime_error("Failed to create pipeline layout!\n");
+        pipelineLayout = layoutCache->getPipelineLayout(descriptorLayouts, getPushConstantRanges());
+        layoutIdentifier = layoutCache->getIdentifier(pipelineLayout);
     }
 
     void ResourceSet::allocateDescriptorSets()
     {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        system::DescriptorAllocator* allocator = system::DescriptorAllocator::getInstance();
         descriptorSets.resize(descriptorLayouts.size());
-        vk::DescriptorSetAllocateInfo info;
-        info.setDescriptorPool(descriptorPool);
-        info.setDescriptorSetCount(descriptorLayouts.size());
-        info.setPSetLayouts(descriptorLayouts.data());
-        if(logicalDevice.allocateDescriptorSets(&info, descriptorSets.data()) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate descriptor sets!\n");
+        for(size_t i = 0; i < descriptorLayouts.size(); ++i)
+        {
+            descriptorSets[i] = allocator->allocate(descriptorLayouts[i], layoutBindings[i], isBindless(i));
+        }
     }
 
     void ResourceSet::writeDescriptorData()
@@ -247,32 +364,37 @@ namespace spk
         std::vector<vk::DescriptorBufferInfo> bufInfos;
         for(const auto& set : setContainmentData)
         {
+            const bool bindless = isBindless(set.first);
             for(const auto& binding : set.second.bindings)
             {
                 vk::WriteDescriptorSet write;
                 write.setDstSet(descriptorSets[set.first]);
-                write.setDstBinding(binding.first);
-                write.setDstArrayElement(0);
+                write.setDstBinding(bindless ? 0 : binding.first);
+                write.setDstArrayElement(bindless ? binding.first : 0);                 // bindless textures are elements of the array at binding 0
                 write.setDescriptorCount(1);
-                write.setDescriptorType(binding.second.second ? vk::DescriptorType::eCombinedImageSampler : vk::DescriptorType::eUniformBuffer);
-                vk::DescriptorImageInfo imgInfo;
+                write.setDescriptorType(getDescriptorType(binding.second.second));
                 vk::DescriptorBufferInfo bufInfo;
-                if(binding.second.second)
+                if(binding.second.second == ResourceType::Texture)
                 {
-                    imgInfo.setImageLayout(textures[binding.second.first].getLayout());
-                    imgInfo.setSampler(uniqueSampler);
-                    imgInfo.setImageView(textures[binding.second.first].getImageView());
-                    imgInfos.push_back(imgInfo);
+                    imgInfos.push_back(getImageInfo(binding.second.first));
                     write.setPBufferInfo(nullptr);
                 }
-                else
+                else if(binding.second.second == ResourceType::UniformBuffer || binding.second.second == ResourceType::DynamicUniformBuffer)
                 {
                     bufInfo.setBuffer(uniformBuffers[binding.second.first].getBuffer());
-                    bufInfo.setOffset(0);                                                       // because this is not memory offset, but buffer offset
+                    bufInfo.setOffset(uniformBuffers[binding.second.first].getOffset());       // because this is not memory offset, but buffer offset
                     bufInfo.setRange(uniformBuffers[binding.second.first].getSize());
                     bufInfos.push_back(bufInfo);
                     write.setPImageInfo(nullptr);
                 }
+                else
+                {
+                    bufInfo.setBuffer(storageBuffers[binding.second.first].getBuffer());
+                    bufInfo.setOffset(0);
+                    bufInfo.setRange(storageBuffers[binding.second.first].getSize());
+                    bufInfos.push_back(bufInfo);
+                    write.setPImageInfo(nullptr);
+                }
                 write.setPTexelBufferView(nullptr);
                 setWrites.push_back(write);
             }
@@ -282,7 +404,7 @@ namespace spk
         {
             for(const auto& binding : set.second.bindings)
             {
-                if(binding.second.second)
+                if(binding.second.second == ResourceType::Texture)
                 {
                     setWrites[i].setPImageInfo(&imgInfos[imgI]);
                     ++imgI;
@@ -298,20 +420,31 @@ namespace spk
         logicalDevice.updateDescriptorSets(setWrites.size(), setWrites.data(), 0, nullptr);
     }
 
+    const vk::DescriptorImageInfo ResourceSet::getImageInfo(const uint32_t index) const
+    {
+        vk::DescriptorImageInfo imgInfo;
+        imgInfo.setImageLayout(textures[index].getLayout());
+        imgInfo.setSampler(system::SamplerCache::getInstance()->getSampler(textures[index].getSamplerInfo()));     // shared with every texture sampled the same way
+        imgInfo.setImageView(textures[index].getImageView());
+        return imgInfo;
+    }
+
     void ResourceSet::destroy()
     {
         if(pipelineLayout)
         {
+            if(system::Capture::isActive()) system::Capture::getInstance()->recordResourceSetDestroy(*this);
+            system::Executives::getInstance()->releaseFrameCopies(this);
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
             const vk::CommandPool& commandPool = system::Executives::getInstance()->getPool();
-            for(auto& layout : descriptorLayouts)
+            for(auto& descriptorSet : descriptorSets)
             {
-                logicalDevice.destroyDescriptorSetLayout(layout, nullptr);
+                system::DescriptorAllocator::getInstance()->free(descriptorSet);
             }
-            logicalDevice.destroyPipelineLayout(pipelineLayout, nullptr);
+            descriptorSets.clear();
+            descriptorLayouts.clear();                                                  // owned by the layout cache
+            layoutBindings.clear();
             pipelineLayout = vk::PipelineLayout();
-            logicalDevice.destroyDescriptorPool(descriptorPool, nullptr);
-            logicalDevice.destroySampler(uniqueSampler, nullptr);
         }
     }
 
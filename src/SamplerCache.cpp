@@ -0,0 +1,93 @@
+#include"../include/SamplerCache.hpp"
+#include"../include/System.hpp"
+#include"../include/Tracing.hpp"
+#include<algorithm>
+#include<cstring>
+
+namespace spk
+{
+    namespace system
+    {
+        namespace
+        {
+            const vk::Filter filters[] = {vk::Filter::eNearest, vk::Filter::eLinear};
+            const vk::SamplerMipmapMode mipmapModes[] = {vk::SamplerMipmapMode::eNearest, vk::SamplerMipmapMode::eLinear};
+            const vk::SamplerAddressMode addressModes[] = {vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eMirroredRepeat, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToBorder};
+
+            uint32_t getBits(const float value)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+        }
+
+        std::unique_ptr<SamplerCache> SamplerCache::instance = nullptr;
+
+        SamplerCache::SamplerCache()
+        {
+            const System* system = System::getInstance();
+            vk::PhysicalDeviceProperties properties;
+            system->getPhysicalDevice().getProperties(&properties);
+            maxAnisotropy = system->getEnabledFeatures().samplerAnisotropy ? properties.limits.maxSamplerAnisotropy : 1.0f;
+            maxSamplers = properties.limits.maxSamplerAllocationCount;
+        }
+
+        SamplerCache* SamplerCache::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new SamplerCache());
+            }
+            return instance.get();
+        }
+
+        vk::Sampler SamplerCache::getSampler(const SamplerInfo& info)
+        {
+            const float anisotropy = std::min(std::max(info.maxAnisotropy, 1.0f), maxAnisotropy);     // requests beyond the device map to the same sampler
+            const std::vector<uint32_t> key = {uint32_t(info.magFilter), uint32_t(info.minFilter), uint32_t(info.mipmapFilter), 
+                uint32_t(info.addressModeU), uint32_t(info.addressModeV), uint32_t(info.addressModeW), getBits(anisotropy), getBits(info.minLod), getBits(info.maxLod)};
+            auto found = samplers.find(key);
+            if(found != samplers.end()) return found->second;
+
+            SPARK_TRACE_SCOPE("SamplerCache::createSampler");
+            if(samplers.size() >= maxSamplers) throw std::runtime_error("Sampler count exceeds maxSamplerAllocationCount!\n");
+            vk::SamplerCreateInfo samplerInfo;
+            samplerInfo.setMagFilter(filters[uint32_t(info.magFilter)]);
+            samplerInfo.setMinFilter(filters[uint32_t(info.minFilter)]);
+            samplerInfo.setMipmapMode(mipmapModes[uint32_t(info.mipmapFilter)]);
+            samplerInfo.setAddressModeU(addressModes[uint32_t(info.addressModeU)]);
+            samplerInfo.setAddressModeV(addressModes[uint32_t(info.addressModeV)]);
+            samplerInfo.setAddressModeW(addressModes[uint32_t(info.addressModeW)]);
+            samplerInfo.setMipLodBias(0);
+            samplerInfo.setAnisotropyEnable(anisotropy > 1.0f);
+            samplerInfo.setMaxAnisotropy(anisotropy);
+            samplerInfo.setCompareEnable(false);
+            samplerInfo.setMinLod(info.minLod);
+            samplerInfo.setMaxLod(info.maxLod);
+            samplerInfo.setBorderColor(vk::BorderColor::eFloatTransparentBlack);
+            samplerInfo.setUnnormalizedCoordinates(false);
+            vk::Sampler sampler;
+            if(System::getInstance()->getLogicalDevice().createSampler(&samplerInfo, nullptr, &sampler) != vk::Result::eSuccess) throw std::runtime_error("Failed to create sampler!\n");
+            samplers[key] = sampler;
+            return sampler;
+        }
+
+        const uint32_t SamplerCache::getSamplerCount() const
+        {
+            return samplers.size();
+        }
+
+        void SamplerCache::destroy()
+        {
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            for(auto& sampler : samplers)
+            {
+                logicalDevice.destroySampler(sampler.second, nullptr);
+            }
+            samplers.clear();
+        }
+    }
+}
\ No newline at end of file
@@ -58,6 +58,9 @@ namespace spk
                 case ShaderType::Fragment:
                     shaderModules[i].second = vk::ShaderStageFlagBits::eFragment;
                     break;
+                case ShaderType::Compute:
+                    shaderModules[i].second = vk::ShaderStageFlagBits::eCompute;
+                    break;
             }
         }
         for(int i = 0; i < shaderModules.size(); ++i)
@@ -67,6 +70,7 @@ namespace spk
             shaderStages[i].setPName("main");
             shaderStages[i].setPSpecializationInfo(nullptr);
         }
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordShaderSet(*this);
     }
 
     const std::vector<vk::PipelineShaderStageCreateInfo>& ShaderSet::getShaderStages() const
@@ -90,6 +94,7 @@ namespace spk
     {
         if(shaderModules.size() != 0 && shaderModules[0].first)
         {
+            if(system::Capture::isActive()) system::Capture::getInstance()->recordShaderSetDestroy(*this);
             for(auto& module : shaderModules)
             {
                 const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
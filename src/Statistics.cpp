@@ -0,0 +1,143 @@
+#include"../include/Statistics.hpp"
+#include"../include/System.hpp"
+#include"../include/Tracing.hpp"
+
+namespace spk
+{
+    namespace system
+    {
+        std::unique_ptr<Statistics> Statistics::instance = nullptr;
+
+        Statistics::Statistics()
+        {
+            history.resize(60);
+            historyNext = 0;
+            historyCount = 0;
+            frameStarted = false;
+        }
+
+        Statistics* Statistics::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new Statistics());
+            }
+            return instance.get();
+        }
+
+        void Statistics::countSubmit()
+        {
+            ++current.queueSubmits;
+        }
+
+        void Statistics::countCommandBufferRecord()
+        {
+            ++current.commandBufferRecords;
+        }
+
+        void Statistics::countCommands(const uint32_t draws, const uint32_t pipelineBinds, const uint32_t descriptorBinds, const uint32_t vertexBufferBinds, const uint32_t indexBufferBinds)
+        {
+            current.drawCalls += draws;
+            current.pipelineBinds += pipelineBinds;
+            current.descriptorBinds += descriptorBinds;
+            current.vertexBufferBinds += vertexBufferBinds;
+            current.indexBufferBinds += indexBufferBinds;
+        }
+
+        void Statistics::countUpload(const vk::DeviceSize bytes)
+        {
+            current.bytesUploaded += bytes;
+        }
+
+        void Statistics::countAllocation(const vk::DeviceSize bytes)
+        {
+            ++current.allocations;
+            current.bytesAllocated += bytes;
+        }
+
+        void Statistics::countDrawTime(const std::chrono::steady_clock::duration time)
+        {
+            current.cpuDrawMilliseconds += std::chrono::duration<double, std::milli>(time).count();
+        }
+
+        vk::Result Statistics::waitForFences(const uint32_t fenceCount, const vk::Fence* fences, const uint64_t timeout)
+        {
+            SPARK_TRACE_SCOPE("fence wait");
+            const vk::Device& logicalDevice = System::getInstance()->getLogicalDevice();
+            const auto waitStart = std::chrono::steady_clock::now();
+            const vk::Result result = logicalDevice.waitForFences(fenceCount, fences, true, timeout);
+            ++current.fenceWaits;
+            current.fenceWaitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+            return result;
+        }
+
+        void Statistics::endFrame()
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if(frameStarted)
+            {
+                current.cpuFrameMilliseconds = std::chrono::duration<double, std::milli>(now - frameStart).count();
+                lastFrame = current;
+                history[historyNext] = current;
+                historyNext = (historyNext + 1) % history.size();
+                if(historyCount < history.size()) ++historyCount;
+            }
+            current = FrameStatistics();                                                // work done before the first draw call is dropped
+            frameStart = now;
+            frameStarted = true;
+        }
+
+        const FrameStatistics& Statistics::getLastFrame() const
+        {
+            return lastFrame;
+        }
+
+        FrameStatistics Statistics::getAverage() const
+        {
+            FrameStatistics average;
+            if(historyCount == 0) return average;
+            for(uint32_t i = 0; i < historyCount; ++i)
+            {
+                const FrameStatistics& frame = history[i];
+                average.cpuFrameMilliseconds += frame.cpuFrameMilliseconds;
+                average.cpuDrawMilliseconds += frame.cpuDrawMilliseconds;
+                average.queueSubmits += frame.queueSubmits;
+                average.commandBufferRecords += frame.commandBufferRecords;
+                average.drawCalls += frame.drawCalls;
+                average.pipelineBinds += frame.pipelineBinds;
+                average.descriptorBinds += frame.descriptorBinds;
+                average.vertexBufferBinds += frame.vertexBufferBinds;
+                average.indexBufferBinds += frame.indexBufferBinds;
+                average.bytesUploaded += frame.bytesUploaded;
+                average.fenceWaits += frame.fenceWaits;
+                average.fenceWaitMilliseconds += frame.fenceWaitMilliseconds;
+                average.allocations += frame.allocations;
+                average.bytesAllocated += frame.bytesAllocated;
+            }
+            average.cpuFrameMilliseconds /= historyCount;                               // integer counters are rounded down
+            average.cpuDrawMilliseconds /= historyCount;
+            average.queueSubmits /= historyCount;
+            average.commandBufferRecords /= historyCount;
+            average.drawCalls /= historyCount;
+            average.pipelineBinds /= historyCount;
+            average.descriptorBinds /= historyCount;
+            average.vertexBufferBinds /= historyCount;
+            average.indexBufferBinds /= historyCount;
+            average.bytesUploaded /= historyCount;
+            average.fenceWaits /= historyCount;
+            average.fenceWaitMilliseconds /= historyCount;
+            average.allocations /= historyCount;
+            average.bytesAllocated /= historyCount;
+            return average;
+        }
+
+        void Statistics::setAverageWindow(const uint32_t frames)
+        {
+            history.assign(frames == 0 ? 1 : frames, FrameStatistics());
+            historyNext = 0;
+            historyCount = 0;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include"../include/StorageBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
+
+namespace spk
+{
+    StorageBuffer::StorageBuffer(){}
+
+    StorageBuffer::StorageBuffer(const StorageBuffer& sb)
+    {
+        create(sb.size, sb.setIndex, sb.binding);
+    }
+
+    StorageBuffer::StorageBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding)
+    {
+        create(cSize, cSetIndex, cBinding);
+    }
+
+    StorageBuffer& StorageBuffer::operator=(const StorageBuffer& rBuffer)
+    {
+        destroy();
+        create(rBuffer.size, rBuffer.setIndex, rBuffer.binding);
+        return *this;
+    }
+
+    void StorageBuffer::resetSetIndex(const uint32_t newIndex)
+    {
+        setIndex = newIndex;
+    }
+
+    void StorageBuffer::resetBinding(const uint32_t newBinding)
+    {
+        binding = newBinding;
+    }
+
+    const uint32_t StorageBuffer::getSet() const
+    {
+        return setIndex;
+    }
+
+    const uint32_t StorageBuffer::getBinding() const
+    {
+        return binding;
+    }
+
+    const vk::Buffer& StorageBuffer::getBuffer() const
+    {
+        return buffer.getBuffer();
+    }
+
+    const vk::DeviceSize StorageBuffer::getSize() const
+    {
+        return size;
+    }
+
+    void StorageBuffer::create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding)
+    {
+        setIndex = cSetIndex;
+        binding = cBinding;
+        size = cSize;
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+
+        const vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer
+            | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc;
+        buffer.create(size, usage, true, false, true);
+
+        vk::CommandBufferAllocateInfo commandInfo;
+        commandInfo.setCommandBufferCount(1);
+        commandInfo.setCommandPool(system::Executives::getInstance()->getPool());
+        commandInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+        if(logicalDevice.allocateCommandBuffers(&commandInfo, &updateCommandBuffer) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate command buffer!\n");
+        vk::FenceCreateInfo fenceInfo;
+        if(logicalDevice.createFence(&fenceInfo, nullptr, &updatedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
+    }
+
+    void StorageBuffer::update(const void* data)
+    {
+        SPARK_TRACE_SCOPE("StorageBuffer::update");
+        if(data == nullptr) return;
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        utils::Buffer transmissionBuffer;
+        transmissionBuffer.create(size, vk::BufferUsageFlagBits::eTransferSrc, false, true);
+        transmissionBuffer.bindMemory();
+        transmissionBuffer.updateCPUAccessible(data);
+
+        buffer.updateDeviceLocal(updateCommandBuffer, transmissionBuffer.getBuffer(), 0, vk::Semaphore(), vk::Semaphore(), vk::Fence(), updatedFence, vk::PipelineStageFlagBits::eAllCommands, true);
+        if(system::Statistics::getInstance()->waitForFences(1, &updatedFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        if(logicalDevice.resetFences(1, &updatedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to reset fence!\n");
+        updateCommandBuffer.reset(vk::CommandBufferResetFlags());
+    }
+
+    void StorageBuffer::bindMemory()
+    {
+        buffer.bindMemory();
+    }
+
+    void StorageBuffer::destroy()
+    {
+        if(!updatedFence) return;
+        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        buffer.destroy();
+        logicalDevice.freeCommandBuffers(system::Executives::getInstance()->getPool(), 1, &updateCommandBuffer);
+        updateCommandBuffer = vk::CommandBuffer();
+        logicalDevice.destroyFence(updatedFence, nullptr);
+        updatedFence = vk::Fence();
+    }
+
+    StorageBuffer::~StorageBuffer()
+    {
+        destroy();
+    }
+}
\ No newline at end of file
@@ -1,6 +1,14 @@
 #include"../include/System.hpp"
 #include"../include/Executives.hpp"
 #include"../include/MemoryManager.hpp"
+#include"../include/GPUProfiler.hpp"
+#include"../include/Capture.hpp"
+#include"../include/DescriptorAllocator.hpp"
+#include"../include/LayoutCache.hpp"
+#include"../include/UniformRing.hpp"
+#include"../include/SamplerCache.hpp"
+#include<fstream>
+#include<algorithm>
 
 namespace spk
 {
@@ -11,8 +19,9 @@ namespace spk
             throw std::runtime_error(error.c_str());
         }
 
-        void init()
+        void init(const bool headless)
         {
+            System::headlessMode = headless;
             System::getInstance();
         }
 
@@ -21,9 +30,36 @@ namespace spk
             System::getInstance()->destroy();
         }
 
-        System::System()
+        void loadPipelineCache(const std::string& filename)
         {
-            glfwInit();
+            std::vector<char> data;
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if(file.is_open())
+            {
+                data.resize(file.tellg());
+                file.seekg(0);
+                file.read(data.data(), data.size());
+            }
+            System* system = System::getInstance();
+            system->logicalDevice.destroyPipelineCache(system->pipelineCache, nullptr);
+            system->createPipelineCache(data);                                          // incompatible data is ignored by the driver
+        }
+
+        void savePipelineCache(const std::string& filename)
+        {
+            const System* system = System::getInstance();
+            size_t size;
+            if(system->logicalDevice.getPipelineCacheData(system->pipelineCache, &size, nullptr) != vk::Result::eSuccess) throw std::runtime_error("Failed to get pipeline cache data!\n");
+            std::vector<char> data(size);
+            if(system->logicalDevice.getPipelineCacheData(system->pipelineCache, &size, data.data()) != vk::Result::eSuccess) throw std::runtime_error("Failed to get pipeline cache data!\n");
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            if(!file.is_open()) throw std::runtime_error("Failed to open pipeline cache file!\n");
+            file.write(data.data(), size);
+        }
+
+        System::System(): properties2(false), maxBindlessTextures(0)
+        {
+            if(!headlessMode) glfwInit();
         }
 
         vk::Instance& System::getvkInstance()
@@ -56,7 +92,42 @@ namespace spk
             return logicalDevice;
         }
 
+        const vk::PipelineCache& System::getPipelineCache() const
+        {
+            return pipelineCache;
+        }
+
+        const vk::DispatchLoaderDynamic& System::getLoader() const
+        {
+            return loader;
+        }
+
+        const vk::PhysicalDeviceFeatures& System::getEnabledFeatures() const
+        {
+            return enabledFeatures;
+        }
+
+        const bool System::isExtensionEnabled(const std::string& name) const
+        {
+            for(const auto& extension : enabledExtensions)
+            {
+                if(extension == name) return true;
+            }
+            return false;
+        }
+
         std::unique_ptr<System> System::systemInstance = nullptr;
+        bool System::headlessMode = false;
+
+        const uint32_t System::getMaxBindlessTextures() const
+        {
+            return maxBindlessTextures;
+        }
+
+        const bool System::isHeadless() const
+        {
+            return headlessMode;
+        }
 
         System* System::getInstance()
         {
@@ -69,6 +140,7 @@ namespace spk
                 systemInstance->createPhysicalDevice();
                 Executives::getInstance();
                 systemInstance->createLogicalDevice();
+                systemInstance->createPipelineCache(std::vector<char>());
                 Executives::getInstance();
             }
             return systemInstance.get();
@@ -76,17 +148,31 @@ namespace spk
 
         std::vector<const char*> System::getInstanceExtensions() const
         {
-            uint32_t glfwExtCount = 1;
-            const char ** glfwExtData;
-            glfwExtData = glfwGetRequiredInstanceExtensions(&glfwExtCount);
-            std::vector<const char *> extData(glfwExtData, glfwExtData + glfwExtCount);
+            std::vector<const char *> extData;
+            if(!headlessMode)
+            {
+                uint32_t glfwExtCount = 1;
+                const char ** glfwExtData;
+                glfwExtData = glfwGetRequiredInstanceExtensions(&glfwExtCount);
+                extData.insert(extData.end(), glfwExtData, glfwExtData + glfwExtCount);
+            }
             if(enableValidation) extData.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+            uint32_t extPropertyCount;
+            vk::enumerateInstanceExtensionProperties(nullptr, &extPropertyCount, nullptr);
+            std::vector<vk::ExtensionProperties> extProperties(extPropertyCount);
+            vk::enumerateInstanceExtensionProperties(nullptr, &extPropertyCount, extProperties.data());
+            for(const auto& property : extProperties)
+            {
+                if(std::string(property.extensionName) == VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) extData.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);      // optional: queries the descriptor indexing features
+            }
             return extData;
         }
 
         std::vector<const char *> System::getDeviceExtensions() const
         {
-            std::vector<const char *> neededExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+            std::vector<const char *> neededExtensions;
+            if(!headlessMode) neededExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+            std::vector<const char *> optionalExtensions = {VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
             std::vector<const char *> result;
             uint32_t deviceExtPropertyCount;
             physicalDevice.enumerateDeviceExtensionProperties(nullptr, &deviceExtPropertyCount, nullptr);
@@ -100,6 +186,18 @@ namespace spk
                 }
             }
             if(result.size() != neededExtensions.size()) throw std::runtime_error("Failed to set up extensions!\n");
+            for(const auto& ext : optionalExtensions)
+            {
+                for(const auto& property : deviceExtProperties)
+                {
+                    if(std::string(property.extensionName) == std::string(ext)) result.push_back(ext);
+                }
+            }
+            const bool maintenance3 = std::find_if(result.begin(), result.end(), [](const char* ext){ return std::string(ext) == VK_KHR_MAINTENANCE3_EXTENSION_NAME; }) != result.end();
+            if(!maintenance3 || !properties2)                                           // descriptor indexing depends on both
+            {
+                result.erase(std::remove_if(result.begin(), result.end(), [](const char* ext){ return std::string(ext) == VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME; }), result.end());
+            }
             return result;
         }
 
@@ -144,6 +242,10 @@ namespace spk
             appInfo.setPEngineName("Spark");
             instanceInfo.setPApplicationInfo(&appInfo);
             if(vk::createInstance(&instanceInfo, nullptr, &instance) != vk::Result::eSuccess) throw std::runtime_error("Failed to create instance!\n");
+            for(const auto& extension : instanceExtensions)
+            {
+                if(std::string(extension) == VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) properties2 = true;
+            }
         }
 
         void System::createPhysicalDevice()
@@ -172,6 +274,7 @@ namespace spk
             logicalDeviceCreateInfo.setEnabledLayerCount(0);
             logicalDeviceCreateInfo.setPpEnabledLayerNames(nullptr);
             std::vector<const char *> deviceExtensions = getDeviceExtensions();
+            enabledExtensions.assign(deviceExtensions.begin(), deviceExtensions.end());
             logicalDeviceCreateInfo.setEnabledExtensionCount(deviceExtensions.size());
             logicalDeviceCreateInfo.setPpEnabledExtensionNames(deviceExtensions.data());
 
@@ -191,19 +294,50 @@ namespace spk
             logicalDeviceCreateInfo.setQueueCreateInfoCount(queueCreateInfos.size());
             logicalDeviceCreateInfo.setPQueueCreateInfos(queueCreateInfos.data());
 
-            vk::PhysicalDeviceFeatures deviceFeatures;
-            // deviceFeatures.setGeometryShader(true);
-            deviceFeatures.setTessellationShader(true);
-            // physicalDeviceFeatures
-            logicalDeviceCreateInfo.setPEnabledFeatures(&deviceFeatures);
+            vk::PhysicalDeviceFeatures supportedFeatures;
+            physicalDevice.getFeatures(&supportedFeatures);
+            enabledFeatures = vk::PhysicalDeviceFeatures();
+            // enabledFeatures.setGeometryShader(true);
+            enabledFeatures.setTessellationShader(true);
+            enabledFeatures.setMultiDrawIndirect(supportedFeatures.multiDrawIndirect);                  // optional: indirect batches fall back to one command per draw
+            enabledFeatures.setDrawIndirectFirstInstance(supportedFeatures.drawIndirectFirstInstance);
+            enabledFeatures.setSamplerAnisotropy(supportedFeatures.samplerAnisotropy);                  // optional: samplers fall back to no anisotropic filtering
+            logicalDeviceCreateInfo.setPEnabledFeatures(&enabledFeatures);
+
+            PFN_vkGetInstanceProcAddr getInstanceProcAddr = PFN_vkGetInstanceProcAddr(instance.getProcAddr("vkGetInstanceProcAddr"));
+            if(getInstanceProcAddr == nullptr) throw std::runtime_error("Failed to get instance process address!\n");
+            loader.init(instance, getInstanceProcAddr);                                 // the device functions are loaded once the device exists
+            vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures;
+            maxBindlessTextures = 0;
+            if(isExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+            {
+                vk::PhysicalDeviceDescriptorIndexingFeaturesEXT supportedIndexing;
+                vk::PhysicalDeviceFeatures2 features;
+                features.setPNext(&supportedIndexing);
+                physicalDevice.getFeatures2KHR(&features, loader);
+                if(supportedIndexing.descriptorBindingPartiallyBound && supportedIndexing.descriptorBindingSampledImageUpdateAfterBind)      // required by bindless sets, the rest only helps shaders
+                {
+                    indexingFeatures.setDescriptorBindingPartiallyBound(true);
+                    indexingFeatures.setDescriptorBindingSampledImageUpdateAfterBind(true);
+                    indexingFeatures.setRuntimeDescriptorArray(supportedIndexing.runtimeDescriptorArray);
+                    indexingFeatures.setShaderSampledImageArrayNonUniformIndexing(supportedIndexing.shaderSampledImageArrayNonUniformIndexing);
+                    logicalDeviceCreateInfo.setPNext(&indexingFeatures);
+
+                    vk::PhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties;
+                    vk::PhysicalDeviceProperties2 properties;
+                    properties.setPNext(&indexingProperties);
+                    physicalDevice.getProperties2KHR(&properties, loader);
+                    maxBindlessTextures = std::min(indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+                }
+            }
+
             if(physicalDevice.createDevice(&logicalDeviceCreateInfo, nullptr, &logicalDevice) != vk::Result::eSuccess)
             {
                 throw std::runtime_error("Failed to create logical device!\n");
             }
 
-            PFN_vkGetInstanceProcAddr getInstanceProcAddr = PFN_vkGetInstanceProcAddr(instance.getProcAddr("vkGetInstanceProcAddr"));
             PFN_vkGetDeviceProcAddr getDeviceProcAddr = PFN_vkGetDeviceProcAddr(logicalDevice.getProcAddr("vkGetDeviceProcAddr"));
-            if(getInstanceProcAddr == nullptr || getDeviceProcAddr == nullptr) throw std::runtime_error("Failed to get instance or device process addresses!\n");
+            if(getDeviceProcAddr == nullptr) throw std::runtime_error("Failed to get device process address!\n");
             loader.init(instance, getInstanceProcAddr, logicalDevice, getDeviceProcAddr);
 
             if(enableValidation)
@@ -224,6 +358,14 @@ namespace spk
             }
         }
 
+        void System::createPipelineCache(const std::vector<char>& initialData)
+        {
+            vk::PipelineCacheCreateInfo cacheInfo;
+            cacheInfo.setInitialDataSize(initialData.size());
+            cacheInfo.setPInitialData(initialData.data());
+            if(logicalDevice.createPipelineCache(&cacheInfo, nullptr, &pipelineCache) != vk::Result::eSuccess) throw std::runtime_error("Failed to create pipeline cache!\n");
+        }
+
         VKAPI_ATTR VkBool32 VKAPI_CALL System::callback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
         {
             #ifdef DEBUG
@@ -242,6 +384,13 @@ namespace spk
 
         void System::destroy()
         {
+            Capture::getInstance()->destroy();
+            GPUProfiler::getInstance()->destroy();
+            DescriptorAllocator::getInstance()->destroy();
+            LayoutCache::getInstance()->destroy();
+            UniformRing::getInstance()->destroy();
+            SamplerCache::getInstance()->destroy();
+            logicalDevice.destroyPipelineCache(pipelineCache, nullptr);
             Executives::getInstance()->destroy();
             MemoryManager::getInstance()->destroy();
             if(enableValidation)
@@ -250,7 +399,7 @@ namespace spk
             }
             logicalDevice.destroy(nullptr);
             instance.destroy(nullptr);
-            glfwTerminate();
+            if(!headlessMode) glfwTerminate();
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include"../include/Texture.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
 
 namespace spk
 {
@@ -41,6 +43,7 @@ namespace spk
     {
         destroy();
         create(rTexture.imageInfo.extent.width, rTexture.imageInfo.extent.height, rTexture.imageFormat, rTexture.setIndex, rTexture.binding);
+        samplerInfo = rTexture.samplerInfo;
         return *this;
     }
 
@@ -48,6 +51,7 @@ namespace spk
     {
         destroy();
         create(rTexture.imageInfo.extent.width, rTexture.imageInfo.extent.height, rTexture.imageFormat, rTexture.setIndex, rTexture.binding);
+        samplerInfo = rTexture.samplerInfo;
         return *this;
     }
 
@@ -61,6 +65,16 @@ namespace spk
         binding = newBinding;
     }
 
+    void Texture::setSamplerInfo(const SamplerInfo& info)
+    {
+        samplerInfo = info;
+    }
+
+    const SamplerInfo& Texture::getSamplerInfo() const
+    {
+        return samplerInfo;
+    }
+
     const uint32_t Texture::getSet() const
     {
         return setIndex;
@@ -78,7 +92,7 @@ namespace spk
 
     Texture::Texture(){}
 
-    Texture::Texture(const Texture& txt)
+    Texture::Texture(const Texture& txt): samplerInfo(txt.samplerInfo)
     {
         create(txt.imageInfo.extent.width, txt.imageInfo.extent.height, txt.imageFormat, txt.setIndex, txt.binding);
     }
@@ -143,10 +157,9 @@ namespace spk
 
     void Texture::bindMemory()
     {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
         image.bindMemory();
         image.changeLayout(layoutChangeCB, vk::ImageLayout::eShaderReadOnlyOptimal, vk::Semaphore(), contentProcessedSemaphore, vk::Fence(), contentProcessedFence);
-        if(logicalDevice.waitForFences(1, &contentProcessedFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        if(system::Statistics::getInstance()->waitForFences(1, &contentProcessedFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
         layoutChangeCB.reset(vk::CommandBufferResetFlags());
 
         imageView.create(image.getImage(), image.getFormat(), image.getSubresource());
@@ -154,8 +167,7 @@ namespace spk
 
     void Texture::update(const void* rawData)
     {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
-
+        SPARK_TRACE_SCOPE("Texture::update");
         utils::Buffer rawDataBuffer;
         rawDataBuffer.create(imageInfo.extent.width * imageInfo.extent.height * imageInfo.channelCount, vk::BufferUsageFlagBits::eTransferSrc, false, true);
         rawDataBuffer.bindMemory();
@@ -166,7 +178,7 @@ namespace spk
         layoutChangeCB.reset(vk::CommandBufferResetFlags());
         image.changeLayout(layoutChangeCB, vk::ImageLayout::eShaderReadOnlyOptimal, safeToSampleSemaphore, contentProcessedSemaphore, safeToSampleFence, contentProcessedFence);
         imageUpdateCB.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
-        if(logicalDevice.waitForFences(1, &contentProcessedFence, true, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
+        if(system::Statistics::getInstance()->waitForFences(1, &contentProcessedFence, ~0U) != vk::Result::eSuccess) throw std::runtime_error("Failed to wait for fences!\n");
         layoutChangeCB.reset(vk::CommandBufferResetFlags());
     }
 
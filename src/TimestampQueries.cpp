@@ -0,0 +1,81 @@
+#include"../include/TimestampQueries.hpp"
+#include"../include/GPUProfiler.hpp"
+
+namespace spk
+{
+    namespace utils
+    {
+        TimestampQueries::TimestampQueries(){}
+
+        TimestampQueries::TimestampQueries(const uint32_t cRegionCapacity)
+        {
+            create(cRegionCapacity);
+        }
+
+        void TimestampQueries::create(const uint32_t cRegionCapacity)
+        {
+            const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+            regionCapacity = cRegionCapacity;
+            names.reserve(regionCapacity);
+
+            vk::QueryPoolCreateInfo poolInfo;
+            poolInfo.setQueryType(vk::QueryType::eTimestamp);
+            poolInfo.setQueryCount(regionCapacity * 2);
+            if(logicalDevice.createQueryPool(&poolInfo, nullptr, &pool) != vk::Result::eSuccess) throw std::runtime_error("Failed to create query pool!\n");
+        }
+
+        void TimestampQueries::reset(vk::CommandBuffer& commandBuffer)
+        {
+            names.clear();
+            commandBuffer.resetQueryPool(pool, 0, regionCapacity * 2);
+        }
+
+        const uint32_t TimestampQueries::begin(vk::CommandBuffer& commandBuffer, const std::string& name)
+        {
+            if(names.size() == regionCapacity) return invalidRegion;
+            const uint32_t region = names.size();
+            names.push_back(name);
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, region * 2);
+            return region;
+        }
+
+        void TimestampQueries::end(vk::CommandBuffer& commandBuffer, const uint32_t region)
+        {
+            if(region == invalidRegion) return;
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, region * 2 + 1);
+        }
+
+        const bool TimestampQueries::collect(std::vector<GPUTimingRegion>& regions) const
+        {
+            if(names.size() == 0) return true;
+            const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+            std::vector<uint64_t> timestamps(names.size() * 2);
+            const vk::Result result = logicalDevice.getQueryPoolResults(pool, 0, timestamps.size(), timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+            if(result == vk::Result::eNotReady) return false;
+            if(result != vk::Result::eSuccess) throw std::runtime_error("Failed to get query pool results!\n");
+
+            const system::GPUProfiler* profiler = system::GPUProfiler::getInstance();
+            for(size_t i = 0; i < names.size(); ++i)
+            {
+                regions.push_back({names[i], profiler->toMilliseconds(timestamps[i * 2], timestamps[i * 2 + 1]), profiler->toMilliseconds(timestamps[0], timestamps[i * 2])});
+            }
+            return true;
+        }
+
+        void TimestampQueries::destroy()
+        {
+            if(pool)
+            {
+                const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+                logicalDevice.destroyQueryPool(pool, nullptr);
+                pool = vk::QueryPool();
+                names.clear();
+            }
+        }
+
+        TimestampQueries::~TimestampQueries()
+        {
+            destroy();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include"../include/Tracing.hpp"
+
+#ifdef SPARK_TRACING
+
+#include<algorithm>
+#include<chrono>
+#include<fstream>
+#include<stdexcept>
+
+namespace spk
+{
+    namespace system
+    {
+        std::unique_ptr<Tracer> Tracer::instance = nullptr;
+
+        namespace
+        {
+            thread_local void* currentThreadBuffer = nullptr;
+
+            void writeVarint(std::string& out, uint64_t value)
+            {
+                while(value >= 0x80)
+                {
+                    out.push_back(char((value & 0x7F) | 0x80));
+                    value >>= 7;
+                }
+                out.push_back(char(value));
+            }
+
+            void writeVarintField(std::string& out, const uint32_t field, const uint64_t value)
+            {
+                writeVarint(out, uint64_t(field) << 3);                                 // wire type 0: varint
+                writeVarint(out, value);
+            }
+
+            void writeBytesField(std::string& out, const uint32_t field, const std::string& bytes)
+            {
+                writeVarint(out, (uint64_t(field) << 3) | 2);                           // wire type 2: length-delimited
+                writeVarint(out, bytes.size());
+                out += bytes;
+            }
+
+            std::string escapeJson(const std::string& text)
+            {
+                std::string escaped;
+                for(const char c : text)
+                {
+                    if(c == '"' || c == '\\') escaped.push_back('\\');
+                    if(c == '\n') escaped += "\\n";
+                    else escaped.push_back(c);
+                }
+                return escaped;
+            }
+
+            // Perfetto field numbers (protos/perfetto/trace/trace_packet.proto, track_event.proto, track_descriptor.proto)
+            const uint32_t tracePacketField = 1;
+            const uint32_t packetTimestamp = 8;
+            const uint32_t packetSequenceId = 10;
+            const uint32_t packetTrackEvent = 11;
+            const uint32_t packetSequenceFlags = 13;
+            const uint32_t packetTrackDescriptor = 60;
+            const uint32_t trackEventType = 9;
+            const uint32_t trackEventTrackUuid = 11;
+            const uint32_t trackEventName = 23;
+            const uint32_t trackDescriptorUuid = 1;
+            const uint32_t trackDescriptorName = 2;
+            const uint64_t sliceBegin = 1;
+            const uint64_t sliceEnd = 2;
+            const uint64_t sequenceId = 1;
+            const uint64_t gpuTrackUuid = 1;
+
+            void writeTrackDescriptor(std::string& trace, const uint64_t uuid, const std::string& name)
+            {
+                std::string descriptor, packet;
+                writeVarintField(descriptor, trackDescriptorUuid, uuid);
+                writeBytesField(descriptor, trackDescriptorName, name);
+                writeVarintField(packet, packetSequenceId, sequenceId);
+                writeBytesField(packet, packetTrackDescriptor, descriptor);
+                writeBytesField(trace, tracePacketField, packet);
+            }
+
+            void writeSliceBegin(std::string& trace, const uint64_t trackUuid, const std::string& name, const uint64_t begin)
+            {
+                std::string beginEvent, packet;
+                writeVarintField(beginEvent, trackEventType, sliceBegin);
+                writeVarintField(beginEvent, trackEventTrackUuid, trackUuid);
+                writeBytesField(beginEvent, trackEventName, name);
+                writeVarintField(packet, packetTimestamp, begin);
+                writeVarintField(packet, packetSequenceId, sequenceId);
+                writeBytesField(packet, packetTrackEvent, beginEvent);
+                writeBytesField(trace, tracePacketField, packet);
+            }
+
+            void writeSliceEnd(std::string& trace, const uint64_t trackUuid, const uint64_t end)
+            {
+                std::string endEvent, packet;
+                writeVarintField(endEvent, trackEventType, sliceEnd);
+                writeVarintField(endEvent, trackEventTrackUuid, trackUuid);
+                writeVarintField(packet, packetTimestamp, end);
+                writeVarintField(packet, packetSequenceId, sequenceId);
+                writeBytesField(packet, packetTrackEvent, endEvent);
+                writeBytesField(trace, tracePacketField, packet);
+            }
+
+            struct Slice
+            {
+                std::string name;
+                uint64_t begin;
+                uint64_t end;
+            };
+
+            void writeTrack(std::string& trace, const uint64_t trackUuid, std::vector<Slice>& slices)      // spans are recorded in completion order, track events must come in timestamp order
+            {
+                std::sort(slices.begin(), slices.end(), [](const Slice& a, const Slice& b){ return a.begin < b.begin || (a.begin == b.begin && a.end > b.end); });    // parents before the slices they contain
+                std::vector<uint64_t> open;                                             // ends of the enclosing slices, innermost last
+                for(const auto& slice : slices)
+                {
+                    while(!open.empty() && open.back() <= slice.begin)
+                    {
+                        writeSliceEnd(trace, trackUuid, open.back());
+                        open.pop_back();
+                    }
+                    writeSliceBegin(trace, trackUuid, slice.name, slice.begin);
+                    open.push_back(open.empty() ? slice.end : std::min(slice.end, open.back()));     // slices on a track must nest, so one overlapping the end of its parent is cut there
+                }
+                while(!open.empty())
+                {
+                    writeSliceEnd(trace, trackUuid, open.back());
+                    open.pop_back();
+                }
+            }
+        }
+
+        Tracer::Tracer()
+        {
+            startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        Tracer* Tracer::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new Tracer());
+            }
+            return instance.get();
+        }
+
+        uint64_t Tracer::now()
+        {
+            const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            return time - getInstance()->startTime;
+        }
+
+        Tracer::ThreadBuffer* Tracer::getThreadBuffer()
+        {
+            if(currentThreadBuffer == nullptr)
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+                buffer->spans.reset(new Span[ThreadBuffer::capacity]);
+                buffer->count.store(0);
+                buffer->threadIndex = threadBuffers.size() + 1;
+                currentThreadBuffer = buffer.get();
+                threadBuffers.push_back(std::move(buffer));
+            }
+            return static_cast<ThreadBuffer*>(currentThreadBuffer);
+        }
+
+        void Tracer::recordSpan(const char* name, const uint64_t begin, const uint64_t end)
+        {
+            ThreadBuffer* buffer = getThreadBuffer();
+            const uint32_t index = buffer->count.load(std::memory_order_relaxed);
+            if(index == ThreadBuffer::capacity) return;                                 // full: spans are dropped until clear()
+            buffer->spans[index] = {name, begin, end};
+            buffer->count.store(index + 1, std::memory_order_release);
+        }
+
+        void Tracer::recordGPUSpan(const std::string& name, const uint64_t begin, const uint64_t end)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            gpuSpans.push_back({name, begin, end});
+        }
+
+        void Tracer::writeChromeTrace(const std::string& filename) const
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            std::ofstream file(filename, std::ios::trunc);
+            if(!file.is_open()) throw std::runtime_error("Failed to open trace file!\n");
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+            for(const auto& buffer : threadBuffers)
+            {
+                file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"args\":{\"name\":\"CPU thread " << buffer->threadIndex << "\"}}";
+                const uint32_t count = buffer->count.load(std::memory_order_acquire);
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    const Span& span = buffer->spans[i];
+                    file << ",\n{\"name\":\"" << escapeJson(span.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                        << ",\"ts\":" << span.begin / 1000.0 << ",\"dur\":" << (span.end - span.begin) / 1000.0 << "}";
+                }
+            }
+            for(const auto& span : gpuSpans)
+            {
+                file << ",\n{\"name\":\"" << escapeJson(span.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":" << span.begin / 1000.0 << ",\"dur\":" << (span.end - span.begin) / 1000.0 << "}";
+            }
+            file << "\n]}\n";
+        }
+
+        void Tracer::writePerfetto(const std::string& filename) const
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            std::string trace, packet;
+            writeVarintField(packet, packetSequenceId, sequenceId);
+            writeVarintField(packet, packetSequenceFlags, 1);                           // SEQ_INCREMENTAL_STATE_CLEARED
+            writeBytesField(trace, tracePacketField, packet);
+
+            writeTrackDescriptor(trace, gpuTrackUuid, "GPU");
+            for(const auto& buffer : threadBuffers)
+            {
+                writeTrackDescriptor(trace, gpuTrackUuid + buffer->threadIndex, "CPU thread " + std::to_string(buffer->threadIndex));
+            }
+            std::vector<Slice> slices;
+            for(const auto& buffer : threadBuffers)
+            {
+                const uint32_t count = buffer->count.load(std::memory_order_acquire);
+                slices.clear();
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    const Span& span = buffer->spans[i];
+                    slices.push_back({span.name, span.begin, span.end});
+                }
+                writeTrack(trace, gpuTrackUuid + buffer->threadIndex, slices);
+            }
+            slices.clear();
+            for(const auto& span : gpuSpans)
+            {
+                slices.push_back({span.name, span.begin, span.end});
+            }
+            writeTrack(trace, gpuTrackUuid, slices);
+
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            if(!file.is_open()) throw std::runtime_error("Failed to open trace file!\n");
+            file.write(trace.data(), trace.size());
+        }
+
+        void Tracer::clear()
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for(auto& buffer : threadBuffers)
+            {
+                buffer->count.store(0);
+            }
+            gpuSpans.clear();
+        }
+
+        TraceScope::TraceScope(const char* cName) : name(cName), begin(Tracer::now()){}
+
+        TraceScope::~TraceScope()
+        {
+            Tracer::getInstance()->recordSpan(name, begin, Tracer::now());
+        }
+    }
+}
+
+#endif
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include"../include/UniformBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include<cstring>
 
 namespace spk
 {
@@ -6,26 +8,37 @@ namespace spk
 
     UniformBuffer::UniformBuffer(const UniformBuffer& ub)
     {
-        create(ub.size, ub.setIndex, ub.binding);
+        create(ub.size, ub.setIndex, ub.binding, ub.dynamic);
     }
 
     const vk::Buffer& UniformBuffer::getBuffer() const
     {
+        if(dynamic) return system::UniformRing::getInstance()->getBuffer();
         return buffer.getBuffer();
     }
 
-    UniformBuffer::UniformBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding)
+    const vk::DeviceSize UniformBuffer::getOffset() const
     {
-        create(cSize, cSetIndex, cBinding);
+        return dynamic ? ringOffset : 0;
+    }
+
+    UniformBuffer::UniformBuffer(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding, const bool cDynamic)
+    {
+        create(cSize, cSetIndex, cBinding, cDynamic);
     }
 
     UniformBuffer& UniformBuffer::operator=(const UniformBuffer& rBuffer)
     {
         destroy();
-        create(rBuffer.size, rBuffer.setIndex, rBuffer.binding);
+        create(rBuffer.size, rBuffer.setIndex, rBuffer.binding, rBuffer.dynamic);
         return *this;
     }
 
+    const bool UniformBuffer::isDynamic() const
+    {
+        return dynamic;
+    }
+
     void UniformBuffer::resetSetIndex(const uint32_t newIndex)
     {
         setIndex = newIndex;
@@ -51,31 +64,67 @@ namespace spk
         return size;
     }
 
-    void UniformBuffer::create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding)
+    const uint32_t UniformBuffer::getCopyCount() const
+    {
+        return dynamic ? system::UniformRing::getInstance()->getSegmentCount() : ~uint32_t(0);
+    }
+
+    const uint32_t UniformBuffer::getDynamicOffset(const uint32_t copy) const
+    {
+        return system::UniformRing::getInstance()->getSegmentOffset(copy);
+    }
+
+    void UniformBuffer::create(const size_t cSize, const uint32_t cSetIndex, const uint32_t cBinding, const bool cDynamic)
     {
         setIndex = cSetIndex;
         binding = cBinding;
         size = cSize;
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        dynamic = cDynamic;
+        if(dynamic)
+        {
+            system::UniformRing* ring = system::UniformRing::getInstance();
+            ringOffset = ring->allocate(size);
+            data.assign(size, 0);
+            copyVersions.assign(ring->getSegmentCount(), 0);
+            version = 1;
+            return;
+        }
 
         buffer.create(size, vk::BufferUsageFlagBits::eUniformBuffer, false, false);
     }
 
-    void UniformBuffer::update(const void* data)
+    void UniformBuffer::update(const void* cData)
     {
-        if(data != nullptr)
+        if(cData == nullptr) return;
+        if(dynamic)
         {
-            buffer.updateCPUAccessible(data);
+            std::memcpy(data.data(), cData, size);                                      // never touches memory a frame in flight reads
+            ++version;
         }
+        else buffer.updateCPUAccessible(cData);
+    }
+
+    void UniformBuffer::flush(const uint32_t copy) const
+    {
+        if(!dynamic || copyVersions[copy] == version) return;
+        std::memcpy(system::UniformRing::getInstance()->getSegment(copy) + ringOffset, data.data(), size);
+        system::Statistics::getInstance()->countUpload(size);
+        copyVersions[copy] = version;
     }
 
     void UniformBuffer::bindMemory()
     {
-        buffer.bindMemory();
+        if(!dynamic) buffer.bindMemory();
     }
 
     void UniformBuffer::destroy()
     {
+        if(dynamic)
+        {
+            if(!data.empty()) system::UniformRing::getInstance()->free(ringOffset, size);
+            data.clear();
+            return;
+        }
         buffer.destroy();
     }
 
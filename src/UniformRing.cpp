@@ -0,0 +1,126 @@
+#include"../include/UniformRing.hpp"
+#include"../include/Tracing.hpp"
+#include<iterator>
+
+namespace spk
+{
+    namespace system
+    {
+        std::unique_ptr<UniformRing> UniformRing::instance = nullptr;
+
+        UniformRing::UniformRing(): mappedData(nullptr), segmentSize(1 << 20), segmentCount(3), alignment(1), usedSize(0){}
+
+        UniformRing* UniformRing::getInstance()
+        {
+            static bool created = false;
+            if(!created)
+            {
+                created = true;
+                instance.reset(new UniformRing());
+            }
+            return instance.get();
+        }
+
+        void UniformRing::setCapacity(const vk::DeviceSize cSegmentSize, const uint32_t cSegmentCount)
+        {
+            if(usedSize != 0) throw std::runtime_error("Uniform ring capacity can't change while dynamic uniform buffers exist!\n");
+            destroy();
+            segmentSize = cSegmentSize;
+            segmentCount = (cSegmentCount == 0) ? 1 : cSegmentCount;
+        }
+
+        void UniformRing::create()
+        {
+            SPARK_TRACE_SCOPE("UniformRing::create");
+            vk::PhysicalDeviceProperties properties;
+            System::getInstance()->getPhysicalDevice().getProperties(&properties);
+            alignment = properties.limits.minUniformBufferOffsetAlignment;
+            segmentSize = (segmentSize + alignment - 1) / alignment * alignment;        // keeps the segment offsets valid dynamic offsets
+            buffer.create(segmentSize * segmentCount, vk::BufferUsageFlagBits::eUniformBuffer, false, true);
+            buffer.bindMemory();
+            mappedData = static_cast<char*>(buffer.map());
+            freeRanges.clear();
+            freeRanges[0] = segmentSize;
+        }
+
+        const vk::DeviceSize UniformRing::allocate(const vk::DeviceSize size)
+        {
+            if(mappedData == nullptr) create();
+            const vk::DeviceSize alignedSize = (size + alignment - 1) / alignment * alignment;
+            for(auto range = freeRanges.begin(); range != freeRanges.end(); ++range)
+            {
+                if(range->second < alignedSize) continue;
+                const vk::DeviceSize offset = range->first;
+                const vk::DeviceSize remaining = range->second - alignedSize;
+                freeRanges.erase(range);
+                if(remaining != 0) freeRanges[offset + alignedSize] = remaining;
+                usedSize += alignedSize;
+                return offset;
+            }
+            throw std::runtime_error("Uniform ring is full!\n");
+        }
+
+        void UniformRing::free(const vk::DeviceSize offset, const vk::DeviceSize size)
+        {
+            vk::DeviceSize start = offset;
+            vk::DeviceSize alignedSize = (size + alignment - 1) / alignment * alignment;
+            usedSize -= alignedSize;
+            auto next = freeRanges.lower_bound(start);
+            if(next != freeRanges.end() && next->first == start + alignedSize)          // merge with the following range
+            {
+                alignedSize += next->second;
+                next = freeRanges.erase(next);
+            }
+            if(next != freeRanges.begin())
+            {
+                auto previous = std::prev(next);
+                if(previous->first + previous->second == start)                         // merge with the preceding range
+                {
+                    start = previous->first;
+                    alignedSize += previous->second;
+                    freeRanges.erase(previous);
+                }
+            }
+            freeRanges[start] = alignedSize;
+        }
+
+        const vk::Buffer& UniformRing::getBuffer() const
+        {
+            return buffer.getBuffer();
+        }
+
+        char* UniformRing::getSegment(const uint32_t segment) const
+        {
+            return mappedData + segmentSize * segment;
+        }
+
+        const uint32_t UniformRing::getSegmentOffset(const uint32_t segment) const
+        {
+            return segmentSize * segment;
+        }
+
+        const uint32_t UniformRing::getSegmentCount() const
+        {
+            return segmentCount;
+        }
+
+        const vk::DeviceSize UniformRing::getSegmentSize() const
+        {
+            return segmentSize;
+        }
+
+        const vk::DeviceSize UniformRing::getUsedSize() const
+        {
+            return usedSize;
+        }
+
+        void UniformRing::destroy()
+        {
+            if(mappedData == nullptr) return;
+            buffer.destroy();
+            mappedData = nullptr;
+            freeRanges.clear();
+            usedSize = 0;
+        }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,9 @@
 #include"../include/VertexBuffer.hpp"
+#include"../include/Statistics.hpp"
+#include"../include/Tracing.hpp"
+#include<algorithm>
+#include<cmath>
+#include<cstring>
 
 namespace spk
 {
@@ -37,25 +42,27 @@ namespace spk
 
     VertexBuffer::VertexBuffer(){}
 
-    VertexBuffer::VertexBuffer(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize): 
+    VertexBuffer::VertexBuffer(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize, const IndexType cIndexType): 
         //alignmentInfos(cAlignmentInfos), 
         vertexBufferBindings(cVertexBufferBindings),
         vertexBufferSizes(cVertexBufferSizes),
-        indexBufferSize(cIndexBufferSize)
+        indexBufferSize(cIndexBufferSize),
+        indexType(cIndexType)
     {
         init();
     }
 
     VertexBuffer::VertexBuffer(const VertexBuffer& vb)
     {
-        create(vb.vertexBufferBindings, vb.vertexBufferSizes, vb.indexBufferSize);
+        create(vb.vertexBufferBindings, vb.vertexBufferSizes, vb.indexBufferSize, vb.indexType);
     }
 
-    void VertexBuffer::create(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize)
+    void VertexBuffer::create(const std::vector<uint32_t>& cVertexBufferBindings, const std::vector<uint32_t>& cVertexBufferSizes, const uint32_t cIndexBufferSize, const IndexType cIndexType)
     {
         vertexBufferBindings = cVertexBufferBindings;
         vertexBufferSizes = cVertexBufferSizes;
         indexBufferSize = cIndexBufferSize;
+        indexType = cIndexType;
         init();
     }
 
@@ -65,9 +72,14 @@ namespace spk
         return vertexBuffers.at(binding).buffer.getBuffer();
     }
 
-    const vk::Buffer& VertexBuffer::getIndexBuffer() const
+    const vk::Buffer& VertexBuffer::getIndexBuffer(const uint32_t level) const
     {
-        return indexBuffer.getBuffer();
+        return (level == 0) ? indexBuffer.getBuffer() : levelOfDetailBuffer.getBuffer();
+    }
+
+    const vk::DeviceSize VertexBuffer::getIndexOffset(const uint32_t level) const
+    {
+        return (level == 0) ? 0 : levelsOfDetail.at(level - 1).offset;
     }
 
     const uint32_t VertexBuffer::getVertexBufferSize(const uint32_t binding) const
@@ -75,9 +87,116 @@ namespace spk
         return vertexBuffers.at(binding).size;
     }
 
-    const uint32_t VertexBuffer::getIndexBufferSize() const
+    const uint32_t VertexBuffer::getIndexCount(const uint32_t level) const
+    {
+        return (level == 0) ? indexCount : levelsOfDetail.at(level - 1).indexCount;
+    }
+
+    const IndexType VertexBuffer::getIndexType() const
+    {
+        return storedIndexType;
+    }
+
+    const vk::IndexType VertexBuffer::getVulkanIndexType() const
+    {
+        return (storedIndexType == IndexType::uint16) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+    }
+
+    void VertexBuffer::setLevelsOfDetail(const std::vector<utils::LevelOfDetail>& levels)
+    {
+        SPARK_TRACE_SCOPE("VertexBuffer::setLevelsOfDetail");
+        if(indexBufferSize == 0) throw std::runtime_error("Levels of detail need an index buffer!\n");
+        if(storedIndexType == IndexType::automatic) throw std::runtime_error("Automatic index buffer must be updated before its levels of detail are set!\n");
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordLevelsOfDetail(this, levels);
+        levelsOfDetail.clear();
+        if(levelOfDetailBuffer.getBuffer())
+        {
+            system::Executives::getInstance()->waitForFrameSubmissions();               // frames in flight may still bind the old levels
+            levelOfDetailBuffer.destroy();
+        }
+        ++levelOfDetailVersion;
+
+        const uint32_t indexSize = (storedIndexType == IndexType::uint16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        std::vector<char> data;
+        for(const auto& level : levels)
+        {
+            if(level.indices.empty()) throw std::runtime_error("Level of detail has no indices!\n");
+            const size_t offset = data.size();
+            levelsOfDetail.push_back({offset, uint32_t(level.indices.size()), level.error});
+            data.resize(offset + (level.indices.size() * indexSize + 3) / 4 * 4);       // every level starts 4-byte aligned
+            if(indexSize == sizeof(uint32_t))
+            {
+                std::memcpy(data.data() + offset, level.indices.data(), level.indices.size() * sizeof(uint32_t));
+                continue;
+            }
+            uint16_t* narrowed = reinterpret_cast<uint16_t*>(data.data() + offset);
+            for(uint32_t i = 0; i < level.indices.size(); ++i)
+            {
+                if(level.indices[i] > 0xFFFF) throw std::runtime_error("Index does not fit into the 16-bit index buffer!\n");
+                narrowed[i] = static_cast<uint16_t>(level.indices[i]);
+            }
+        }
+        if(data.empty()) return;
+
+        levelOfDetailBuffer.create(data.size(), vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, true, false);
+        levelOfDetailBuffer.bindMemory();
+        utils::Buffer transmissionBuffer;
+        transmissionBuffer.create(data.size(), vk::BufferUsageFlagBits::eTransferSrc, false, true);
+        transmissionBuffer.bindMemory();
+        transmissionBuffer.updateCPUAccessible(data.data());
+        levelOfDetailBuffer.updateDeviceLocal(indexUpdateCommandBuffer, transmissionBuffer.getBuffer(), 0, vk::Semaphore(), vk::Semaphore(), vk::Fence(), indexBufferUpdatedFence, vk::PipelineStageFlagBits::eVertexInput, true);
+        system::Statistics::getInstance()->waitForFences(1, &indexBufferUpdatedFence, ~0U);
+        indexUpdateCommandBuffer.reset(vk::CommandBufferResetFlags());
+    }
+
+    void VertexBuffer::setBounds(const BoundingSphere& cBounds)
+    {
+        bounds = cBounds;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordBounds(this);
+    }
+
+    const uint32_t VertexBuffer::getLevelOfDetailCount() const
+    {
+        return levelsOfDetail.size() + 1;
+    }
+
+    const uint32_t VertexBuffer::selectLevelOfDetail(const float* viewProjection, const float viewportHeight, const float pixelError) const
+    {
+        // column-major: the fourth row gives the view depth of the bounds (1 for orthographic projections), and the length of the second one scales view-space lengths to NDC height
+        const float* m = viewProjection;
+        const float depth = m[3] * bounds.center[0] + m[7] * bounds.center[1] + m[11] * bounds.center[2] + m[15];
+        const float nearestDepth = depth - bounds.radius * std::sqrt(m[3] * m[3] + m[7] * m[7] + m[11] * m[11]);
+        if(nearestDepth <= 0) return 0;
+        const float pixelsPerUnit = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]) * 0.5f * viewportHeight / nearestDepth;
+        uint32_t level = 0;
+        while(level < levelsOfDetail.size() && levelsOfDetail[level].error * pixelsPerUnit <= pixelError)
+        {
+            ++level;
+        }
+        return level;
+    }
+
+    const uint64_t VertexBuffer::getLevelOfDetailVersion() const
+    {
+        return levelOfDetailVersion;
+    }
+
+    void VertexBuffer::setPushConstants(const void* data, const uint32_t size)
+    {
+        if(size % 4 != 0) throw std::runtime_error("Push constant size must be a multiple of 4!\n");
+        pushConstants.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+        ++pushConstantVersion;                                                          // recorded into the command buffers, so they are re-recorded
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordPushConstants(this);
+    }
+
+    const std::vector<char>& VertexBuffer::getPushConstants() const
+    {
+        return pushConstants;
+    }
+
+    const uint64_t VertexBuffer::getPushConstantVersion() const
     {
-        return indexBufferSize;
+        return pushConstantVersion;
     }
 
     const vk::Fence* VertexBuffer::getIndexBufferFence() const
@@ -104,13 +223,28 @@ namespace spk
     {
         instanceCount = count;
         firstInstance = first;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstancing(this);
+    }
+
+    void VertexBuffer::setInstanceBuffer(const uint32_t binding, InstanceBuffer* instances)
+    {
+        if(instances == nullptr) instanceBuffers.erase(binding);
+        else instanceBuffers[binding] = instances;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordInstanceBinding(this, binding, instances);
     }
 
     const uint32_t VertexBuffer::getInstanceCount() const
     {
+        if(!instanceBuffers.empty()) return instanceBuffers.begin()->second->getInstanceCount();
         return instanceCount;
     }
 
+    InstanceBuffer* VertexBuffer::getInstanceBuffer(const uint32_t binding) const
+    {
+        const auto instances = instanceBuffers.find(binding);
+        return (instances == instanceBuffers.end()) ? nullptr : instances->second;
+    }
+
     const uint32_t VertexBuffer::getFirstInstance() const
     {
         return firstInstance;
@@ -119,7 +253,7 @@ namespace spk
     VertexBuffer& VertexBuffer::operator=(const VertexBuffer& rBuffer)
     {
         destroy();
-        create(rBuffer.vertexBufferBindings, rBuffer.vertexBufferSizes, rBuffer.indexBufferSize);
+        create(rBuffer.vertexBufferBindings, rBuffer.vertexBufferSizes, rBuffer.indexBufferSize, rBuffer.indexType);
         return *this;
     }
 
@@ -127,6 +261,14 @@ namespace spk
     {
         instanceCount = 1;
         firstInstance = 0;
+        memoryBound = false;
+        indexCount = 0;
+        storedIndexType = indexType;
+        levelsOfDetail.clear();
+        levelOfDetailVersion = 0;
+        bounds = {{0, 0, 0}, 0};
+        pushConstants.clear();
+        pushConstantVersion = 0;
         const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
         const vk::CommandPool& commandPool = system::Executives::getInstance()->getPool();
         uint32_t queueFamIndex = system::Executives::getInstance()->getGraphicsQueueFamilyIndex();
@@ -154,36 +296,98 @@ namespace spk
 
         if(indexBufferSize != 0)
         {
-            indexBuffer.create(indexBufferSize, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, true, false);
+            if(indexBufferSize % ((indexType == IndexType::uint16) ? sizeof(uint16_t) : sizeof(uint32_t)) != 0) throw std::runtime_error("Index buffer size is not a multiple of the index size!\n");
+            if(indexType != IndexType::automatic) createIndexBuffer(indexType);         // automatic index buffers are created once their type is known
 
             if(logicalDevice.createFence(&fenceInfo, nullptr, &indexBufferUpdatedFence) != vk::Result::eSuccess) throw std::runtime_error("Failed to create fence!\n");
             if(logicalDevice.createSemaphore(&semaphoreInfo, nullptr, &indexBufferUpdatedSemaphore) != vk::Result::eSuccess) throw std::runtime_error("Failed to create semaphore!\n");
 
             if(logicalDevice.allocateCommandBuffers(&commandInfo, &indexUpdateCommandBuffer) != vk::Result::eSuccess) throw std::runtime_error("Failed to allocate command buffer!\n");
         }
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBuffer(this);
+    }
+
+    void VertexBuffer::createIndexBuffer(const IndexType type)
+    {
+        const uint32_t sourceIndexSize = (indexType == IndexType::uint16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        const uint32_t storedIndexSize = (type == IndexType::uint16) ? sizeof(uint16_t) : sizeof(uint32_t);
+        storedIndexType = type;
+        indexCount = indexBufferSize / sourceIndexSize;
+        indexBuffer.create(indexCount * storedIndexSize, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, true, false);
+        if(memoryBound) indexBuffer.bindMemory();
+    }
+
+    void VertexBuffer::updateNarrowedIndices(const void* data, const uint32_t offset, const uint32_t size)
+    {
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(data);
+        std::vector<uint16_t> narrowed(size / sizeof(uint32_t));
+        for(uint32_t i = 0; i < narrowed.size(); ++i)
+        {
+            if(indices[i] > 0xFFFF) throw std::runtime_error("Index does not fit into the 16-bit index buffer!\n");
+            narrowed[i] = static_cast<uint16_t>(indices[i]);
+        }
+        update(narrowed.data(), false, 0, offset / 2, size / 2);
     }
 
     void VertexBuffer::updateVertexBuffer(const void* data, uint32_t binding)
     {
-        update(data, true, binding);
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBufferUpdate(this, data, true, binding, 0, vertexBuffers.at(binding).size);
+        update(data, true, binding, 0, vertexBuffers.at(binding).size);
     }
 
     void VertexBuffer::updateIndexBuffer(const void* data)
     {
         if(indexBufferSize == 0) throw std::runtime_error("Trying to update empty index buffer.\n");
-        update(data, false, 0);
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBufferUpdate(this, data, false, 0, 0, indexBufferSize);
+        if(indexType != IndexType::automatic)
+        {
+            update(data, false, 0, 0, indexBufferSize);
+            return;
+        }
+        if(storedIndexType == IndexType::automatic)
+        {
+            const uint32_t* indices = reinterpret_cast<const uint32_t*>(data);
+            const uint32_t maxIndex = *std::max_element(indices, indices + indexBufferSize / sizeof(uint32_t));
+            createIndexBuffer((maxIndex <= 0xFFFF) ? IndexType::uint16 : IndexType::uint32);
+        }
+        if(storedIndexType == IndexType::uint16) updateNarrowedIndices(data, 0, indexBufferSize);
+        else update(data, false, 0, 0, indexBufferSize);
     }
 
-    void VertexBuffer::update(const void* data, bool vertex, const uint32_t binding)
+    void VertexBuffer::updateVertexBuffer(const void* data, const uint32_t binding, const uint32_t offset, const uint32_t size)
     {
-        const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
+        if(offset + size > vertexBuffers.at(binding).size) throw std::runtime_error("Vertex buffer update is out of range!\n");
+        if(size == 0) return;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBufferUpdate(this, data, true, binding, offset, size);
+        update(data, true, binding, offset, size);
+    }
+
+    void VertexBuffer::updateIndexBuffer(const void* data, const uint32_t offset, const uint32_t size)
+    {
+        if(offset + size > indexBufferSize) throw std::runtime_error("Index buffer update is out of range!\n");
+        if(size == 0) return;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBufferUpdate(this, data, false, 0, offset, size);
+        if(indexType != IndexType::automatic)
+        {
+            update(data, false, 0, offset, size);
+            return;
+        }
+        if(offset % sizeof(uint32_t) != 0 || size % sizeof(uint32_t) != 0) throw std::runtime_error("Index buffer update is not aligned to the index size!\n");
+        if(storedIndexType == IndexType::automatic) createIndexBuffer(IndexType::uint32);                  // a range says nothing about the rest of the indices
+        if(storedIndexType == IndexType::uint16) updateNarrowedIndices(data, offset, size);
+        else update(data, false, 0, offset, size);
+    }
+
+    void VertexBuffer::update(const void* data, bool vertex, const uint32_t binding, const uint32_t offset, const uint32_t size)
+    {
+        SPARK_TRACE_SCOPE("VertexBuffer::update");
         const vk::Queue& graphicsQueue = system::Executives::getInstance()->getGraphicsQueue();
         vk::CommandBuffer& updateCommandBuffer = vertex ? vertexBuffers[binding].updateCommandBuffer : indexUpdateCommandBuffer;
 
         bindMemory();
 
         utils::Buffer transmissionBuffer;
-        transmissionBuffer.create(vertex ? vertexBuffers[binding].size : indexBufferSize, vk::BufferUsageFlagBits::eTransferSrc, false, true);
+        transmissionBuffer.create(size, vk::BufferUsageFlagBits::eTransferSrc, false, true);
         transmissionBuffer.bindMemory();
         transmissionBuffer.updateCPUAccessible(data);
 
@@ -197,7 +401,9 @@ namespace spk
                 vk::Fence(), 
                 vertexBuffers[binding].updatedFence, 
                 vk::PipelineStageFlagBits::eVertexInput, 
-                true);
+                true,
+                offset,
+                size);
         }
         else
         {
@@ -209,20 +415,21 @@ namespace spk
                 vk::Fence(),
                 indexBufferUpdatedFence,
                 vk::PipelineStageFlagBits::eVertexInput, 
-                true);
+                true,
+                offset,
+                size);
         }
 
-        logicalDevice.waitForFences(1, vertex ? &vertexBuffers[binding].updatedFence : &indexBufferUpdatedFence, true, ~0U);              //  move the sync operations out of here
+        system::Statistics::getInstance()->waitForFences(1, vertex ? &vertexBuffers[binding].updatedFence : &indexBufferUpdatedFence, ~0U);              //  move the sync operations out of here
         updateCommandBuffer.reset(vk::CommandBufferResetFlags());
     }
 
     void VertexBuffer::bindMemory()
     {
-        static bool memoryBound = false;
         if(!memoryBound)
         {
             const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
-            if(indexBufferSize != 0)
+            if(indexBuffer.getBuffer())
             {
                 indexBuffer.bindMemory();
             }
@@ -239,6 +446,7 @@ namespace spk
     {
         if(transferred) return;
         if(!vertexBuffers.begin()->second.buffer.getBuffer() && !indexBuffer.getBuffer()) return;
+        if(system::Capture::isActive()) system::Capture::getInstance()->recordVertexBufferDestroy(this);
         const vk::Device& logicalDevice = system::System::getInstance()->getLogicalDevice();
 
         for(auto& vb : vertexBuffers)
@@ -253,6 +461,7 @@ namespace spk
         if(indexBufferSize != 0)
         {
             indexBuffer.destroy();
+            if(levelOfDetailBuffer.getBuffer()) levelOfDetailBuffer.destroy();
             logicalDevice.destroyFence(indexBufferUpdatedFence, nullptr);
             indexBufferUpdatedFence = VkFence(0);
             logicalDevice.destroySemaphore(indexBufferUpdatedSemaphore, nullptr);